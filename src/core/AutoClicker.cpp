@@ -24,8 +24,9 @@ void AutoClicker::Start(int intervalMs) {
     // Set the running flag
     running.store(true);
     
-    // Start the clicker thread
-    clickerThread = std::thread(&AutoClicker::ClickerLoop, this);
+    // Click now and then on every tick of a periodic timer
+    clickTimer = TimerService::Get().Every(interval, [this]() { PerformClick(); },
+                                           std::chrono::milliseconds(0));
     
     Logger::getInstance().info("AutoClicker started with interval " + std::to_string(intervalMs) + " ms");
 }
@@ -34,10 +35,9 @@ void AutoClicker::Stop() {
     // Set the running flag to false
     running.store(false);
     
-    // Join the thread if it's joinable
-    if (clickerThread.joinable()) {
-        clickerThread.join();
-    }
+    // Waits for a click that is in progress
+    TimerService::Get().Cancel(clickTimer);
+    clickTimer = 0;
     
     Logger::getInstance().info("AutoClicker stopped");
 }
@@ -62,16 +62,6 @@ void AutoClicker::SetClickFunction(std::function<void()> clickFunc) {
     customClickFunc = clickFunc;
 }
 
-void AutoClicker::ClickerLoop() {
-    while (running.load()) {
-        // Perform the click
-        PerformClick();
-        
-        // Sleep for the specified interval
-        std::this_thread::sleep_for(interval);
-    }
-}
-
 void AutoClicker::PerformClick() {
     // If a custom click function is set, use it
     if (customClickFunc) {
@@ -1,8 +1,8 @@
 #pragma once
 
 #include "IO.hpp"
+#include "TimerService.hpp"
 #include <atomic>
-#include <thread>
 #include <functional>
 #include <chrono>
 
@@ -35,12 +35,11 @@ public:
 private:
     std::shared_ptr<IO> io;
     std::atomic<bool> running{false};
-    std::thread clickerThread;
+    TimerService::TimerId clickTimer = 0;
     std::chrono::milliseconds interval{100};
     ClickType clickType{ClickType::Left};
     std::function<void()> customClickFunc;
     
-    void ClickerLoop();
     void PerformClick();
 };
 
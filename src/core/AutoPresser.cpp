@@ -30,8 +30,12 @@ void AutoPresser::Start(const std::vector<std::string>& keys, int intervalMs) {
     // Set the running flag
     running.store(true);
     
-    // Start the presser thread
-    presserThread = std::thread(&AutoPresser::PresserLoop, this);
+    // Start pressing right away
+    {
+        std::lock_guard<std::mutex> lock(stepMutex);
+        nextKey = 0;
+        ScheduleStep(std::chrono::milliseconds(0));
+    }
     
     Logger::getInstance().info("AutoPresser started with interval " + std::to_string(intervalMs) + " ms");
 }
@@ -39,12 +43,30 @@ void AutoPresser::Start(const std::vector<std::string>& keys, int intervalMs) {
 void AutoPresser::Stop() {
     // Set the running flag to false
     bool wasRunning = running.exchange(false);
-    
-    // Join the thread if it's joinable
-    if (wasRunning && presserThread.joinable()) {
-        presserThread.join();
-        Logger::getInstance().info("AutoPresser stopped");
+    if (!wasRunning) {
+        return;
+    }
+
+    // Any step that starts from now on sees running == false, so the
+    // pending one is the last; Cancel waits if it is mid-flight
+    TimerService::TimerId pending;
+    {
+        std::lock_guard<std::mutex> lock(stepMutex);
+        pending = stepTimer;
     }
+    TimerService::Get().Cancel(pending);
+
+    // Never leave a key held down
+    std::string key;
+    {
+        std::lock_guard<std::mutex> lock(stepMutex);
+        stepTimer = 0;
+        key.swap(heldKey);
+    }
+    if (!key.empty()) {
+        SendKey(key, false);
+    }
+    Logger::getInstance().info("AutoPresser stopped");
 }
 
 bool AutoPresser::IsRunning() const {
@@ -55,45 +77,58 @@ void AutoPresser::SetPressDuration(int durationMs) {
     pressDuration = std::chrono::milliseconds(durationMs);
 }
 
-void AutoPresser::PresserLoop() {
-    while (running.load()) {
-        std::vector<std::string> currentKeys;
-        
-        // Make a local copy of keys to minimize lock time
-        {
-            std::lock_guard<std::mutex> lock(keysMutex);
-            currentKeys = keysToPress;
+void AutoPresser::ScheduleStep(std::chrono::milliseconds delay) {
+    stepTimer = TimerService::Get().After(delay, [this]() { Step(); });
+}
+
+// One step of the press cycle: press the next key and come back after
+// pressDuration to release it, then move on to the following key after a
+// short gap, or wait out the interval once every key has been pressed
+void AutoPresser::Step() {
+    std::lock_guard<std::mutex> lock(stepMutex);
+    if (!running.load()) {
+        return;
+    }
+
+    size_t keyCount;
+    std::string key;
+    {
+        std::lock_guard<std::mutex> keysLock(keysMutex);
+        keyCount = keysToPress.size();
+        if (heldKey.empty() && keyCount > 0) {
+            if (nextKey >= keyCount) nextKey = 0;
+            key = keysToPress[nextKey];
         }
-        
-        // Press each key in sequence
-        for (const auto& key : currentKeys) {
-            if (!running.load()) break;
-            PerformKeyPress(key);
-            
+    }
+
+    if (!heldKey.empty()) {
+        // Release the key
+        SendKey(heldKey, false);
+        heldKey.clear();
+        if (++nextKey < keyCount) {
             // Small delay between key presses
-            if (running.load()) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            }
-        }
-        
-        // Sleep for the specified interval
-        if (running.load()) {
-            std::this_thread::sleep_for(interval);
+            ScheduleStep(std::chrono::milliseconds(10));
+        } else {
+            nextKey = 0;
+            ScheduleStep(interval);
         }
+        return;
+    }
+
+    if (key.empty()) {
+        ScheduleStep(interval);
+        return;
     }
+
+    // Press the key and hold it for the specified duration
+    SendKey(key, true);
+    heldKey = key;
+    ScheduleStep(pressDuration);
 }
 
-void AutoPresser::PerformKeyPress(const std::string& key) {
+void AutoPresser::SendKey(const std::string& key, bool down) {
     try {
-        // Press the key
-        io->SendX11Key(key, true);  // Key down
-        
-        // Hold for the specified duration
-        std::this_thread::sleep_for(pressDuration);
-        
-        // Release the key
-        io->SendX11Key(key, false); // Key up
-        
+        io->SendX11Key(key, down);
     } catch (const std::exception& e) {
         Logger::getInstance().error("Error in AutoPresser: " + std::string(e.what()));
     }
@@ -1,8 +1,8 @@
 #pragma once
 
 #include "IO.hpp"
+#include "TimerService.hpp"
 #include <atomic>
-#include <thread>
 #include <string>
 #include <chrono>
 #include <vector>
@@ -30,14 +30,21 @@ public:
 private:
     std::shared_ptr<IO> io;
     std::atomic<bool> running{false};
-    std::thread presserThread;
     std::chrono::milliseconds interval{100};
     std::chrono::milliseconds pressDuration{50};
     std::vector<std::string> keysToPress;
     mutable std::mutex keysMutex;
+
+    // Each press and release is a one-shot timer step; stepMutex guards
+    // the chain so Stop() can cancel whichever step is pending
+    std::mutex stepMutex;
+    TimerService::TimerId stepTimer = 0;
+    size_t nextKey = 0;
+    std::string heldKey;
     
-    void PresserLoop();
-    void PerformKeyPress(const std::string& key);
+    void Step();
+    void ScheduleStep(std::chrono::milliseconds delay);
+    void SendKey(const std::string& key, bool down);
 };
 
 } // namespace havel
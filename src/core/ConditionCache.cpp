@@ -0,0 +1,50 @@
+#include "ConditionCache.hpp"
+#include <vector>
+
+namespace havel {
+
+ConditionCache::ConditionCache(Evaluator evaluator) : evaluate(std::move(evaluator)) {
+}
+
+std::shared_ptr<ConditionCache::Entry> ConditionCache::Add(const std::string &condition) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &entry = entries[condition];
+    if (!entry) {
+        entry = std::make_shared<Entry>();
+        entry->condition = CompiledCondition::Compile(condition);
+        needs.fetch_or(entry->condition.Needs(), std::memory_order_relaxed);
+    }
+    return entry;
+}
+
+bool ConditionCache::Resolve(Entry &entry) {
+    uint64_t current = epoch.load(std::memory_order_acquire);
+    uint64_t stamp = entry.stamp.load(std::memory_order_acquire);
+    if ((stamp >> 1) == current) {
+        return stamp & 1;
+    }
+
+    evaluations.fetch_add(1, std::memory_order_relaxed);
+    bool result = evaluate(entry.condition);
+    entry.stamp.store((current << 1) | (result ? 1 : 0), std::memory_order_release);
+    return result;
+}
+
+void ConditionCache::Refresh(const std::function<void(const CompiledCondition&, bool)> &onResult) {
+    std::vector<std::shared_ptr<Entry>> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        snapshot.reserve(entries.size());
+        for (const auto &[text, entry] : entries) {
+            snapshot.push_back(entry);
+        }
+    }
+    for (const auto &entry : snapshot) {
+        bool result = Resolve(*entry);
+        if (onResult) {
+            onResult(entry->condition, result);
+        }
+    }
+}
+
+} // namespace havel
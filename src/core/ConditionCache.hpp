@@ -0,0 +1,67 @@
+#pragma once
+
+#include "ConditionExpr.hpp"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace havel {
+
+// Condition results cached until the context they depend on changes.
+//
+// Every result is stamped with the context epoch it was computed in.
+// Whoever notices the active window or the mode changing bumps the epoch
+// with Invalidate(); until then Resolve() answers from the stamp without
+// evaluating anything. A result computed while the epoch moved carries
+// the old epoch and is simply recomputed on the next lookup.
+class ConditionCache {
+public:
+    using Evaluator = std::function<bool(const CompiledCondition&)>;
+
+    struct Entry {
+        CompiledCondition condition;
+        // (epoch << 1) | result; 0 until first evaluated
+        std::atomic<uint64_t> stamp{0};
+    };
+
+    explicit ConditionCache(Evaluator evaluate);
+
+    ConditionCache(const ConditionCache&) = delete;
+    ConditionCache& operator=(const ConditionCache&) = delete;
+
+    // Compile `condition`; the same text always maps to the same entry
+    std::shared_ptr<Entry> Add(const std::string &condition);
+
+    bool Resolve(Entry &entry);
+    bool Resolve(const std::string &condition) { return Resolve(*Add(condition)); }
+
+    // The active window, the mode or a variable changed
+    void Invalidate() { epoch.fetch_add(1, std::memory_order_acq_rel); }
+
+    // Resolve every entry, so lookups after a context change hit the cache
+    void Refresh(const std::function<void(const CompiledCondition&, bool)> &onResult = {});
+
+    // Whether some condition looks at `fact`, which then has to be
+    // looked up and watched for changes too
+    bool Needs(CompiledCondition::Fact fact) const {
+        return needs.load(std::memory_order_relaxed) & fact;
+    }
+
+    uint64_t Evaluations() const { return evaluations.load(std::memory_order_relaxed); }
+
+private:
+    Evaluator evaluate;
+    // Starts at 1 so that a zero stamp never matches
+    std::atomic<uint64_t> epoch{1};
+    std::atomic<uint64_t> evaluations{0};
+    std::atomic<uint8_t> needs{0};
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<Entry>> entries;
+};
+
+} // namespace havel
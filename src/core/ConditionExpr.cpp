@@ -0,0 +1,436 @@
+#include "ConditionExpr.hpp"
+#include <cctype>
+#include <stdexcept>
+
+namespace havel {
+
+class CompiledCondition::Parser {
+public:
+    Parser(std::string_view source, CompiledCondition &out) : src(source), out(out) {
+    }
+
+    void Parse() {
+        SkipSpace();
+        if (pos == src.size()) {
+            Fail("empty condition");
+        }
+        out.root = ParseOr(0);
+        SkipSpace();
+        if (pos != src.size()) {
+            Fail("unexpected '" + std::string(src.substr(pos, 1)) + "'");
+        }
+        out.needs = CollectNeeds(out.root);
+    }
+
+private:
+    [[noreturn]] void Fail(const std::string &message) const {
+        throw std::runtime_error("at " + std::to_string(pos) + ": " + message);
+    }
+
+    void SkipSpace() {
+        while (pos < src.size() && std::isspace(static_cast<unsigned char>(src[pos]))) {
+            ++pos;
+        }
+    }
+
+    static bool IsWordChar(char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.' || c == '$';
+    }
+
+    bool Accept(std::string_view token) {
+        SkipSpace();
+        if (src.substr(pos, token.size()) != token) {
+            return false;
+        }
+        pos += token.size();
+        return true;
+    }
+
+    bool AcceptWord(std::string_view word) {
+        SkipSpace();
+        if (src.substr(pos, word.size()) != word) {
+            return false;
+        }
+        size_t end = pos + word.size();
+        if (end < src.size() && IsWordChar(src[end])) {
+            return false;
+        }
+        pos = end;
+        return true;
+    }
+
+    void Expect(std::string_view token) {
+        if (!Accept(token)) {
+            Fail("expected '" + std::string(token) + "'");
+        }
+    }
+
+    uint16_t Add(Node node) {
+        if (out.nodes.size() >= MaxNodes) {
+            Fail("condition too long");
+        }
+        out.nodes.push_back(std::move(node));
+        return static_cast<uint16_t>(out.nodes.size() - 1);
+    }
+
+    uint16_t MakeConst(bool value) {
+        Node node;
+        node.kind = Kind::Const;
+        node.value = value;
+        return Add(std::move(node));
+    }
+
+    uint16_t ParseOr(size_t depth) {
+        std::vector<uint16_t> terms{ParseAnd(depth)};
+        while (Accept("||") || AcceptWord("or")) {
+            terms.push_back(ParseAnd(depth));
+        }
+        return Combine(Kind::Or, terms);
+    }
+
+    uint16_t ParseAnd(size_t depth) {
+        std::vector<uint16_t> terms{ParseUnary(depth)};
+        while (Accept("&&") || AcceptWord("and")) {
+            terms.push_back(ParseUnary(depth));
+        }
+        return Combine(Kind::And, terms);
+    }
+
+    uint16_t ParseUnary(size_t depth) {
+        if (depth > MaxDepth) {
+            Fail("condition nested too deeply");
+        }
+        SkipSpace();
+        bool bang = pos < src.size() && src[pos] == '!' &&
+                    (pos + 1 == src.size() || (src[pos + 1] != '=' && src[pos + 1] != '~'));
+        if (bang) {
+            ++pos;
+            return Negate(ParseUnary(depth + 1));
+        }
+        if (AcceptWord("not")) {
+            return Negate(ParseUnary(depth + 1));
+        }
+        return ParsePrimary(depth);
+    }
+
+    uint16_t ParsePrimary(size_t depth) {
+        if (Accept("(")) {
+            uint16_t inner = ParseOr(depth + 1);
+            Expect(")");
+            return inner;
+        }
+        if (AcceptWord("true")) {
+            return MakeConst(true);
+        }
+        if (AcceptWord("false")) {
+            return MakeConst(false);
+        }
+        if (AcceptWord("IsZooming")) {
+            Node node;
+            node.kind = Kind::Zooming;
+            return Add(std::move(node));
+        }
+        if (AcceptWord("Window.Active")) {
+            return ParseWindowActive();
+        }
+
+        Operand lhs = ParseOperand();
+        SkipSpace();
+        Op op;
+        if (Accept("==")) {
+            op = Op::Equal;
+        } else if (Accept("!=")) {
+            op = Op::NotEqual;
+        } else if (Accept("=~")) {
+            op = Op::Matches;
+        } else if (Accept("!~")) {
+            op = Op::NotMatches;
+        } else if (Accept("~")) {
+            op = Op::Contains;
+        } else if (lhs.source == Source::Variable) {
+            Node node;
+            node.kind = Kind::Truthy;
+            node.lhs = std::move(lhs);
+            return Add(std::move(node));
+        } else {
+            Fail("expected a comparison");
+        }
+        return MakeCompare(std::move(lhs), op, ParseOperand());
+    }
+
+    // Window.Active(class:Firefox), Window.Active('name:YouTube'), ...
+    uint16_t ParseWindowActive() {
+        Expect("(");
+        SkipSpace();
+        std::string param;
+        if (pos < src.size() && (src[pos] == '\'' || src[pos] == '"')) {
+            // Quoted, so the text may hold parentheses
+            size_t close = src.find(src[pos], pos + 1);
+            if (close == std::string_view::npos) {
+                Fail("unterminated string");
+            }
+            param = std::string(src.substr(pos + 1, close - pos - 1));
+            pos = close + 1;
+        } else {
+            size_t close = src.find(')', pos);
+            if (close == std::string_view::npos) {
+                Fail("expected ')'");
+            }
+            param = std::string(src.substr(pos, close - pos));
+            pos = close;
+        }
+        Expect(")");
+
+        Operand field;
+        field.source = param.rfind("class:", 0) == 0 ? Source::Class : Source::Title;
+        Operand value;
+        size_t colon = param.rfind(':');
+        value.text = colon == std::string::npos ? param : param.substr(colon + 1);
+        return MakeCompare(std::move(field), Op::Contains, std::move(value));
+    }
+
+    Operand ParseOperand() {
+        SkipSpace();
+        if (pos == src.size()) {
+            Fail("expected a value");
+        }
+
+        Operand operand;
+        char c = src[pos];
+        if (c == '\'' || c == '"') {
+            size_t close = src.find(c, pos + 1);
+            if (close == std::string_view::npos) {
+                Fail("unterminated string");
+            }
+            operand.text = std::string(src.substr(pos + 1, close - pos - 1));
+            pos = close + 1;
+            return operand;
+        }
+
+        size_t start = pos;
+        while (pos < src.size() && (IsWordChar(src[pos]) || src[pos] == '-')) {
+            ++pos;
+        }
+        std::string_view word = src.substr(start, pos - start);
+        if (word.empty()) {
+            Fail("expected a value");
+        }
+
+        if (word == "class") {
+            operand.source = Source::Class;
+        } else if (word == "title") {
+            operand.source = Source::Title;
+        } else if (word == "exe") {
+            operand.source = Source::Exe;
+        } else if (word == "mode" || word == "currentMode") {
+            operand.source = Source::Mode;
+        } else if (word[0] == '$' && word.size() > 1) {
+            operand.source = Source::Variable;
+            operand.text = std::string(word.substr(1));
+        } else if (std::isdigit(static_cast<unsigned char>(word[0])) || word[0] == '-') {
+            operand.text = std::string(word);
+        } else {
+            pos = start;
+            Fail("unknown name '" + std::string(word) + "'");
+        }
+        return operand;
+    }
+
+    uint16_t MakeCompare(Operand lhs, Op op, Operand rhs) {
+        Node node;
+        node.kind = Kind::Compare;
+        node.op = op;
+
+        if (op == Op::Matches || op == Op::NotMatches) {
+            if (rhs.source != Source::Literal) {
+                Fail("the right side of a regex match must be a string");
+            }
+            try {
+                node.regex = std::make_shared<const std::regex>(
+                    rhs.text, std::regex::ECMAScript | std::regex::optimize);
+            } catch (const std::regex_error &e) {
+                Fail("bad regex '" + rhs.text + "': " + e.what());
+            }
+        }
+        node.lhs = std::move(lhs);
+        node.rhs = std::move(rhs);
+
+        // Two literals: decide now
+        if (node.lhs.source == Source::Literal && node.rhs.source == Source::Literal) {
+            return MakeConst(Compare(node, node.lhs.text, node.rhs.text));
+        }
+        return Add(std::move(node));
+    }
+
+    uint16_t Negate(uint16_t index) {
+        const Node &node = out.nodes[index];
+        if (node.kind == Kind::Const) {
+            return MakeConst(!node.value);
+        }
+        if (node.kind == Kind::Not) {
+            return node.children[0];
+        }
+        Node negation;
+        negation.kind = Kind::Not;
+        negation.children = {index};
+        return Add(std::move(negation));
+    }
+
+    // Flatten nested terms of the same kind and drop constants that do
+    // not decide the result
+    uint16_t Combine(Kind kind, const std::vector<uint16_t> &terms) {
+        if (terms.size() == 1) {
+            return terms[0];
+        }
+        const bool absorbing = kind == Kind::Or;
+        std::vector<uint16_t> children;
+        for (uint16_t term : terms) {
+            const Node &node = out.nodes[term];
+            if (node.kind == Kind::Const) {
+                if (node.value == absorbing) {
+                    return MakeConst(absorbing);
+                }
+                continue;
+            }
+            if (node.kind == kind) {
+                children.insert(children.end(), node.children.begin(), node.children.end());
+            } else {
+                children.push_back(term);
+            }
+        }
+        if (children.empty()) {
+            return MakeConst(!absorbing);
+        }
+        if (children.size() == 1) {
+            return children[0];
+        }
+        Node node;
+        node.kind = kind;
+        node.children = std::move(children);
+        return Add(std::move(node));
+    }
+
+    uint8_t CollectNeeds(uint16_t index) const {
+        const Node &node = out.nodes[index];
+        uint8_t result = 0;
+        if (node.kind == Kind::Compare) {
+            for (Source source : {node.lhs.source, node.rhs.source}) {
+                if (source == Source::Title) result |= NeedsTitle;
+                if (source == Source::Exe) result |= NeedsExe;
+                if (source == Source::Mode) result |= NeedsMode;
+            }
+        }
+        for (uint16_t child : node.children) {
+            result |= CollectNeeds(child);
+        }
+        return result;
+    }
+
+    std::string_view src;
+    size_t pos = 0;
+    CompiledCondition &out;
+};
+
+CompiledCondition CompiledCondition::Compile(std::string_view source) {
+    CompiledCondition compiled;
+    compiled.text = std::string(source);
+    try {
+        Parser(source, compiled).Parse();
+    } catch (const std::runtime_error &e) {
+        compiled.error = e.what();
+        compiled.nodes.assign(1, Node{});
+        compiled.root = 0;
+        compiled.needs = 0;
+    }
+    return compiled;
+}
+
+std::optional<bool> CompiledCondition::Constant() const {
+    if (nodes.empty()) {
+        return false;
+    }
+    const Node &node = nodes[root];
+    if (node.kind != Kind::Const) {
+        return std::nullopt;
+    }
+    return node.value;
+}
+
+bool CompiledCondition::Evaluate(const ConditionFacts &facts) const {
+    if (nodes.empty()) {
+        return false;
+    }
+    return EvaluateNode(root, facts);
+}
+
+std::string_view CompiledCondition::Resolve(const Operand &operand, const ConditionFacts &facts) {
+    switch (operand.source) {
+        case Source::Class: return facts.className;
+        case Source::Title: return facts.title;
+        case Source::Exe: return facts.exe;
+        case Source::Mode: return facts.mode;
+        case Source::Variable:
+            if (facts.variables) {
+                auto it = facts.variables->find(operand.text);
+                if (it != facts.variables->end()) {
+                    return it->second;
+                }
+            }
+            return {};
+        case Source::Literal:
+        default:
+            return operand.text;
+    }
+}
+
+bool CompiledCondition::Compare(const Node &node, std::string_view lhs, std::string_view rhs) {
+    switch (node.op) {
+        case Op::Equal:
+            return lhs == rhs;
+        case Op::NotEqual:
+            return lhs != rhs;
+        case Op::Contains:
+            return lhs.find(rhs) != std::string_view::npos;
+        case Op::Matches:
+        case Op::NotMatches: {
+            // Long titles are cut short, which keeps the recursive
+            // std::regex matcher off deep stacks. It does not bound
+            // backtracking: a pattern like '(a+)+$' can still be slow.
+            std::string_view subject = lhs.substr(0, MaxSubject);
+            bool found = std::regex_search(subject.begin(), subject.end(), *node.regex);
+            return node.op == Op::Matches ? found : !found;
+        }
+    }
+    return false;
+}
+
+bool CompiledCondition::EvaluateNode(uint16_t index, const ConditionFacts &facts) const {
+    const Node &node = nodes[index];
+    switch (node.kind) {
+        case Kind::Const:
+            return node.value;
+        case Kind::Not:
+            return !EvaluateNode(node.children[0], facts);
+        case Kind::And:
+            for (uint16_t child : node.children) {
+                if (!EvaluateNode(child, facts)) return false;
+            }
+            return true;
+        case Kind::Or:
+            for (uint16_t child : node.children) {
+                if (EvaluateNode(child, facts)) return true;
+            }
+            return false;
+        case Kind::Zooming:
+            return facts.zooming;
+        case Kind::Truthy: {
+            std::string_view value = Resolve(node.lhs, facts);
+            return !value.empty() && value != "0" && value != "false";
+        }
+        case Kind::Compare:
+            return Compare(node, Resolve(node.lhs, facts), Resolve(node.rhs, facts));
+    }
+    return false;
+}
+
+} // namespace havel
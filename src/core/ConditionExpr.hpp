@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace havel {
+
+// What a condition is evaluated against
+struct ConditionFacts {
+    std::string_view className;
+    std::string_view title;
+    std::string_view exe;
+    std::string_view mode;
+    bool zooming = false;
+    const std::unordered_map<std::string, std::string> *variables = nullptr;
+};
+
+// A contextual hotkey condition, compiled once when it is registered.
+//
+//   expr    := and { ("||" | "or") and }
+//   and     := unary { ("&&" | "and") unary }
+//   unary   := ("!" | "not") unary | primary
+//   primary := "(" expr ")" | "true" | "false" | "IsZooming"
+//            | "Window.Active(" [class: | name: | title:] text ")"
+//            | $variable
+//            | operand op operand
+//   operand := class | title | exe | mode | currentMode | $variable
+//            | 'string' | "string" | number
+//   op      := "==" | "!=" | "~" (contains) | "=~" | "!~" (regex search)
+//
+// e.g.  class ~ 'mpv' || (exe == 'firefox' && title =~ 'YouTube|Twitch')
+//
+// The text is parsed into a flat, typed tree, regexes are compiled, and
+// constant parts are folded away. Evaluation visits each node at most
+// once and matches regexes against at most MaxSubject bytes. A regex
+// still backtracks as std::regex does, so its patterns are trusted like
+// the rest of the config. Text that does not parse compiles to a
+// condition that is always false, with Error() saying why.
+class CompiledCondition {
+public:
+    // Facts that cost something to look up, which the caller only needs
+    // to provide when a condition uses them, and the mode, whose
+    // conditions decide whether the gaming hotkeys are grabbed
+    enum Fact : uint8_t {
+        NeedsTitle = 1 << 0,
+        NeedsExe = 1 << 1,
+        NeedsMode = 1 << 2
+    };
+
+    static constexpr size_t MaxNodes = 256;
+    static constexpr size_t MaxDepth = 32;
+    static constexpr size_t MaxSubject = 1024;
+
+    CompiledCondition() = default;
+
+    static CompiledCondition Compile(std::string_view text);
+
+    bool Evaluate(const ConditionFacts &facts) const;
+
+    bool Ok() const { return error.empty(); }
+    const std::string &Error() const { return error; }
+    const std::string &Text() const { return text; }
+    uint8_t Needs() const { return needs; }
+    // The value of a condition that folded down to a constant
+    std::optional<bool> Constant() const;
+    size_t Size() const { return nodes.size(); }
+
+private:
+    enum class Source : uint8_t {
+        Literal,
+        Class,
+        Title,
+        Exe,
+        Mode,
+        Variable
+    };
+
+    struct Operand {
+        Source source = Source::Literal;
+        // The literal, or the variable name
+        std::string text;
+    };
+
+    enum class Op : uint8_t {
+        Equal,
+        NotEqual,
+        Contains,
+        Matches,
+        NotMatches
+    };
+
+    enum class Kind : uint8_t {
+        Const,
+        Not,
+        And,
+        Or,
+        Zooming,
+        Truthy,   // A lone $variable
+        Compare
+    };
+
+    struct Node {
+        Kind kind = Kind::Const;
+        bool value = false;
+        Op op = Op::Equal;
+        Operand lhs;
+        Operand rhs;
+        std::shared_ptr<const std::regex> regex;
+        std::vector<uint16_t> children;
+    };
+
+    class Parser;
+
+    bool EvaluateNode(uint16_t index, const ConditionFacts &facts) const;
+    static bool Compare(const Node &node, std::string_view lhs, std::string_view rhs);
+    static std::string_view Resolve(const Operand &operand, const ConditionFacts &facts);
+
+    std::string text;
+    std::string error;
+    std::vector<Node> nodes;
+    uint16_t root = 0;
+    uint8_t needs = 0;
+};
+
+} // namespace havel
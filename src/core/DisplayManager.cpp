@@ -1,14 +1,47 @@
 #include "DisplayManager.hpp"
 #include "x11_includes.h"
+#include <atomic>
 #include <iostream>
+#include <mutex>
 #include <stdexcept>
+#include <unordered_map>
+#include <vector>
 
 namespace havel {
+namespace {
+
+// XOpenDisplay and XCloseDisplay touch Xlib globals, and Initialize()
+// mutates the shared state; these are the only steps threads serialize on
+std::mutex connectionMutex;
+std::atomic<size_t> threadDisplays{0};
+
+struct ThreadConnection {
+    Display* display = nullptr;
+    std::unordered_map<std::string, Atom> atoms;
+    ~ThreadConnection() {
+        if (display) {
+            std::lock_guard<std::mutex> lock(connectionMutex);
+            XCloseDisplay(display);
+            threadDisplays.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+};
+
+thread_local ThreadConnection threadConnection;
+
+} // namespace
+
     Display* DisplayManager::display = nullptr;
     ::Window DisplayManager::root = 0;
     bool DisplayManager::initialized = false;
     
     void DisplayManager::Initialize() {
+        std::lock_guard<std::mutex> lock(connectionMutex);
+        // Each thread gets its own connection, but Xlib's globals (error
+        // handlers, the resource and keysym databases, locale state) are
+        // still shared between them
+        static std::once_flag threadsInitialized;
+        std::call_once(threadsInitialized, []() { XInitThreads(); });
         if (!initialized) {
             display = XOpenDisplay(nullptr);
             if (display) {
@@ -49,6 +82,74 @@ namespace havel {
     bool DisplayManager::IsInitialized() {
         return display != nullptr;
     }
+
+    Display* DisplayManager::GetThreadDisplay() {
+        if (!threadConnection.display) {
+            // Installs the error handlers the thread connections rely on
+            Initialize();
+            std::lock_guard<std::mutex> lock(connectionMutex);
+            threadConnection.display = XOpenDisplay(nullptr);
+            if (!threadConnection.display) {
+                return nullptr;
+            }
+            threadDisplays.fetch_add(1, std::memory_order_relaxed);
+        }
+        return threadConnection.display;
+    }
+
+    Atom DisplayManager::InternAtom(Display* display, const std::string& name, bool onlyIfExists) {
+        if (!display) {
+            return None;
+        }
+        if (display != threadConnection.display) {
+            return XInternAtom(display, name.c_str(), onlyIfExists);
+        }
+        auto it = threadConnection.atoms.find(name);
+        if (it != threadConnection.atoms.end()) {
+            return it->second;
+        }
+        Atom atom = XInternAtom(display, name.c_str(), onlyIfExists);
+        if (atom != None) {
+            threadConnection.atoms.emplace(name, atom);
+        }
+        return atom;
+    }
+
+    void DisplayManager::InternAtoms(Display* display, const char* const* names, int count,
+                                     bool onlyIfExists, Atom* atoms) {
+        std::vector<char*> missing;
+        std::vector<int> slots;
+        bool cached = display && display == threadConnection.display;
+        for (int i = 0; i < count; ++i) {
+            atoms[i] = None;
+            if (cached) {
+                auto it = threadConnection.atoms.find(names[i]);
+                if (it != threadConnection.atoms.end()) {
+                    atoms[i] = it->second;
+                    continue;
+                }
+            }
+            missing.push_back(const_cast<char*>(names[i]));
+            slots.push_back(i);
+        }
+        if (!display || missing.empty()) {
+            return;
+        }
+
+        std::vector<Atom> interned(missing.size(), None);
+        XInternAtoms(display, missing.data(), static_cast<int>(missing.size()),
+                     onlyIfExists, interned.data());
+        for (size_t i = 0; i < missing.size(); ++i) {
+            atoms[slots[i]] = interned[i];
+            if (cached && interned[i] != None) {
+                threadConnection.atoms.emplace(missing[i], interned[i]);
+            }
+        }
+    }
+
+    size_t DisplayManager::ThreadDisplayCount() {
+        return threadDisplays.load(std::memory_order_relaxed);
+    }
     
     int DisplayManager::X11ErrorHandler(Display* display, XErrorEvent* event) {
         char errorText[256];
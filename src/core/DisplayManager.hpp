@@ -1,17 +1,36 @@
 #pragma once
 #include "x11_includes.h"
 #include <iostream>
+#include <string>
 
 namespace havel {
 
 class DisplayManager {
 public:
+    // Calls XInitThreads, then opens the shared connection; must come
+    // before any other Xlib call
     static void Initialize();
     static Display* GetDisplay();
     static ::Window GetRootWindow();
     static void Close();
     static bool IsInitialized();
 
+    // The calling thread's own connection, opened on first use and closed
+    // when the thread exits. Threads never share it, so window operations
+    // running on different hotkey workers don't contend on one connection's
+    // lock. Requests are buffered: flush before returning to the caller.
+    // nullptr if X is unavailable.
+    static Display* GetThreadDisplay();
+    // XInternAtom, cached when `display` is the calling thread's connection
+    // so each name costs a round trip once per thread. Atoms that don't
+    // exist yet (None with onlyIfExists) are not cached.
+    static Atom InternAtom(Display* display, const std::string& name, bool onlyIfExists = false);
+    // Same for several names, with the uncached ones interned in one request
+    static void InternAtoms(Display* display, const char* const* names, int count,
+                            bool onlyIfExists, Atom* atoms);
+    // Per-thread connections currently open
+    static size_t ThreadDisplayCount();
+
     // X11 error handler
     static int X11ErrorHandler(Display* display, XErrorEvent* event);
 
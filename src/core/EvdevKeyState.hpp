@@ -0,0 +1,88 @@
+#pragma once
+
+#include <X11/X.h>
+#include <linux/input.h>
+#include <bitset>
+#include <cstdint>
+
+namespace havel {
+
+// Pressed state of every evdev key code, plus the X11 modifier mask it
+// implies. The mask is kept up to date on modifier transitions only, so
+// checking a hotkey's modifiers is a single integer compare.
+class EvdevKeyState {
+public:
+    // The modifiers evdev hotkeys can require
+    static constexpr unsigned int ModifierMask =
+        ControlMask | ShiftMask | Mod1Mask | Mod4Mask;
+
+    // Record the new state of `code` and return the previous one
+    bool Set(int code, bool down) {
+        if (code < 0 || code >= KEY_CNT) {
+            return false;
+        }
+        bool wasDown = keys.test(code);
+        if (wasDown == down) {
+            return wasDown;
+        }
+        keys.set(code, down);
+
+        int slot = ModifierSlot(code);
+        if (slot >= 0) {
+            // Left and right keys both count; the bit drops with the last one
+            if (down) {
+                if (heldPerModifier[slot]++ == 0) mods |= SlotMask[slot];
+            } else {
+                if (--heldPerModifier[slot] == 0) mods &= ~SlotMask[slot];
+            }
+        }
+        return wasDown;
+    }
+
+    bool IsDown(int code) const {
+        return code >= 0 && code < KEY_CNT && keys.test(code);
+    }
+
+    // X11-style mask of the modifiers currently held on any device
+    unsigned int Modifiers() const { return mods; }
+
+    // True when every modifier the hotkey requires is held
+    bool Matches(unsigned int hotkeyMods) const {
+        return (hotkeyMods & ModifierMask & ~mods) == 0;
+    }
+
+    void Clear() {
+        keys.reset();
+        for (auto &held : heldPerModifier) held = 0;
+        mods = 0;
+    }
+
+private:
+    static constexpr unsigned int SlotMask[4] = {
+        ControlMask, ShiftMask, Mod1Mask, Mod4Mask};
+
+    static int ModifierSlot(int code) {
+        switch (code) {
+            case KEY_LEFTCTRL:
+            case KEY_RIGHTCTRL:
+                return 0;
+            case KEY_LEFTSHIFT:
+            case KEY_RIGHTSHIFT:
+                return 1;
+            case KEY_LEFTALT:
+            case KEY_RIGHTALT:
+                return 2;
+            case KEY_LEFTMETA:
+            case KEY_RIGHTMETA:
+                return 3;
+            default:
+                return -1;
+        }
+    }
+
+    std::bitset<KEY_CNT> keys;
+    uint8_t heldPerModifier[4] = {};
+    unsigned int mods = 0;
+};
+
+} // namespace havel
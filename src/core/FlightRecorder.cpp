@@ -0,0 +1,222 @@
+#include "FlightRecorder.hpp"
+#include <algorithm>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace havel {
+
+std::atomic<bool> FlightRecorder::enabled{true};
+std::atomic<bool> FlightRecorder::recordKeyCodes{false};
+
+const char *TraceEventName(TraceEvent event) {
+    switch (event) {
+        case TraceEvent::KeyEvent:           return "key event";
+        case TraceEvent::HotkeyMatched:      return "hotkey matched";
+        case TraceEvent::ConditionEvaluated: return "condition evaluated";
+        case TraceEvent::CallbackStarted:    return "callback";
+        case TraceEvent::CallbackFinished:   return "callback";
+        case TraceEvent::UinputEmitted:      return "uinput emitted";
+        default:                             return "unknown";
+    }
+}
+
+namespace {
+
+static_assert((FlightRecorder::RingCapacity & (FlightRecorder::RingCapacity - 1)) == 0,
+              "FlightRecorder::RingCapacity must be a power of two");
+
+struct Ring {
+    TraceRecord records[FlightRecorder::RingCapacity];
+    std::atomic<uint64_t> head{0};          // Records ever written
+    std::atomic<bool> inUse{false};         // Owned by a live thread
+};
+
+// Rings are never freed: a dump, possibly from a signal handler, can read
+// them at any time. A ring whose thread exited is reused by the next one.
+std::atomic<Ring *> rings[FlightRecorder::MaxThreads];
+
+struct RingHandle {
+    Ring *ring = nullptr;
+    uint32_t thread = 0;
+    ~RingHandle() {
+        if (ring) ring->inUse.store(false, std::memory_order_release);
+    }
+};
+
+thread_local RingHandle threadRing;
+
+Ring *AcquireRing() {
+    for (auto &slot : rings) {
+        Ring *ring = slot.load(std::memory_order_acquire);
+        if (!ring) {
+            auto *fresh = new Ring();
+            fresh->inUse.store(true, std::memory_order_relaxed);
+            if (slot.compare_exchange_strong(ring, fresh, std::memory_order_acq_rel)) {
+                return fresh;
+            }
+            delete fresh;
+        }
+        bool expected = false;
+        if (ring->inUse.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+            return ring;
+        }
+    }
+    return nullptr;
+}
+
+// Snapshot of how many records each ring holds, and where they start
+struct Heads {
+    uint64_t head[FlightRecorder::MaxThreads];
+    uint64_t total = 0;
+};
+
+void SnapshotHeads(Heads &heads) {
+    // Taken once so the record count is fixed while copying
+    for (size_t i = 0; i < FlightRecorder::MaxThreads; ++i) {
+        Ring *ring = rings[i].load(std::memory_order_acquire);
+        heads.head[i] = ring ? ring->head.load(std::memory_order_acquire) : 0;
+        heads.total += std::min<uint64_t>(heads.head[i], FlightRecorder::RingCapacity);
+    }
+}
+
+// Fill a mapped dump: the header, then each ring oldest first; the
+// converter orders across threads
+void WriteDump(void *map, const Heads &heads) {
+    constexpr uint64_t capacity = FlightRecorder::RingCapacity;
+    auto *header = static_cast<TraceFileHeader *>(map);
+    memcpy(header->magic, "HVTRACE", 8);
+    header->version = FlightRecorder::FileVersion;
+    header->recordSize = sizeof(TraceRecord);
+    header->recordCount = heads.total;
+
+    auto *out = reinterpret_cast<TraceRecord *>(header + 1);
+    for (size_t i = 0; i < FlightRecorder::MaxThreads; ++i) {
+        Ring *ring = rings[i].load(std::memory_order_acquire);
+        uint64_t head = heads.head[i];
+        if (!ring || head == 0) continue;
+        uint64_t first = head > capacity ? head - capacity : 0;
+        // At most two runs, split where the ring wraps
+        while (first < head) {
+            uint64_t offset = first & (capacity - 1);
+            uint64_t run = std::min(head - first, capacity - offset);
+            memcpy(out, &ring->records[offset], run * sizeof(TraceRecord));
+            out += run;
+            first += run;
+        }
+    }
+}
+
+// A fresh file at `path` that only we can read. Whatever was there is
+// unlinked first, and O_EXCL makes sure nothing slipped back in, so a
+// file or symlink planted by someone else is never written through.
+int CreateDumpFile(const char *path) {
+    unlink(path);
+    return open(path, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC | O_NOFOLLOW, 0600);
+}
+
+// The crash dump file, mapped at its largest size up front
+std::atomic<void *> crashMap{nullptr};
+
+void CrashHandler(int signal) {
+    if (void *map = crashMap.load(std::memory_order_acquire)) {
+        Heads heads;
+        SnapshotHeads(heads);
+        WriteDump(map, heads);
+        msync(map, sizeof(TraceFileHeader) + heads.total * sizeof(TraceRecord), MS_SYNC);
+    }
+    std::signal(signal, SIG_DFL);
+    raise(signal);
+}
+
+} // namespace
+
+void FlightRecorder::Append(TraceEvent event, int hotkey, int arg) {
+    RingHandle &handle = threadRing;
+    if (!handle.ring) {
+        // Too many threads: the extra ones are not recorded
+        handle.ring = AcquireRing();
+        if (!handle.ring) return;
+        handle.thread = static_cast<uint32_t>(syscall(SYS_gettid));
+    }
+
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    Ring &ring = *handle.ring;
+    uint64_t index = ring.head.load(std::memory_order_relaxed);
+    TraceRecord &record = ring.records[index & (RingCapacity - 1)];
+    record.timeNs = static_cast<uint64_t>(now.tv_sec) * 1000000000ull + now.tv_nsec;
+    record.thread = handle.thread;
+    record.event = static_cast<uint16_t>(event);
+    record.reserved = 0;
+    record.hotkey = hotkey;
+    record.arg = arg;
+    ring.head.store(index + 1, std::memory_order_release);
+}
+
+bool FlightRecorder::Dump(const char *path) {
+    Heads heads;
+    SnapshotHeads(heads);
+
+    int fd = CreateDumpFile(path);
+    if (fd < 0) {
+        return false;
+    }
+    size_t size = sizeof(TraceFileHeader) + heads.total * sizeof(TraceRecord);
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        close(fd);
+        return false;
+    }
+    void *map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+
+    WriteDump(map, heads);
+    msync(map, size, MS_SYNC);
+    munmap(map, size);
+    return true;
+}
+
+bool FlightRecorder::InstallCrashHandler(const std::string &path) {
+    int fd = CreateDumpFile(path.c_str());
+    if (fd < 0) {
+        return false;
+    }
+    // Sparse until a crash writes to it
+    if (ftruncate(fd, static_cast<off_t>(MaxDumpSize)) != 0) {
+        close(fd);
+        return false;
+    }
+    void *map = mmap(nullptr, MaxDumpSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    // An empty dump until then
+    WriteDump(map, Heads{});
+
+    if (void *previous = crashMap.exchange(map, std::memory_order_acq_rel)) {
+        munmap(previous, MaxDumpSize);
+    }
+    for (int signal : {SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT}) {
+        std::signal(signal, CrashHandler);
+    }
+    return true;
+}
+
+void FlightRecorder::Clear() {
+    for (auto &slot : rings) {
+        if (Ring *ring = slot.load(std::memory_order_acquire)) {
+            ring->head.store(0, std::memory_order_release);
+        }
+    }
+}
+
+} // namespace havel
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace havel {
+
+enum class TraceEvent : uint16_t {
+    KeyEvent = 1,           // arg = X11 keycode or evdev key code, 0 unless
+                            // key codes are recorded
+    HotkeyMatched,
+    ConditionEvaluated,     // arg = 1 if the condition held
+    CallbackStarted,
+    CallbackFinished,       // arg = 0 if the callback threw
+    UinputEmitted,          // arg = number of input events written
+};
+
+const char *TraceEventName(TraceEvent event);
+
+// One trace record; the dump file is an array of these after the header
+struct TraceRecord {
+    uint64_t timeNs;        // CLOCK_MONOTONIC
+    uint32_t thread;        // Kernel thread id
+    uint16_t event;         // TraceEvent
+    uint16_t reserved;
+    int32_t hotkey;         // Hotkey id, -1 when not tied to one
+    int32_t arg;
+};
+static_assert(sizeof(TraceRecord) == 24, "TraceRecord is part of the dump format");
+
+struct TraceFileHeader {
+    char magic[8];          // "HVTRACE\0"
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t recordCount;
+};
+
+// Always-on binary trace of the input path.
+//
+// Every thread that records gets its own ring of fixed-size records, so
+// recording is a clock read and a few stores with no sharing between
+// threads. The rings only hold the most recent records; Dump() writes
+// whatever they hold to a memory-mapped file, which trace2json turns into
+// Chrome trace JSON. A dump taken while threads are recording may contain
+// a torn record at the point where a ring wraps.
+class FlightRecorder {
+public:
+    static constexpr uint32_t FileVersion = 1;
+    static constexpr size_t RingCapacity = 4096;    // Records per thread; power of two
+    static constexpr size_t MaxThreads = 64;
+
+    static void Record(TraceEvent event, int hotkey = -1, int arg = 0) {
+        if (enabled.load(std::memory_order_relaxed)) {
+            Append(event, hotkey, arg);
+        }
+    }
+
+    // A key event. The code is only kept when SetRecordKeyCodes(true) was
+    // called: the rings would otherwise hold everything recently typed,
+    // passwords included.
+    static void RecordKey(int code) {
+        Record(TraceEvent::KeyEvent, -1,
+               recordKeyCodes.load(std::memory_order_relaxed) ? code : 0);
+    }
+
+    static void SetEnabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+    static bool Enabled() { return enabled.load(std::memory_order_relaxed); }
+    static void SetRecordKeyCodes(bool on) {
+        recordKeyCodes.store(on, std::memory_order_relaxed);
+    }
+
+    // Write every ring to `path`; returns false if the file could not be
+    // written. Whatever is at `path` is replaced by a new file only the
+    // owner can read; a symlink there is removed, not followed.
+    static bool Dump(const char *path);
+    static bool Dump(const std::string &path) { return Dump(path.c_str()); }
+
+    // Dump to `path` on SIGSEGV, SIGBUS, SIGILL, SIGFPE and SIGABRT, then
+    // let the signal take its default course. The file is created like
+    // Dump's and mapped here, sized for every ring, so the handler itself
+    // only copies the records and syncs; readers go by the header's record
+    // count.
+    static bool InstallCrashHandler(const std::string &path);
+
+    // Drop everything recorded so far. Meant for quiet periods: a thread
+    // recording at the same time may keep its latest records.
+    static void Clear();
+
+private:
+    static void Append(TraceEvent event, int hotkey, int arg);
+    // Size of a dump holding every ring full
+    static constexpr size_t MaxDumpSize =
+        sizeof(TraceFileHeader) + MaxThreads * RingCapacity * sizeof(TraceRecord);
+
+    static std::atomic<bool> enabled;
+    static std::atomic<bool> recordKeyCodes;
+};
+
+} // namespace havel
@@ -0,0 +1,196 @@
+#include "HotkeyExecutor.hpp"
+#include "FlightRecorder.hpp"
+#include "../utils/Logger.hpp"
+#include <algorithm>
+
+namespace havel {
+
+HotkeyExecutor::HotkeyExecutor() : HotkeyExecutor(Options{}) {
+}
+
+HotkeyExecutor::HotkeyExecutor(Options opts, StartHook startHook)
+    : options(opts), onStart(std::move(startHook)) {
+    if (options.workers == 0) {
+        options.workers = std::clamp<size_t>(std::thread::hardware_concurrency(), 2, 4);
+    }
+    if (options.maxQueueDepth == 0) {
+        options.maxQueueDepth = 1;
+    }
+
+    workers.reserve(options.workers);
+    for (size_t i = 0; i < options.workers; ++i) {
+        workers.emplace_back(&HotkeyExecutor::WorkerLoop, this);
+    }
+}
+
+HotkeyExecutor::~HotkeyExecutor() {
+    Shutdown();
+}
+
+bool HotkeyExecutor::Submit(int id, std::function<void()> callback, bool serialize,
+                            Clock::time_point origin) {
+    if (!callback) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (stopping) {
+        return false;
+    }
+
+    auto &st = stats[id];
+    st.submitted++;
+
+    auto now = Clock::now();
+    Job job{id, serialize, std::move(callback), now,
+            origin == Clock::time_point{} ? now : origin};
+
+    if (serialize) {
+        auto found = strands.find(id);
+        if (found != strands.end()) {
+            auto &strand = found->second;
+            // Already in flight: one waiting repeat is enough to replay it
+            if (options.overflow == OverflowPolicy::Coalesce && !strand.backlog.empty()) {
+                st.coalesced++;
+                return true;
+            }
+            if (waiting >= options.maxQueueDepth) {
+                st.dropped++;
+                return false;
+            }
+            strand.backlog.push_back(std::move(job));
+            waiting++;
+            return true;
+        }
+        if (waiting >= options.maxQueueDepth) {
+            st.dropped++;
+            return false;
+        }
+        strands.try_emplace(id);
+    } else if (waiting >= options.maxQueueDepth) {
+        st.dropped++;
+        return false;
+    }
+
+    ready.push_back(std::move(job));
+    waiting++;
+    cv.notify_one();
+    return true;
+}
+
+void HotkeyExecutor::WorkerLoop() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [this] { return stopping || !ready.empty(); });
+            if (stopping) {
+                return;
+            }
+            job = std::move(ready.front());
+            ready.pop_front();
+            waiting--;
+        }
+
+        auto started = Clock::now();
+        if (onStart && job.origin != NoOrigin) {
+            onStart(job.id, started - job.origin);
+        }
+        bool ok = true;
+        FlightRecorder::Record(TraceEvent::CallbackStarted, job.id);
+        try {
+            job.callback();
+        } catch (const std::exception &e) {
+            lo.error("Error in hotkey callback: " + std::string(e.what()));
+            ok = false;
+        } catch (...) {
+            lo.error("Unknown error in hotkey callback");
+            ok = false;
+        }
+        FlightRecorder::Record(TraceEvent::CallbackFinished, job.id, ok ? 1 : 0);
+        Finish(job, started, ok);
+    }
+}
+
+void HotkeyExecutor::Finish(const Job &job, Clock::time_point started, bool ok) {
+    auto finished = Clock::now();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto recorded = stats.find(job.id);
+    if (recorded != stats.end()) {
+        auto &st = recorded->second;
+        auto queueWait = std::chrono::duration_cast<std::chrono::nanoseconds>(started - job.enqueued);
+        auto runTime = std::chrono::duration_cast<std::chrono::nanoseconds>(finished - started);
+        st.completed++;
+        if (!ok) st.failed++;
+        st.totalQueueWait += queueWait;
+        st.maxQueueWait = std::max(st.maxQueueWait, queueWait);
+        st.totalRunTime += runTime;
+        st.maxRunTime = std::max(st.maxRunTime, runTime);
+    }
+
+    if (!job.serialize) {
+        return;
+    }
+
+    auto it = strands.find(job.id);
+    if (it == strands.end()) {
+        return;
+    }
+    auto &strand = it->second;
+    if (strand.backlog.empty()) {
+        strands.erase(it);
+        return;
+    }
+
+    // Hand the next invocation of this hotkey to the pool; it stays counted
+    // in `waiting` as it moves from the backlog to the ready queue
+    ready.push_back(std::move(strand.backlog.front()));
+    strand.backlog.pop_front();
+    cv.notify_one();
+}
+
+void HotkeyExecutor::Shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) {
+            return;
+        }
+        stopping = true;
+    }
+    cv.notify_all();
+
+    for (auto &worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers.clear();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ready.clear();
+    strands.clear();
+    waiting = 0;
+}
+
+size_t HotkeyExecutor::QueueDepth() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return waiting;
+}
+
+std::unordered_map<int, HotkeyExecutor::LatencyStats> HotkeyExecutor::Stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void HotkeyExecutor::ResetStats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.clear();
+}
+
+void HotkeyExecutor::Forget(int id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.erase(id);
+}
+
+} // namespace havel
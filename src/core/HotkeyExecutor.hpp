@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace havel {
+
+// Fixed pool of workers that runs hotkey callbacks off the input threads.
+//
+// Jobs are tagged with the hotkey id. Serialized hotkeys never run
+// concurrently with themselves: while one invocation is running, further
+// ones wait in a per-hotkey backlog. The total number of waiting jobs is
+// bounded; what happens past that bound is decided by OverflowPolicy.
+class HotkeyExecutor {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class OverflowPolicy {
+        Drop,     // Reject new jobs once the queue is full
+        Coalesce  // Also fold repeats into an already waiting job for the same hotkey
+    };
+
+    struct Options {
+        size_t workers = 0;          // 0 = pick from hardware_concurrency
+        size_t maxQueueDepth = 256;  // Jobs waiting across all hotkeys
+        OverflowPolicy overflow = OverflowPolicy::Coalesce;
+    };
+
+    // Called on the worker as each callback starts, with the time since
+    // the job's origin; not called for jobs submitted with NoOrigin
+    using StartHook = std::function<void(int id, std::chrono::nanoseconds sinceOrigin)>;
+
+    struct LatencyStats {
+        uint64_t submitted = 0;
+        uint64_t completed = 0;
+        uint64_t dropped = 0;
+        uint64_t coalesced = 0;
+        uint64_t failed = 0;
+        std::chrono::nanoseconds totalQueueWait{0};
+        std::chrono::nanoseconds maxQueueWait{0};
+        std::chrono::nanoseconds totalRunTime{0};
+        std::chrono::nanoseconds maxRunTime{0};
+    };
+
+    HotkeyExecutor();
+    explicit HotkeyExecutor(Options options, StartHook onStart = {});
+    ~HotkeyExecutor();
+
+    HotkeyExecutor(const HotkeyExecutor&) = delete;
+    HotkeyExecutor& operator=(const HotkeyExecutor&) = delete;
+
+    // Queue `callback` for hotkey `id`. Returns false if it was dropped.
+    // A coalesced job counts as accepted. `origin` is when the triggering
+    // input happened; it defaults to now. NoOrigin marks input whose time
+    // is unknown.
+    static constexpr Clock::time_point NoOrigin = Clock::time_point::min();
+    bool Submit(int id, std::function<void()> callback, bool serialize = true,
+                Clock::time_point origin = {});
+
+    // Stop the workers; jobs that have not started are discarded
+    void Shutdown();
+
+    size_t QueueDepth() const;
+    std::unordered_map<int, LatencyStats> Stats() const;
+    void ResetStats();
+    // Drop the stats kept for `id` once nothing will be submitted under it
+    // again; a job still queued or running finishes unrecorded
+    void Forget(int id);
+
+private:
+    struct Job {
+        int id;
+        bool serialize;
+        std::function<void()> callback;
+        Clock::time_point enqueued;
+        Clock::time_point origin;
+    };
+
+    // Per-hotkey serialization state. A strand exists only while one of its
+    // invocations is queued or running, so ids that are never reused don't
+    // accumulate.
+    struct Strand {
+        std::deque<Job> backlog;
+    };
+
+    void WorkerLoop();
+    void Finish(const Job &job, Clock::time_point started, bool ok);
+
+    Options options;
+    StartHook onStart;
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<Job> ready;
+    std::unordered_map<int, Strand> strands;
+    std::unordered_map<int, LatencyStats> stats;
+    size_t waiting = 0; // ready + all backlogs
+    std::vector<std::thread> workers;
+    std::atomic<bool> stopping{false};
+};
+
+} // namespace havel
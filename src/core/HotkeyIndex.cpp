@@ -0,0 +1,83 @@
+#include "HotkeyIndex.hpp"
+#include "IO.hpp"
+#include <algorithm>
+
+namespace havel {
+
+HotkeyIndex::HotkeyIndex() : buckets(2 * 2 * KeySlots) {
+}
+
+size_t HotkeyIndex::Slot(HotkeySource source, Key code, bool isKeyUp) {
+    if (code >= KeySlots) {
+        return NoSlot;
+    }
+    size_t base = (static_cast<size_t>(source) * 2 + (isKeyUp ? 1 : 0)) * KeySlots;
+    return base + code;
+}
+
+void HotkeyIndex::Update(int id, const HotKey &hotkey) {
+    Remove(id);
+
+    if (!hotkey.enabled || hotkey.key == 0) {
+        return;
+    }
+
+    HotkeySource source = hotkey.evdev ? HotkeySource::Evdev : HotkeySource::X11;
+    size_t slot = Slot(source, hotkey.key, hotkey.isKeyUp);
+    if (slot == NoSlot) {
+        return;
+    }
+
+    auto &bucket = buckets[slot];
+    Entry entry{static_cast<unsigned int>(hotkey.modifiers), id};
+    auto pos = std::upper_bound(bucket.begin(), bucket.end(), entry,
+        [](const Entry &a, const Entry &b) {
+            return a.modifiers != b.modifiers ? a.modifiers < b.modifiers
+                                              : a.id < b.id;
+        });
+    bucket.insert(pos, entry);
+    slotOf[id] = slot;
+}
+
+void HotkeyIndex::Remove(int id) {
+    auto it = slotOf.find(id);
+    if (it == slotOf.end()) {
+        return;
+    }
+
+    auto &bucket = buckets[it->second];
+    bucket.erase(std::remove_if(bucket.begin(), bucket.end(),
+                                [id](const Entry &e) { return e.id == id; }),
+                 bucket.end());
+    slotOf.erase(it);
+}
+
+void HotkeyIndex::Clear() {
+    for (auto &bucket : buckets) {
+        bucket.clear();
+    }
+    slotOf.clear();
+}
+
+std::span<const HotkeyIndex::Entry> HotkeyIndex::Candidates(
+    HotkeySource source, Key code, bool isKeyUp) const {
+    size_t slot = Slot(source, code, isKeyUp);
+    if (slot == NoSlot) {
+        return {};
+    }
+    return buckets[slot];
+}
+
+const HotkeyIndex::Entry *HotkeyIndex::FindExact(HotkeySource source, Key code,
+                                                 bool isKeyUp,
+                                                 unsigned int modifiers) const {
+    auto bucket = Candidates(source, code, isKeyUp);
+    auto it = std::lower_bound(bucket.begin(), bucket.end(), modifiers,
+        [](const Entry &e, unsigned int mods) { return e.modifiers < mods; });
+    if (it != bucket.end() && it->modifiers == modifiers) {
+        return &*it;
+    }
+    return nullptr;
+}
+
+} // namespace havel
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "../common/types.hpp"
+#include <linux/input.h>
+#include <cstddef>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace havel {
+
+struct HotKey;
+
+// Which input path a hotkey is dispatched from. X11 hotkeys are keyed by
+// X keycode, evdev hotkeys by the raw linux input code.
+enum class HotkeySource { X11 = 0, Evdev = 1 };
+
+// Dispatch index over IO::hotkeys.
+//
+// Every (source, keycode, press/release) triple maps directly to a small
+// bucket of enabled hotkeys, presorted by modifier mask. Lookups are a
+// single array index plus a scan of that bucket and never allocate.
+// Updates touch only the bucket(s) of the hotkey that changed.
+class HotkeyIndex {
+public:
+    struct Entry {
+        unsigned int modifiers;
+        int id;
+    };
+
+    HotkeyIndex();
+
+    // Insert, move or drop `id` so the index reflects `hotkey`.
+    // Disabled hotkeys are removed from dispatch.
+    void Update(int id, const HotKey &hotkey);
+    void Remove(int id);
+    void Clear();
+
+    // All enabled hotkeys bound to this key event, sorted by modifier mask
+    std::span<const Entry> Candidates(HotkeySource source, Key code,
+                                      bool isKeyUp) const;
+
+    // Hotkey whose modifier mask equals `modifiers` exactly, or nullptr
+    const Entry *FindExact(HotkeySource source, Key code, bool isKeyUp,
+                           unsigned int modifiers) const;
+
+    size_t Size() const { return slotOf.size(); }
+
+private:
+    // Covers both X11 keycodes (8-255) and evdev codes
+    static constexpr size_t KeySlots = KEY_CNT;
+    static constexpr size_t NoSlot = static_cast<size_t>(-1);
+
+    static size_t Slot(HotkeySource source, Key code, bool isKeyUp);
+
+    std::vector<std::vector<Entry>> buckets;
+    std::unordered_map<int, size_t> slotOf; // id -> bucket it lives in
+};
+
+} // namespace havel
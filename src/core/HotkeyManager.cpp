@@ -1,5 +1,8 @@
 #include "HotkeyManager.hpp"
 #include "../utils/Logger.hpp"
+#include "FlightRecorder.hpp"
+#include "WindowClassifier.hpp"
+#include "../window/WindowMonitor.hpp"
 #include "window/Window.hpp"
 #include "core/ConfigManager.hpp"
 #include <iostream>
@@ -15,6 +18,7 @@
 #include <thread>
 #include <chrono>
 #include <atomic>
+#include <utility>
 #include "core/DisplayManager.hpp"
 #include "media/AutoRunner.h"
 // Include XRandR for multi-monitor support
@@ -25,6 +29,12 @@
 namespace havel {
 // Initialize static member
 std::string HotkeyManager::currentMode = "default";
+std::mutex HotkeyManager::modeMutex;
+
+std::string HotkeyManager::exchangeMode(const std::string& mode) {
+    std::lock_guard<std::mutex> lock(modeMutex);
+    return std::exchange(currentMode, mode);
+}
 
 // Constructor
 HotkeyManager::HotkeyManager(IO& io, WindowManager& windowManager, MPVController& mpv, ScriptEngine& scriptEngine)
@@ -40,6 +50,7 @@ HotkeyManager::HotkeyManager(IO& io, WindowManager& windowManager, MPVController
     genshinAutoRunner = new AutoRunner(io);
     
     loadVideoSites();
+    loadGamingRules();
 }
 
 void HotkeyManager::Zoom(int zoom, IO& io) {
@@ -124,6 +135,8 @@ void HotkeyManager::updateVideoPlaybackStatus() {
 }
 
 void HotkeyManager::RegisterDefaultHotkeys() {
+    // Publish the whole set to the input threads in one snapshot
+    IO::HotkeyBatch batch;
     // Auto-start applications if enabled
     // Temporarily commenting out auto-start until ScriptEngine config is fixed
     /*if (scriptEngine.GetConfig().Get<bool>("System.AutoStart", false)) {
@@ -133,10 +146,17 @@ void HotkeyManager::RegisterDefaultHotkeys() {
 
     // Mode toggles
     io.Hotkey("^!g", [this]() {
-        std::string oldMode = currentMode;
-        currentMode = (currentMode == "gaming") ? "default" : "gaming";
-        logModeSwitch(oldMode, currentMode);
-        showNotification("Mode Changed", "Active mode: " + currentMode);
+        std::string oldMode;
+        std::string newMode;
+        {
+            std::lock_guard<std::mutex> lock(modeMutex);
+            oldMode = currentMode;
+            newMode = (oldMode == "gaming") ? "default" : "gaming";
+            currentMode = newMode;
+        }
+        conditions.Invalidate();
+        logModeSwitch(oldMode, newMode);
+        showNotification("Mode Changed", "Active mode: " + newMode);
     });
 
     // Basic application hotkeys
@@ -406,6 +426,7 @@ void HotkeyManager::PlayPause() {
     }
 }
 void havel::HotkeyManager::RegisterMediaHotkeys() {
+    IO::HotkeyBatch batch;
     int mpvBaseId = 10000;
 std::vector<HotkeyDefinition> mpvHotkeys = {
     // Volume
@@ -459,13 +480,14 @@ std::vector<HotkeyDefinition> mpvHotkeys = {
     }
 
     // If not in gaming mode, immediately ungrab all MPV hotkeys
-    if (currentMode != "gaming") {
+    if (!inGamingMode()) {
         lo.info("Starting in normal mode - unregistering MPV hotkeys");
         ungrabGamingHotkeys();
     }
 }
 
 void HotkeyManager::RegisterWindowHotkeys() {
+    IO::HotkeyBatch batch;
     // Window movement
     io.Hotkey("^!Up", []() {
         WindowManager::MoveWindow(1);
@@ -514,6 +536,7 @@ void HotkeyManager::RegisterWindowHotkeys() {
 }
 
 void HotkeyManager::RegisterSystemHotkeys() {
+    IO::HotkeyBatch batch;
     // Register Windows key handler
     io.Hotkey("@lwin", [this]() {
         onLeftWinKey(true);
@@ -617,12 +640,24 @@ bool HotkeyManager::AddHotkey(const std::string& hotkeyStr, const std::string& a
 }
 
 bool HotkeyManager::RemoveHotkey(const std::string& hotkeyStr) {
-    // Remove a hotkey
+    // AddHotkey registers the converted string as the alias
+    std::string alias = parseHotkeyString(hotkeyStr);
+    int id = 0;
+    {
+        std::lock_guard<std::mutex> lock(IO::hotkeyWriteMutex);
+        for (const auto& [hotkeyId, hotkey] : IO::hotkeys) {
+            if (hotkey.alias == alias) {
+                id = hotkeyId;
+                break;
+            }
+        }
+    }
     lo.info("Removing hotkey: " + hotkeyStr);
-    return true;
+    return id != 0 && io.RemoveHotkey(id);
 }
 
 void HotkeyManager::LoadHotkeyConfigurations() {
+    IO::HotkeyBatch batch;
     // Load hotkeys from configuration file
     // This would typically read from a JSON or similar config file
 
@@ -640,6 +675,10 @@ void HotkeyManager::ReloadConfigurations() {
 
     // Reload video sites
     loadVideoSites();
+
+    // Reload the gaming window rules; cached conditions may depend on them
+    loadGamingRules();
+    conditions.Invalidate();
 }
 int HotkeyManager::AddContextualHotkey(const std::string& key, const std::string& condition,
                                            std::function<void()> trueAction,
@@ -651,23 +690,28 @@ int HotkeyManager::AddContextualHotkey(const std::string& key, const std::string
         id = nextId++;
     }
 
+    // Compile the condition once; firing only looks up the cached result
+    auto compiled = conditions.Add(condition);
+    if (!compiled->condition.Ok()) {
+        lo.error("Invalid condition '" + condition + "' " + compiled->condition.Error() +
+                 "; the hotkey will always take the false branch");
+    }
+
     // Wrap action in condition check
-    auto action = [this, condition, trueAction, falseAction]() {
-        if (verboseKeyLogging)
-            lo.debug("Evaluating condition: " + condition);
+    auto action = [this, compiled, trueAction, falseAction, id]() {
+        HOT_LOG("Evaluating condition: %s", compiled->condition.Text().c_str());
 
-        bool conditionMet = evaluateCondition(condition);
+        bool conditionMet = conditions.Resolve(*compiled);
+        FlightRecorder::Record(TraceEvent::ConditionEvaluated, id, conditionMet ? 1 : 0);
 
         if (conditionMet) {
             if (trueAction) {
-                if (verboseKeyLogging)
-                    lo.debug("Condition met, executing true action");
+                HOT_LOG("Condition met, executing true action");
                 trueAction();
             }
         } else {
             if (falseAction) {
-                if (verboseKeyLogging)
-                    lo.debug("Condition not met, executing false action");
+                HOT_LOG("Condition not met, executing false action");
                 falseAction();
             }
         }
@@ -677,232 +721,230 @@ int HotkeyManager::AddContextualHotkey(const std::string& key, const std::string
     HotKey hk = io.AddHotkey(key, action, id);
 
     // Cache or react to initial state
-    updateHotkeyStateForCondition(condition, evaluateCondition(condition));
+    updateHotkeyStateForCondition(compiled->condition, conditions.Resolve(*compiled));
 
     conditionalHotkeyIds.push_back(id);
     return id;
 }
 
-bool HotkeyManager::checkWindowCondition(const std::string& condition) {
-    // This method checks if a specific window-related condition is met (like class or title)
-    // Return true if the condition is met, false otherwis
-    if (condition.substr(0, 14) == "Window.Active(") {
-        std::string param;
-        if (condition.length() > 14) {
-            param = condition.substr(14, condition.length() - 16);
-        }
-
-        bool negation = condition[0] == '!';
-        if (negation && param.length() > 0) {
-            param = param.substr(1);
-        }
-        auto value = param.substr(param.find(':') != std::string::npos ? param.rfind(':') + 1 : 0);
+bool HotkeyManager::evaluateCompiled(const CompiledCondition& condition) {
+    // Only reads the context captured by refreshConditionContext, so a
+    // cache miss on the key press path still needs no X round trip
+    ConditionContext current;
+    {
+        std::lock_guard<std::mutex> lock(contextMutex);
+        current = context;
+    }
+    std::string mode = getMode();
 
-        // Get active window information
-        wID activeWindow = WindowManager::GetActiveWindow();
-        bool result = false;
+    ConditionFacts facts;
+    facts.className = current.className;
+    facts.title = current.title;
+    facts.exe = current.exe;
+    facts.mode = mode;
+    facts.zooming = isZooming();
+    facts.variables = &current.variables;
 
-        if (activeWindow != 0) {
-            // If the parameter starts with "class:" it means we want to match by window class
-            if (param.substr(0, 6) == "class:") {
-                // Get active window class directly and check for match
-                std::string activeWindowClass = WindowManager::GetActiveWindowClass();
+    bool result = condition.Evaluate(facts);
 
-                if (verboseWindowLogging) {
-                    logWindowEvent("WINDOW_CHECK",
-                        "Active window class '" + activeWindowClass + "' checking for '" + value + "'");
-                }
+    if (verboseWindowLogging) {
+        logWindowEvent("CONDITION_RESULT", condition.Text() + " = " + (result ? "TRUE" : "FALSE") +
+            " (class '" + current.className + "', title '" + current.title + "')");
+    }
+    return result;
+}
 
-                // Check if class contains our match string
-                result = (activeWindowClass.find(value) != std::string::npos);
-            }
-            // If the parameter starts with "name:" it explicitly specifies title matching
-            else if (param.substr(0, 5) == "name:") {
-                // Get active window title directly
-                try {
-                    Window window(std::to_string(activeWindow), activeWindow);
-                    std::string activeWindowTitle = window.Title();
-
-                    if (verboseWindowLogging) {
-                        logWindowEvent("WINDOW_CHECK",
-                            "Active window title '" + activeWindowTitle + "' checking for '" + value + "'");
-                    }
-
-                    // Check if title contains our match string
-                    result = (activeWindowTitle.find(value) != std::string::npos);
-                } catch (...) {
-                    lo.error("Failed to get active window title");
-                    result = false;
-                }
-            }
-            // Legacy/default case: just match by title
-            else {
-                try {
-                    std::string activeWindowTitle = WindowManager::activeWindow.title;
-
-                    if (verboseWindowLogging) {
-                        logWindowEvent("WINDOW_CHECK",
-                            "Active window title (legacy) '" + activeWindowTitle + "' checking for '" + param + "'");
-                    }
-
-                    // Check if title contains our match string
-                    result = (activeWindowTitle.find(value) != std::string::npos);
-                } catch (...) {
-                    lo.error("Failed to get active window title");
-                    result = false;
-                }
-            }
+void HotkeyManager::setConditionVariable(const std::string& name, const std::string& value) {
+    {
+        std::lock_guard<std::mutex> lock(contextMutex);
+        auto it = context.variables.find(name);
+        if (it != context.variables.end() && it->second == value) {
+            return;
         }
+        context.variables[name] = value;
+    }
+    conditions.Invalidate();
+}
 
-        // Handle negation if present
-        if (negation) result = !result;
-
-        return result;
+void HotkeyManager::onActiveWindowChanged(const WindowInfo& info) {
+    windowEvents.store(true, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(contextMutex);
+        context.window = info.windowId;
+        context.className = info.windowClass;
+        context.title = info.title;
+        context.exe = info.processName;
     }
+    conditions.Invalidate();
 
-    return false;
+    // Switch mode and grab or ungrab now rather than on the next poll
+    checkHotkeyStates();
 }
 
-void HotkeyManager::updateHotkeyStateForCondition(const std::string& condition, bool conditionMet) {
-    // This handles grabbing or ungrabbing hotkeys based on condition state changes
-    // We only care about certain conditions like window class/title matches
-
-    // First, check if we need to handle this condition
-    if (condition.find("currentMode == 'gaming'") != std::string::npos ||
-        condition.find("Window.Active") != std::string::npos) {
-
-        // Check if state has changed since last time
-        auto it = windowConditionStates.find(condition);
-        bool stateChanged = (it == windowConditionStates.end() || it->second != conditionMet);
-
-        // Update the stored state
-        windowConditionStates[condition] = conditionMet;
-        // Only take action if the state changed
-        if (stateChanged) {
-            if (conditionMet) {
-                // Condition is now met, grab the keys
-                if (!mpvHotkeysGrabbed && (condition.find("currentMode == 'gaming'") != std::string::npos)) {
-                    lo.info("Condition met: " + condition + " - Grabbing MPV hotkeys");
-                    grabGamingHotkeys();
-                }
-
-                // Log the state change
-        if (verboseWindowLogging) {
-                    logWindowEvent("CONDITION_STATE", "Condition now TRUE: " + condition);
-                }
-            } else {
-                // Condition is now not met, ungrab the keys
-                if (mpvHotkeysGrabbed && (condition.find("currentMode == 'gaming'") != std::string::npos)) {
-                    lo.info("Condition no longer met: " + condition + " - Ungrabbing MPV hotkeys");
-                    ungrabGamingHotkeys();
-                }
+void HotkeyManager::pollActiveWindow() {
+    wID active = WindowManager::GetActiveWindow();
 
-                // Log the state change
-                if (verboseWindowLogging) {
-                    logWindowEvent("CONDITION_STATE", "Condition now FALSE: " + condition);
-                }
-            }
+    std::string title;
+    if (active != 0 && conditions.Needs(CompiledCondition::NeedsTitle)) {
+        try {
+            Window window(std::to_string(active), active);
+            title = window.Title();
+        } catch (...) {
+            lo.error("Failed to get active window title");
         }
     }
-}
-void HotkeyManager::checkHotkeyStates() {
-    // Example: check if we’re in gaming mode
-    bool gamingModeActive = isGamingWindow();
-    updateHotkeyStateForCondition("currentMode == 'gaming'", gamingModeActive);
 
-    // Example: check if the active window matches some criteria
-    std::string activeWindowTitle = WindowManager::activeWindow.title;
-    std::string activeWindowClass = WindowManager::activeWindow.className;
-    for (auto const& [key, value] : windowConditionStates) {
-        bool conditionMet = evaluateCondition(key);
-        updateHotkeyStateForCondition(key, conditionMet);
+    // The executable only changes with the window
+    std::string exe;
+    if (active != 0 && conditions.Needs(CompiledCondition::NeedsExe)) {
+        wID known;
+        {
+            std::lock_guard<std::mutex> lock(contextMutex);
+            known = context.window;
+            exe = context.exe;
+        }
+        if (active != known) {
+            pID pid = WindowManager::GetWindowPID(active);
+            exe = pid > 0 ? WindowManager::getProcessName(pid) : "";
+        }
     }
-}
 
-bool HotkeyManager::evaluateCondition(const std::string& condition) {
-    bool negated = !condition.empty() && condition[0] == '!';
-    std::string actual = negated ? condition.substr(1) : condition;
-
-    if (verboseWindowLogging && negated)
-        logWindowEvent("CONDITION_CHECK", "Detected negation: " + actual);
-
-    bool result = false;
-
-    if (actual == "IsZooming") {
-        result = isZooming();
-    }
-    else if (actual == "currentMode == 'gaming'") {
-        result = (currentMode == "gaming");
-
-        if (isGamingWindow()) {
-            if (currentMode != "gaming") {
-                std::string old = currentMode;
-                currentMode = "gaming";
-                logModeSwitch(old, currentMode);
-                if (verboseWindowLogging)
-                    logWindowEvent("AUTO_MODE_CHANGE", "Switched to gaming mode (detected)");
-                lo.info(WindowManager::activeWindow.className);
-                lo.info(WindowManager::activeWindow.title);
-                lo.info("Auto-switched to gaming mode (detected)");
-            }
-            result = true;
+    bool changed = false;
+    {
+        std::lock_guard<std::mutex> lock(contextMutex);
+        if (active != context.window || title != context.title) {
+            context.window = active;
+            context.className = WindowManager::activeWindow.className;
+            context.title = title;
+            context.exe = exe;
+            changed = true;
         }
+    }
+    if (changed) {
+        conditions.Invalidate();
+    }
+}
 
-        if (!result && currentMode == "gaming") {
-            std::string old = currentMode;
-            currentMode = "default";
-            logModeSwitch(old, currentMode);
-            if (verboseWindowLogging)
-                logWindowEvent("AUTO_MODE_CHANGE", "Switched to normal mode");
-            lo.info("Auto-switched to normal mode");
-        }
+void HotkeyManager::refreshConditionContext() {
+    // A WindowMonitor feeding onActiveWindowChanged keeps the window part
+    // current; otherwise ask the X server
+    if (!windowEvents.load(std::memory_order_acquire)) {
+        pollActiveWindow();
+    }
 
-        if (verboseWindowLogging && !result)
-            logWindowEvent("MODE_CHECK", "Not in gaming mode");
+    wID active;
+    std::string className;
+    {
+        std::lock_guard<std::mutex> lock(contextMutex);
+        active = context.window;
+        className = context.className;
     }
-    else if (actual.rfind("Window.Active", 0) == 0) {
-        result = checkWindowCondition(condition);
-        if (verboseWindowLogging)
-            logWindowEvent("CONDITION_CHECK", actual + " = " + (result ? "TRUE" : "FALSE"));
+
+    // Follow the active window into and out of gaming mode
+    std::string mode = isGamingClass(className) ? "gaming" : "default";
+    exchangeMode(mode);
+
+    std::string oldMode;
+    {
+        std::lock_guard<std::mutex> lock(contextMutex);
+        oldMode = context.mode;
+        context.mode = mode;
     }
-    else {
-        lo.warning("Unrecognized condition: " + actual);
+    if (oldMode != mode) {
+        conditions.Invalidate();
+        if (!oldMode.empty()) {
+            logModeSwitch(oldMode, mode);
+            lo.info("Auto-switched to " + mode + " mode");
+        }
     }
 
-    if (negated) {
-        result = !result;
-        if (verboseWindowLogging)
-            logWindowEvent("CONDITION_RESULT", "Final result after negation: " + std::string(result ? "TRUE" : "FALSE"));
-    } else if (verboseWindowLogging) {
-        logWindowEvent("CONDITION_RESULT", "Final result: " + std::string(result ? "TRUE" : "FALSE"));
+    if (active != lastActiveWindowId && active != 0) {
+        lastActiveWindowId = active;
+        if (verboseWindowLogging) {
+            logWindowEvent("CONTEXT_CHANGE", "Class: \"" + className + "\", Mode: " + mode);
+        }
+        // Log focus change if enabled
+        if (trackWindowFocus) {
+            printActiveWindowInfo();
+        }
     }
+}
 
-    updateHotkeyStateForCondition(condition, result);
+void HotkeyManager::updateHotkeyStateForCondition(const CompiledCondition& condition, bool conditionMet) {
+    // This handles grabbing or ungrabbing hotkeys based on condition state changes.
+    // Whether the compiled expression reads the mode decides whether it
+    // concerns the MPV hotkeys, however the mode is spelled or compared.
+    bool readsMode = condition.Needs() & CompiledCondition::NeedsMode;
 
-    // Log focus change if enabled
-    if (trackWindowFocus) {
-        wID active = WindowManager::GetActiveWindow();
-        if (active != lastActiveWindowId && active != 0) {
-            lastActiveWindowId = active;
-            printActiveWindowInfo();
+    std::lock_guard<std::recursive_mutex> lock(hotkeyStateMutex);
+
+    // Check if state has changed since last time
+    const std::string& text = condition.Text();
+    auto it = windowConditionStates.find(text);
+    bool stateChanged = (it == windowConditionStates.end() || it->second != conditionMet);
+
+    // Update the stored state
+    windowConditionStates[text] = conditionMet;
+    // Only take action if the state changed
+    if (!stateChanged) {
+        return;
+    }
+
+    if (readsMode) {
+        // The MPV hotkeys follow the mode itself, not this condition's
+        // value, so `mode != 'gaming'` does not grab them
+        if (inGamingMode()) {
+            if (!mpvHotkeysGrabbed) {
+                lo.info("Condition changed: " + text + " - Grabbing MPV hotkeys");
+                grabGamingHotkeys();
+            }
+        } else if (mpvHotkeysGrabbed) {
+            lo.info("Condition changed: " + text + " - Ungrabbing MPV hotkeys");
+            ungrabGamingHotkeys();
         }
     }
 
+    // Log the state change
+    if (verboseWindowLogging) {
+        logWindowEvent("CONDITION_STATE",
+            std::string("Condition now ") + (conditionMet ? "TRUE: " : "FALSE: ") + text);
+    }
+}
+void HotkeyManager::checkHotkeyStates() {
+    std::lock_guard<std::recursive_mutex> lock(hotkeyStateMutex);
+    refreshConditionContext();
+
+    // Recompute whatever the context change made stale here, off the key
+    // press path, and grab or ungrab on the results that changed
+    conditions.Refresh([this](const CompiledCondition& condition, bool conditionMet) {
+        updateHotkeyStateForCondition(condition, conditionMet);
+    });
+}
+
+bool HotkeyManager::evaluateCondition(const std::string& condition) {
+    auto entry = conditions.Add(condition);
+    bool result = conditions.Resolve(*entry);
+    updateHotkeyStateForCondition(entry->condition, result);
     return result;
 }
 
 void HotkeyManager::grabGamingHotkeys() {
+    std::lock_guard<std::recursive_mutex> lock(hotkeyStateMutex);
     if (mpvHotkeysGrabbed) {
         // Already grabbed, nothing to do
         return;
     }
 
-    int i = 0;
-    for (const auto& [id, hotkey] : IO::hotkeys) {
-        std::cout << "Index " << i << ": ID = " << id << " alias " << hotkey.alias << "\n";
-        ++i;
+    {
+        std::lock_guard<std::mutex> hotkeysLock(IO::hotkeyWriteMutex);
+        int i = 0;
+        for (const auto& [id, hotkey] : IO::hotkeys) {
+            std::cout << "Index " << i << ": ID = " << id << " alias " << hotkey.alias << "\n";
+            ++i;
+        }
     }
     // Grab all MPV hotkey IDs that we've stored
+    IO::HotkeyBatch batch;
     for (int id : conditionalHotkeyIds) {
         lo.info("Grabbing hotkey: " + std::to_string(id));
         io.GrabHotkey(id);
@@ -913,6 +955,7 @@ void HotkeyManager::grabGamingHotkeys() {
 }
 
 void HotkeyManager::ungrabGamingHotkeys() {
+    std::lock_guard<std::recursive_mutex> lock(hotkeyStateMutex);
     if (!mpvHotkeysGrabbed) {
         // Already ungrabbed, nothing to do
         return;
@@ -932,61 +975,35 @@ void HotkeyManager::showNotification(const std::string& title, const std::string
     system(cmd.c_str());
 }
 
-bool HotkeyManager::isGamingWindow() {
-    std::string windowClass = WindowManager::activeWindow.className;
-
-    // List of window classes for gaming applications
-    const std::vector<std::string> gamingApps = {
-        "steam_app_default",      // Steam games
-        "retroarch",      // RetroArch emulator
-        "ryujinx",        // Nintendo Switch emulator
-        "pcsx2",          // PlayStation 2 emulator
-        "dolphin-emu",    // GameCube/Wii emulator
-        "rpcs3",          // PlayStation 3 emulator
-        "cemu",           // Wii U emulator
-        "yuzu",           // Another Switch emulator
-        "duckstation",    // PlayStation 1 emulator
-        "ppsspp",         // PSP emulator
-        "xemu",           // Original Xbox emulator
-        "wine",           // Wine (Windows games on Linux)
-        "lutris",         // Lutris game launcher
-        "heroic",         // Epic Games launcher for Linux
-        "gamescope",      // Valve's gaming compositor
-        "games",           // Generic games category
-        "minecraft",
-		"nierautomata"
-    };
-    // Convert window class to lowercase
-    std::transform(windowClass.begin(), windowClass.end(), windowClass.begin(), ::tolower);
-    // Check if window class contains any gaming app identifier
-    for (const auto& app : gamingApps) {
-        if (windowClass.find(app) != std::string::npos) {
-            currentMode = "gaming";
-            return true;
-        }
-    }
+static std::atomic<std::shared_ptr<WindowClassifier>> gamingClassifier;
 
-    // Check for specific full class names
-    const std::vector<std::string> exactGamingClasses = {
-        "Minecraft",
-        "minecraft-launcher",
-        "factorio",
-        "stardew_valley",
-        "terraria",
-        "dota2",
-        "csgo",
-        "goggalaxy",      // GOG Galaxy
-        "MangoHud"        // Often used with games
-    };
+void HotkeyManager::loadGamingRules() {
+    auto defaults = WindowClassifier::DefaultGamingRules();
+    WindowClassifier::Rules rules;
+    rules.contains = WindowClassifier::SplitList(havel::Configs::Get().Get<std::string>(
+        "Gaming.Classes", WindowClassifier::JoinList(defaults.contains)));
+    rules.exact = WindowClassifier::SplitList(havel::Configs::Get().Get<std::string>(
+        "Gaming.ExactClasses", WindowClassifier::JoinList(defaults.exact)));
 
-    for (const auto& exactClass : exactGamingClasses) {
-        if (windowClass == exactClass) {
-            currentMode = "gaming";
-            return true;
-        }
+    gamingClassifier.store(std::make_shared<WindowClassifier>(rules), std::memory_order_release);
+    lo.debug("Loaded " + std::to_string(rules.contains.size() + rules.exact.size()) +
+             " gaming window rules");
+}
+
+bool HotkeyManager::isGamingClass(const std::string& className) {
+    auto classifier = gamingClassifier.load(std::memory_order_acquire);
+    if (!classifier) {
+        loadGamingRules();
+        classifier = gamingClassifier.load(std::memory_order_acquire);
     }
-    currentMode = "default";
-    return false;
+    return classifier->Matches(className);
+}
+
+bool HotkeyManager::isGamingWindow() {
+    const auto& active = WindowManager::activeWindow;
+    bool gaming = isGamingClass(active.className);
+    exchangeMode(gaming ? "gaming" : "default");
+    return gaming;
 }
 
     void HotkeyManager::startAutoclicker(const std::string& button) {
@@ -1024,29 +1041,23 @@ bool HotkeyManager::isGamingWindow() {
             autoPresser->Start(keys, config.clickInterval);
         }
         
-        // Start a thread to monitor window focus
-        autoclickerThread = std::thread([this]() {
-            while (autoclickerActive) {
-                // Check if window changed
-                wID activeWindow = WindowManager::GetActiveWindow();
-                if (activeWindow != autoclickerWindowID) {
-                    lo.info("Stopping autoclicker - window changed");
-                    stopAllAutoclickers();
-                    break;
-                }
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        // Monitor window focus on the shared timer thread
+        autoclickerMonitor = TimerService::Get().Every(std::chrono::milliseconds(100), [this]() {
+            // Check if window changed
+            wID activeWindow = WindowManager::GetActiveWindow();
+            if (activeWindow != autoclickerWindowID) {
+                lo.info("Stopping autoclicker - window changed");
+                stopAllAutoclickers();
             }
-            lo.info("Autoclicker monitor thread terminated");
         });
-        
-        // Detach the monitor thread
-    autoclickerThread.detach();
 }
 
     // Call this when you need to force-stop (e.g., on app exit)
 void HotkeyManager::stopAllAutoclickers() {
     if (autoclickerActive) {
         autoclickerActive = false;
+        TimerService::Get().Cancel(autoclickerMonitor);
+        autoclickerMonitor = 0;
         
         // Stop both auto-clicker and auto-presser
         autoClicker->Stop();
@@ -1333,22 +1344,22 @@ void HotkeyManager::handleMediaCommand(const std::vector<std::string>& mpvComman
 // Implement setMode to handle mode changes and key grabbing
 void HotkeyManager::setMode(const std::string& mode) {
     // Don't do anything if the mode isn't changing
-    if (mode == currentMode) return;
-
-    std::string oldMode = currentMode;
-    currentMode = mode;
+    std::string oldMode = exchangeMode(mode);
+    if (oldMode == mode) return;
+    conditions.Invalidate();
 
     // Log the mode change
-    logModeSwitch(oldMode, currentMode);
+    logModeSwitch(oldMode, mode);
 
     // Update window condition state for our gaming mode condition
     // This will trigger the appropriate hotkey grab/ungrab
-    updateHotkeyStateForCondition("currentMode == 'gaming'", currentMode == "gaming");
+    updateHotkeyStateForCondition(conditions.Add("currentMode == 'gaming'")->condition,
+                                  mode == "gaming");
 
     if (verboseWindowLogging) {
         logWindowEvent("MODE_CHANGE",
-            oldMode + " → " + currentMode +
-            (currentMode == "gaming" ? " (MPV hotkeys active)" : " (MPV hotkeys inactive)"));
+            oldMode + " → " + mode +
+            (mode == "gaming" ? " (MPV hotkeys active)" : " (MPV hotkeys inactive)"));
     }
 }
 
@@ -1542,7 +1553,7 @@ void HotkeyManager::printActiveWindowInfo() {
     std::string gamingStatus = isGaming ? (COLOR_GREEN + std::string("YES ✓") + COLOR_RESET) : (COLOR_RED + std::string("NO ✗") + COLOR_RESET);
     lo.info(formatLine("Is Gaming Window: ", gamingStatus));
 
-    lo.info(formatLine("Current Mode: ", currentMode));
+    lo.info(formatLine("Current Mode: ", getMode()));
     lo.info("╚══════════════════════════════════════════════════════════╝");
 
     // Log to window event history
@@ -5,13 +5,18 @@
 #include "ScriptEngine.hpp"
 #include "BrightnessManager.hpp"
 #include "../utils/Utils.hpp"
+#include "../utils/HotLog.hpp"
 #include "AutoClicker.hpp"
 #include "AutoPresser.hpp"
+#include "TimerService.hpp"
+#include "ConditionCache.hpp"
 #include "../media/AutoRunner.h"
 #include <functional>
 #include <filesystem>
 #include <string>
 #include <map>
+#include <unordered_map>
+#include <mutex>
 #include <regex>
 #include <vector>
 #include <ctime>
@@ -26,6 +31,7 @@ namespace havel {
     };
 
     class MPVController; // Forward declaration
+    struct WindowInfo;
     class HotkeyManager {
     public:
         HotkeyManager(IO &io, WindowManager &windowManager, MPVController &mpv,
@@ -48,7 +54,11 @@ namespace havel {
         std::unique_ptr<AutoRunner> autoRunner;
         std::mutex autoRunnerMutex;
         AutoRunner* genshinAutoRunner = nullptr;
-        void setVerboseKeyLogging(bool value) { verboseKeyLogging = value; }
+        // Also gates the per-event HOT_LOG lines of the input loops
+        void setVerboseKeyLogging(bool value) {
+            verboseKeyLogging = value;
+            HotLog::SetEnabled(value);
+        }
 
         void setVerboseWindowLogging(bool value) {
             verboseWindowLogging = value;
@@ -92,9 +102,15 @@ namespace havel {
         // Mode management
         void setMode(const std::string &mode);
 
-        std::string getMode() const { return currentMode; }
+        std::string getMode() const {
+            std::lock_guard<std::mutex> lock(modeMutex);
+            return currentMode;
+        }
         bool isZooming() const { return m_isZooming; }
-        void setZooming(bool zooming) { m_isZooming = zooming; }
+        void setZooming(bool zooming) {
+            m_isZooming = zooming;
+            conditions.Invalidate();
+        }
 
         // MPV hotkey management
         void grabGamingHotkeys();
@@ -122,6 +138,13 @@ namespace havel {
         // Make this public so main.cpp can call it for window checks
         bool evaluateCondition(const std::string &condition);
 
+        // Set a variable conditions can test as $name
+        void setConditionVariable(const std::string &name, const std::string &value);
+
+        // Feed from a WindowMonitor; once called, the active window is no
+        // longer polled from the X server
+        void onActiveWindowChanged(const WindowInfo &info);
+
         // Window management
         void minimizeActiveWindow();
 
@@ -138,12 +161,15 @@ namespace havel {
 
         void toggleWindowFocusTracking();
         static bool isGamingWindow();
+        static bool isGamingClass(const std::string &className);
             static std::string currentMode;
+            // Guards currentMode, which is written by the context poll,
+            // setMode and hotkey callbacks on executor workers
+            static std::mutex modeMutex;
     private:
         void PlayPause();
         IO &io;
         std::atomic<bool> genshinAutomationActive = false;
-        std::thread genshinThread;
         WindowManager &windowManager;
         MPVController &mpv;
         ScriptEngine &scriptEngine;
@@ -158,6 +184,10 @@ namespace havel {
         // Hotkey state management
         bool mpvHotkeysGrabbed{false};
         std::map<std::string, bool> windowConditionStates;
+        // Serializes the main loop poll and window events, which both
+        // refresh the context and grab or ungrab; recursive because the
+        // refresh calls back into grabGamingHotkeys/ungrabGamingHotkeys
+        std::recursive_mutex hotkeyStateMutex;
         // Tracks if particular window conditions were met
 
         // Window groups
@@ -167,6 +197,7 @@ namespace havel {
 
         bool autoclickerActive = false;
         wID autoclickerWindowID = 0;
+        TimerService::TimerId autoclickerMonitor = 0;
         // Auto-clicking and auto-pressing
         std::shared_ptr<AutoClicker> autoClicker;
         std::shared_ptr<AutoPresser> autoPresser;
@@ -330,6 +361,9 @@ namespace havel {
         // New methods for video timeout
         void loadVideoSites();
 
+        // Builds the classifier behind isGamingWindow from the config
+        static void loadGamingRules();
+
         bool hasVideoTimedOut() const;
 
         void updateLastVideoCheck();
@@ -337,18 +371,43 @@ namespace havel {
         // Store IDs of MPV hotkeys for grab/ungrab
         std::vector<int> conditionalHotkeyIds;
 
+        // What conditions are evaluated against, captured when the
+        // active window or the mode changes
+        struct ConditionContext {
+            wID window = 0;
+            std::string className;
+            std::string title;
+            std::string exe;
+            std::string mode;
+            std::unordered_map<std::string, std::string> variables;
+        };
+
         // Window condition helper methods
-        bool checkWindowCondition(const std::string &condition);
+        bool evaluateCompiled(const CompiledCondition &condition);
+
+        void refreshConditionContext();
+
+        void pollActiveWindow();
 
-        void updateHotkeyStateForCondition(const std::string &condition,
+        void updateHotkeyStateForCondition(const CompiledCondition &condition,
                                            bool conditionMet);
 
         // Window focus tracking
-        bool trackWindowFocus;
-        wID lastActiveWindowId;
+        bool trackWindowFocus{false};
+        wID lastActiveWindowId{0};
+
+        std::mutex contextMutex;
+        ConditionContext context;
+        std::atomic<bool> windowEvents{false};
+        // Compiled contextual conditions, cached until the context changes
+        ConditionCache conditions{[this](const CompiledCondition &condition) {
+            return evaluateCompiled(condition);
+        }};
         
         // Windows key state
         bool leftWinKeyPressed{false};
-        bool inGamingMode() const { return currentMode == "gaming"; }
+        bool inGamingMode() const { return getMode() == "gaming"; }
+        // Sets currentMode and returns the previous one
+        static std::string exchangeMode(const std::string &mode);
     };
 }
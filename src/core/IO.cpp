@@ -1,21 +1,38 @@
 #include "../utils/Logger.hpp"
 #include "../utils/Utils.hpp"
+#include "../utils/HotLog.hpp"
 #include "x11_includes.h"
+#include <X11/XKBlib.h>
 #include "IO.hpp"
 #include "core/DisplayManager.hpp"
 #include "../window/WindowManager.hpp"
+#include "ConfigManager.hpp"
+#include "TimerService.hpp"
+#include "KeymapTable.hpp"
+#include "FlightRecorder.hpp"
 #include <algorithm>
 #include <iostream>
 #include <thread>
 #include <cmath>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <filesystem>
+#include <string_view>
 
 namespace havel {
 #if defined(WINDOWS)
 HHOOK IO::keyboardHook = NULL;
 #endif
     std::unordered_map<int, HotKey> IO::hotkeys; // Map to store hotkeys by ID
+    std::mutex IO::hotkeyWriteMutex;
+    std::atomic<std::shared_ptr<const HotkeySnapshot>> IO::hotkeySnapshot{
+        std::make_shared<const HotkeySnapshot>()};
+    int IO::publishDepth = 0;
+    std::unordered_set<int> IO::pendingPublish;
     bool IO::hotkeyEnabled = true;
-    int IO::hotkeyCount = 0;
+    std::atomic<int> IO::hotkeyCount{0};
 
     int xerrorHandler(Display *display, XErrorEvent *error) {
         char errorText[256];
@@ -31,12 +48,71 @@ HHOOK IO::keyboardHook = NULL;
         return 0; // Must return a value
     }
 
-    IO::IO() {
+    // Bumps a wake eventfd. EAGAIN means the counter is saturated, so a
+    // wakeup is already pending.
+    static void SignalWakeFd(int fd, const char *what) {
+        uint64_t one = 1;
+        while (write(fd, &one, sizeof(one)) < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN) {
+                std::cerr << what << ": eventfd write failed: " << strerror(errno)
+                        << std::endl;
+            }
+            return;
+        }
+    }
+
+    // Resets a wake eventfd. EAGAIN means another reader already drained it.
+    static void DrainWakeFd(int fd, const char *what) {
+        uint64_t value;
+        while (read(fd, &value, sizeof(value)) < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN) {
+                std::cerr << what << ": eventfd read failed: " << strerror(errno)
+                        << std::endl;
+            }
+            return;
+        }
+    }
+
+    // Typing.* settings, read once when the IO is created
+    static TextTyper::Options TypingOptionsFromConfig() {
+        auto &config = Configs::Get();
+        TextTyper::Options options;
+        options.charsPerFrame = config.Get<size_t>(
+            "Typing.CharsPerFrame", options.charsPerFrame);
+        options.framePeriod = std::chrono::microseconds(config.Get<long>(
+            "Typing.FramePeriodUs", options.framePeriod.count()));
+        options.clipboardThreshold = config.Get<size_t>(
+            "Typing.ClipboardThreshold", options.clipboardThreshold);
+        options.clipboardCommand = config.Get<std::string>(
+            "Typing.ClipboardCommand", options.clipboardCommand);
+        options.clipboardReadCommand = config.Get<std::string>(
+            "Typing.ClipboardReadCommand", options.clipboardReadCommand);
+        options.clipboardRestoreDelay = std::chrono::milliseconds(config.Get<long>(
+            "Typing.ClipboardRestoreDelayMs", options.clipboardRestoreDelay.count()));
+        return options;
+    }
+
+    IO::IO()
+        : hotkeyExecutor(HotkeyExecutor::Options{},
+                         [this](int id, std::chrono::nanoseconds sinceOrigin) {
+                             // Negative ids are SetTimer callbacks
+                             if (id > 0) latency.RecordHotkey(id, sinceOrigin);
+                         }),
+          textTyper(TypingOptionsFromConfig()),
+          motionEngine([this](int dx, int dy) {
+              UinputFrame frame;
+              if (dx) frame.Rel(REL_X, dx);
+              if (dy) frame.Rel(REL_Y, dy);
+              return frame.Flush(uinputFd);
+          }) {
         std::cout << "IO constructor called" << std::endl;
 
+        // First Xlib call: Initialize() sets Xlib up for threads
+        DisplayManager::Initialize();
         // Set the error handler before making your XGrabKey call
         XSetErrorHandler(xerrorHandler);
-        DisplayManager::Initialize();
         display = DisplayManager::GetDisplay();
         if (!display) {
             std::cerr << "Failed to get X11 display" << std::endl;
@@ -49,33 +125,80 @@ HHOOK IO::keyboardHook = NULL;
             // Set up X11 error handler
             XSetErrorHandler([](Display *, XErrorEvent *) -> int { return 0; });
 
+            // Wakes MonitorHotkeys out of poll() when the IO is destroyed
+            x11WakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+            if (x11WakeFd < 0) {
+                std::cerr << "eventfd failed: " << strerror(errno) << std::endl;
+            }
+
             // Start hotkey monitoring in a separate thread
             timerRunning = true;
             timerThread = std::thread([this]() {
                 this->MonitorHotkeys();
             });
         }
-        StartEvdevHotkeyListener("/dev/input/event7"); // your keyboard device
+        // Evdev.Devices: comma separated device paths, or "auto" for every
+        // keyboard
+        std::string evdevDevices = Configs::Get().Get<std::string>(
+            "Evdev.Devices", "/dev/input/event7");
+        std::vector<std::string> evdevPaths;
+        if (TrimCopy(evdevDevices) != "auto") {
+            std::stringstream ss(evdevDevices);
+            std::string path;
+            while (std::getline(ss, path, ',')) {
+                Trim(path);
+                if (!path.empty()) evdevPaths.push_back(path);
+            }
+        }
+        StartEvdevHotkeyListener(evdevPaths);
 #endif
     }
 
     IO::~IO() {
         std::cout << "IO destructor called" << std::endl;
+        // SetTimer callbacks post to the executor; stop them first
+        std::unordered_set<TimerService::TimerId> timers;
+        {
+            std::lock_guard<std::mutex> lock(setTimersMutex);
+            timers.swap(setTimers);
+        }
+        for (TimerService::TimerId id : timers) {
+            TimerService::Get().Cancel(id);
+        }
+        // The executor is declared before, and so outlives, everything a
+        // callback may use (the send cache, the typer, the motion engine,
+        // uinput). Stop it while those still exist: running callbacks
+        // finish, queued ones are dropped, later submissions are refused.
+        hotkeyExecutor.Shutdown();
+        motionEngine.Cancel();
+        StopEvdevHotkeyListener();
         if (timerRunning && timerThread.joinable()) {
             timerRunning = false;
+            if (x11WakeFd >= 0) {
+                SignalWakeFd(x11WakeFd, "X11");
+            }
             timerThread.join();
         }
+        if (x11WakeFd >= 0) {
+            close(x11WakeFd);
+            x11WakeFd = -1;
+        }
 
         // Ungrab all hotkeys before closing
 #ifdef __linux__
         if (display) {
             Window root = DefaultRootWindow(display);
-            for (const auto &[id, hotkey]: hotkeys) {
-                if (hotkey.key != 0) {
-                    KeyCode keycode = XKeysymToKeycode(display, hotkey.key);
-                    if (keycode != 0) {
-                        Ungrab(keycode, hotkey.modifiers, root);
-                    }
+            std::vector<std::pair<Key, int>> keys;
+            {
+                std::lock_guard<std::mutex> lock(hotkeyWriteMutex);
+                for (const auto &[id, hotkey]: hotkeys) {
+                    if (hotkey.key != 0) keys.emplace_back(hotkey.key, hotkey.modifiers);
+                }
+            }
+            for (const auto &[key, modifiers]: keys) {
+                KeyCode keycode = KeymapTable::Get(display)->Keycode(key);
+                if (keycode != 0) {
+                    Ungrab(keycode, modifiers, root);
                 }
             }
         }
@@ -91,6 +214,10 @@ HHOOK IO::keyboardHook = NULL;
         display = nullptr;
     }
 
+    // Names of the uinput devices we create, so we never capture them
+    static constexpr const char *UinputDeviceName = "wusper-uinput-kb";
+    static constexpr const char *HotkeyUinputDeviceName = "virtual-hotkey-kbd";
+
     bool IO::SetupUinputDevice() {
         uinputFd = open("/dev/uinput", O_WRONLY | O_NONBLOCK);
         if (uinputFd < 0) {
@@ -103,7 +230,7 @@ HHOOK IO::keyboardHook = NULL;
         usetup.id.bustype = BUS_USB;
         usetup.id.vendor = 0x1234;
         usetup.id.product = 0x5678;
-        strcpy(usetup.name, "wusper-uinput-kb");
+        strcpy(usetup.name, UinputDeviceName);
         // Enable key event support
         if (ioctl(uinputFd, UI_SET_EVBIT, EV_KEY) < 0) goto error;
         if (ioctl(uinputFd, UI_SET_EVBIT, EV_SYN) < 0) goto error;
@@ -113,6 +240,8 @@ HHOOK IO::keyboardHook = NULL;
         ioctl(uinputFd, UI_SET_KEYBIT, BTN_SIDE);
         ioctl(uinputFd, UI_SET_KEYBIT, BTN_EXTRA);
         ioctl(uinputFd, UI_SET_EVBIT, EV_REL);
+        ioctl(uinputFd, UI_SET_RELBIT, REL_X);
+        ioctl(uinputFd, UI_SET_RELBIT, REL_Y);
         ioctl(uinputFd, UI_SET_RELBIT, REL_WHEEL);
         ioctl(uinputFd, UI_SET_RELBIT, REL_HWHEEL);
 
@@ -151,7 +280,7 @@ HHOOK IO::keyboardHook = NULL;
         usetup.id.bustype = BUS_USB;
         usetup.id.vendor = 0x1;
         usetup.id.product = 0x1;
-        strcpy(usetup.name, "virtual-hotkey-kbd");
+        strcpy(usetup.name, HotkeyUinputDeviceName);
 
         ioctl(uinputFd, UI_DEV_SETUP, &usetup);
         ioctl(uinputFd, UI_DEV_CREATE);
@@ -163,17 +292,9 @@ HHOOK IO::keyboardHook = NULL;
     void IO::EmitToUinput(int code, bool down) {
         if (uinputFd < 0) return;
 
-        input_event ev{};
-        gettimeofday(&ev.time, NULL);
-        ev.type = EV_KEY;
-        ev.code = code;
-        ev.value = down ? 1 : 0;
-        write(uinputFd, &ev, sizeof(ev));
-
-        ev.type = EV_SYN;
-        ev.code = SYN_REPORT;
-        ev.value = 0;
-        write(uinputFd, &ev, sizeof(ev));
+        UinputFrame frame;
+        frame.Key(code, down ? 1 : 0);
+        frame.Flush(uinputFd);
     }
 
     void IO::Grab(Key input, unsigned int modifiers, Window root,
@@ -221,6 +342,13 @@ HHOOK IO::keyboardHook = NULL;
         }
 
         XSync(display, False);
+        WakeX11Monitor();
+    }
+
+    // For log lines; XKeysymToString has no name for some keysyms
+    static const char *KeysymName(KeySym keysym) {
+        const char *name = XKeysymToString(keysym);
+        return name ? name : "NoSymbol";
     }
 
     void crash() {
@@ -242,6 +370,13 @@ HHOOK IO::keyboardHook = NULL;
         }
 
         XSync(display, False);
+        WakeX11Monitor();
+    }
+
+    void IO::WakeX11Monitor() {
+        if (x11WakeFd >= 0 && std::this_thread::get_id() != timerThread.get_id()) {
+            SignalWakeFd(x11WakeFd, "X11");
+        }
     }
 
     // X11 hotkey monitoring thread
@@ -256,6 +391,19 @@ HHOOK IO::keyboardHook = NULL;
         // Select both key press and release events on the root window
         XSelectInput(display, root, KeyPressMask | KeyReleaseMask);
 
+        // MappingNotify arrives unasked; a new keyboard (layout switch
+        // tools, hotplugged devices) needs the XKB event
+        int xkbEventBase = -1;
+        int xkbOpcode, xkbError;
+        int xkbMajor = XkbMajorVersion, xkbMinor = XkbMinorVersion;
+        if (XkbQueryExtension(display, &xkbOpcode, &xkbEventBase, &xkbError,
+                              &xkbMajor, &xkbMinor)) {
+            XkbSelectEvents(display, XkbUseCoreKbd, XkbNewKeyboardNotifyMask,
+                            XkbNewKeyboardNotifyMask);
+        } else {
+            xkbEventBase = -1;
+        }
+
         // Helper function to check if a keysym is a modifier
         [[maybe_unused]] auto IsModifierKey = [](KeySym ks) -> bool {
             return ks == XK_Shift_L || ks == XK_Shift_R ||
@@ -268,10 +416,30 @@ HHOOK IO::keyboardHook = NULL;
                    ks == XK_Num_Lock || ks == XK_Scroll_Lock;
         };
 
+        pollfd fds[2] = {
+            {ConnectionNumber(display), POLLIN, 0},
+            {x11WakeFd, POLLIN, 0}
+        };
+        nfds_t nfds = x11WakeFd >= 0 ? 2 : 1;
+
         while (timerRunning) {
-            // Check for pending events
-            if (XPending(display) > 0) {
+            // Drain every event Xlib has queued or can read without blocking
+            while (timerRunning && XPending(display) > 0) {
                 XNextEvent(display, &event);
+                auto dequeued = LatencyTracker::Clock::now();
+
+                bool newKeyboard = xkbEventBase >= 0 && event.type == xkbEventBase &&
+                        reinterpret_cast<XkbAnyEvent *>(&event)->xkb_type ==
+                        XkbNewKeyboardNotify;
+                if (event.type == MappingNotify || newKeyboard) {
+                    if (event.type == MappingNotify) {
+                        if (event.xmapping.request == MappingPointer) continue;
+                        XRefreshKeyboardMapping(&event.xmapping);
+                    }
+                    KeymapTable::Invalidate();
+                    RemapHotkeys();
+                    continue;
+                }
 
                 if (event.type == KeyPress || event.type == KeyRelease) {
                     bool isKeyDown = (event.type == KeyPress);
@@ -283,9 +451,9 @@ HHOOK IO::keyboardHook = NULL;
                         continue;
                     }
 
-                    std::cout << (isKeyDown ? "KeyPress" : "KeyRelease") << " event detected: " 
-                              << XKeysymToString(keysym) << " (keycode: " << keyEvent->keycode << ")"
-                              << " with state: " << keyEvent->state << std::endl;
+                    HOT_LOG("%s event detected: %s (keycode: %u) with state: %u",
+                            isKeyDown ? "KeyPress" : "KeyRelease",
+                            KeysymName(keysym), keyEvent->keycode, keyEvent->state);
 
                     // Clean the modifier state mask
                     // Include standard modifiers + LockMask (Caps Lock)
@@ -294,39 +462,52 @@ HHOOK IO::keyboardHook = NULL;
                             ShiftMask | LockMask | ControlMask | Mod1Mask |
                             Mod4Mask | Mod5Mask;
                     unsigned int cleanedState = keyEvent->state & relevantModifiers;
-
-                    // Find and execute matching hotkeys
-                    for (const auto &[id, hotkey]: hotkeys) {
-                        if (hotkey.enabled) {
-                            bool keyMatches = (hotkey.key == keyEvent->keycode);
-                            bool modifiersMatch = (static_cast<int>(cleanedState) == hotkey.modifiers);
-                            
-                            // For key up hotkeys, only match on key release
-                            // For regular hotkeys, only match on key press (default behavior)
-                            bool eventTypeMatches = hotkey.isKeyUp ? !isKeyDown : isKeyDown;
-                            
-                            if (keyMatches && modifiersMatch && eventTypeMatches) {
-                                std::cout << "Hotkey matched: " << hotkey.alias
-                                        << " (state: " << cleanedState
-                                        << " vs expected: " << hotkey.modifiers
-                                        << ", " << (isKeyDown ? "press" : "release") << ")" << std::endl;
-                                
-                                // Execute the callback in a separate thread to avoid blocking
-                                if (hotkey.callback) {
-                                    std::thread([callback = hotkey.callback]() {
-                                        callback();
-                                    }).detach();
-                                }
-                                // Only process one matching hotkey per event
-                                break;
-                            }
+                    FlightRecorder::RecordKey(keyEvent->keycode);
+
+                    // Key up hotkeys live in the release bucket, regular
+                    // hotkeys in the press bucket; the mask must match exactly
+                    auto table = HotkeyTable();
+                    const HotkeyIndex::Entry *entry = table->index.FindExact(
+                        HotkeySource::X11, keyEvent->keycode, !isKeyDown,
+                        cleanedState);
+                    const HotKey *match = entry ? table->Find(entry->id) : nullptr;
+                    if (match) {
+                        const HotKey &hotkey = *match;
+                        FlightRecorder::Record(TraceEvent::HotkeyMatched, entry->id);
+                        HOT_LOG("Hotkey matched: %s (state: %u vs expected: %d, %s)",
+                                hotkey.alias.c_str(), cleanedState, hotkey.modifiers,
+                                isKeyDown ? "press" : "release");
+
+                        // Hand the callback to the executor to avoid blocking
+                        if (hotkey.callback) {
+                            latency.Record(LatencyTracker::Stage::X11Dispatch,
+                                           LatencyTracker::Clock::now() - dequeued);
+                            hotkeyExecutor.Submit(entry->id, hotkey.callback, true, dequeued);
                         }
                     }
                 }
             }
-
-            // Sleep to avoid high CPU usage
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            if (!timerRunning) break;
+
+            // The display is shared, so another thread's round trip can pull
+            // our events into Xlib's queue without the fd ever becoming
+            // readable. Grab and Ungrab wake us after theirs; whatever got
+            // queued since the drain above is handled before blocking.
+            if (XEventsQueued(display, QueuedAlready) > 0) continue;
+
+            // Block until the X connection is readable, another thread woke
+            // us, or we are asked to stop. The timeout is only a safety net
+            // for round trips made elsewhere on the display.
+            int ready = poll(fds, nfds, X11PollFallbackMs);
+            if (ready < 0) {
+                if (errno == EINTR) continue;
+                std::cerr << "poll on X connection failed: " << strerror(errno)
+                        << std::endl;
+                break;
+            }
+            if (nfds > 1 && (fds[1].revents & POLLIN)) {
+                DrainWakeFd(x11WakeFd, "X11");
+            }
         }
         std::cout << "Hotkey monitoring thread stopped" << std::endl;
 #endif
@@ -433,16 +614,14 @@ HHOOK IO::keyboardHook = NULL;
         keyMap["grave"] = XK_grave; // Tilde key (~)
         keyMap["apostrophe"] = XK_apostrophe;
 
-        // Letter keys (a-z)
+        // Letter keys (a-z); Latin-1 keysyms are their own characters
         for (char c = 'a'; c <= 'z'; ++c) {
-            keyMap[std::string(1, c)] = XStringToKeysym(
-                std::string(1, c).c_str());
+            keyMap[std::string(1, c)] = static_cast<Key>(c);
         }
 
         // Number keys (0-9)
         for (char c = '0'; c <= '9'; ++c) {
-            keyMap[std::string(1, c)] = XStringToKeysym(
-                std::string(1, c).c_str());
+            keyMap[std::string(1, c)] = static_cast<Key>(c);
         }
 
         // Button names (for mouse events)
@@ -494,14 +673,10 @@ HHOOK IO::keyboardHook = NULL;
 
     // Static method to handle key strings
     Key IO::handleKeyString(const std::string &key) {
-        lo.debug("Handling key string: " + key);
-
         // Handle keycodes (kcXXX)
-        if (key.size() > 2 && key.substr(0, 2) == "kc") {
+        if (key.size() > 2 && key.compare(0, 2, "kc") == 0) {
             try {
-                int keycode = std::stoi(key.substr(2));
-                lo.debug("Detected direct keycode: " + std::to_string(keycode));
-                return keycode;
+                return std::stoi(key.substr(2));
             } catch (const std::exception &e) {
                 lo.error(
                     "Failed to parse keycode from '" + key + "': " + e.what());
@@ -511,21 +686,24 @@ HHOOK IO::keyboardHook = NULL;
 
         // Special handling for NoSymbol
         if (key == "NoSymbol") {
-            lo.debug("Explicitly handling NoSymbol as keysym 0x0");
             return 0x0; // Use keysym 0x0 for NoSymbol as requested
         }
 
+        Display *display = DisplayManager::GetDisplay();
+        if (!display) {
+            lo.error("No X display available for key conversion");
+            return -1;
+        }
+        auto keysyms = KeymapTable::Get(display);
+
         // Handle the "Menu" key explicitly
         if (key == "Menu" || key == "menu") {
-            lo.debug("Explicitly handling Menu key via keysym");
-            KeySym keysym = XK_Menu;
-            int keycode =
-                    XKeysymToKeycode(DisplayManager::GetDisplay(), keysym);
+            int keycode = keysyms->Keycode(XK_Menu);
             return keycode > 0 ? keycode : -1;
         }
 
         // The rest of the implementation handles normal keys
-        KeySym keysym = XStringToKeysym(key.c_str());
+        KeySym keysym = keysyms->FromName(key);
         if (keysym == NoSymbol) {
             lo.warning(
                 "Key '" + key +
@@ -533,17 +711,7 @@ HHOOK IO::keyboardHook = NULL;
             return -1;
         }
 
-        Display *display = DisplayManager::GetDisplay();
-        if (!display) {
-            lo.error("No X display available for key conversion");
-            return -1;
-        }
-
-        int keycode = XKeysymToKeycode(display, keysym);
-        lo.debug(
-            "Converted key '" + key + "' to keycode " + std::to_string(keycode)
-            + " (keysym: " + std::to_string(keysym) + ")");
-
+        int keycode = keysyms->Keycode(keysym);
         if (keycode == 0) {
             lo.warning(
                 "KeySym for '" + key + "' could not be converted to keycode");
@@ -563,140 +731,77 @@ HHOOK IO::keyboardHook = NULL;
             return true;
         }
 
-        input_event ev = {};
+        UinputFrame frame;
 
         if (action == 2) {
-            // Press
-            ev.type = EV_KEY;
-            ev.code = btnCode;
-            ev.value = 1;
-            if (write(uinputFd, &ev, sizeof(ev)) < 0) return false;
-            // Sync
-            ev.type = EV_SYN;
-            ev.code = SYN_REPORT;
-            ev.value = 0;
-            if (write(uinputFd, &ev, sizeof(ev)) < 0) return false;
-
-            // Release
-            ev.type = EV_KEY;
-            ev.code = btnCode;
-            ev.value = 0;
-            if (write(uinputFd, &ev, sizeof(ev)) < 0) return false;
-            // Sync
-            ev.type = EV_SYN;
-            ev.code = SYN_REPORT;
-            ev.value = 0;
-            if (write(uinputFd, &ev, sizeof(ev)) < 0) return false;
+            // Press and release as two reports in a single write
+            frame.Key(btnCode, 1);
+            frame.Sync();
+            frame.Key(btnCode, 0);
         } else if (action == 1 || action == 0) {
-            ev.type = EV_KEY;
-            ev.code = btnCode;
-            ev.value = action;
-            if (write(uinputFd, &ev, sizeof(ev)) < 0) return false;
-            // Sync
-            ev.type = EV_SYN;
-            ev.code = SYN_REPORT;
-            ev.value = 0;
-            if (write(uinputFd, &ev, sizeof(ev)) < 0) return false;
+            frame.Key(btnCode, action);
         } else {
             std::cerr << "Invalid mouse action: " << action << "\n";
             return false;
         }
 
-        return true;
+        return frame.Flush(uinputFd);
     }
 
     bool IO::MouseMove(int dx, int dy, int speed = 1, float accel = 1.0f) {
         if (speed <= 0) speed = 1;
         if (accel <= 0.0f) accel = 1.0f;
 
+        // Same pace as ever: `speed` pixels per `accel` milliseconds
         int steps = std::max(abs(dx), abs(dy)) / speed;
         steps = std::max(steps, 1);
 
-        float stepx = dx / static_cast<float>(steps);
-        float stepy = dy / static_cast<float>(steps);
-
-        for (int i = 0; i < steps; ++i) {
-            input_event ev = {};
-            ev.type = EV_REL;
-
-            ev.code = REL_X;
-            ev.value = static_cast<int>(roundf(stepx));
-            if (write(uinputFd, &ev, sizeof(ev)) < 0) return false;
-
-            ev.code = REL_Y;
-            ev.value = static_cast<int>(roundf(stepy));
-            if (write(uinputFd, &ev, sizeof(ev)) < 0) return false;
-
-            ev.type = EV_SYN;
-            ev.code = SYN_REPORT;
-            ev.value = 0;
-            if (write(uinputFd, &ev, sizeof(ev)) < 0) return false;
+        MotionEngine::Motion motion;
+        motion.dx = dx;
+        motion.dy = dy;
+        motion.duration = std::chrono::milliseconds(std::lround(steps * accel));
+        motion.easing = MotionEngine::Easing::Linear;
+        return motionEngine.Start(motion).get();
+    }
 
-            std::this_thread::sleep_for(
-                std::chrono::microseconds(static_cast<int>(1000 * accel)));
-        }
+    std::future<bool> IO::MouseMoveAsync(const MotionEngine::Motion &motion) {
+        return motionEngine.Start(motion);
+    }
 
-        return true;
+    void IO::CancelMouseMove() {
+        motionEngine.Cancel();
     }
 
     bool IO::MouseClick(int btnCode, int dx, int dy, int speed,
                         float accel) {
         if (!MouseMove(dx, dy, speed, accel)) return false;
 
-        input_event ev = {};
+        UinputFrame frame;
 
         // Press
-        ev.type = EV_KEY;
-        ev.code = btnCode;
-        ev.value = 1;
-        if (write(uinputFd, &ev, sizeof(ev)) < 0) return false;
-
-        ev.type = EV_SYN;
-        ev.code = SYN_REPORT;
-        ev.value = 0;
-        if (write(uinputFd, &ev, sizeof(ev)) < 0) return false;
+        frame.Key(btnCode, 1);
+        if (!frame.Flush(uinputFd)) return false;
 
         std::this_thread::sleep_for(std::chrono::milliseconds(20));
         // simulate click hold
 
         // Release
-        ev.type = EV_KEY;
-        ev.code = btnCode;
-        ev.value = 0;
-        if (write(uinputFd, &ev, sizeof(ev)) < 0) return false;
-
-        ev.type = EV_SYN;
-        ev.code = SYN_REPORT;
-        ev.value = 0;
-        if (write(uinputFd, &ev, sizeof(ev)) < 0) return false;
-
-        return true;
+        frame.Key(btnCode, 0);
+        return frame.Flush(uinputFd);
     }
 
     bool IO::Scroll(int dy, int dx) {
         if (uinputFd < 0) return false;
 
-        input_event ev = {};
-
-        auto emit = [&](uint16_t code, int value) -> bool {
-            ev.type = EV_REL;
-            ev.code = code;
-            ev.value = value;
-            if (write(uinputFd, &ev, sizeof(ev)) < 0) return false;
-            return true;
-        };
+        UinputFrame frame;
 
         // Emit relative scrolls
-        if (dy != 0 && !emit(REL_WHEEL, dy)) return false;
-        if (dx != 0 && !emit(REL_HWHEEL, dx)) return false;
+        if (dy != 0) frame.Rel(REL_WHEEL, dy);
+        if (dx != 0) frame.Rel(REL_HWHEEL, dx);
 
         // Sync event
-        ev.type = EV_SYN;
-        ev.code = SYN_REPORT;
-        ev.value = 0;
-        if (write(uinputFd, &ev, sizeof(ev)) < 0) return false;
-
-        return true;
+        frame.Sync();
+        return frame.Flush(uinputFd);
     }
 
     void IO::SendX11Key(const std::string &keyName, bool press) {
@@ -712,7 +817,7 @@ HHOOK IO::keyboardHook = NULL;
             return;
         }
 
-        KeyCode keycode = XKeysymToKeycode(display, keysym);
+        KeyCode keycode = KeymapTable::Get(display)->Keycode(keysym);
         if (keycode == 0) {
             std::cerr << "Cannot find keycode for " << keyName << std::endl;
             return;
@@ -729,18 +834,9 @@ HHOOK IO::keyboardHook = NULL;
         lo.info(
             "Sending UInput key: " + std::to_string(keycode) + " (" +
             std::to_string(down) + ")");
-        struct input_event ev{};
-        ev.type = EV_KEY;
-        ev.code = keycode;
-        ev.value = down ? 1 : 0;
-        ev.time.tv_sec = 0;
-        ev.time.tv_usec = 0;
-        write(uinputFd, &ev, sizeof(ev));
-
-        ev.type = EV_SYN;
-        ev.code = SYN_REPORT;
-        ev.value = 0;
-        write(uinputFd, &ev, sizeof(ev));
+        UinputFrame frame;
+        frame.Key(keycode, down ? 1 : 0);
+        frame.Flush(uinputFd);
     }
 
     // Method to send keys
@@ -812,8 +908,31 @@ HHOOK IO::keyboardHook = NULL;
     if (modifiers & MOD_SHIFT)
         keybd_event(VK_SHIFT, 0, KEYEVENTF_KEYUP, 0);
 #else
+        // Linux (X11 / uinput). Text expansion resends the same strings
+        // over and over, so each one is parsed once and replayed after.
+        std::shared_ptr<const SendProgram> program;
+        {
+            std::lock_guard<std::mutex> lock(sendCacheMutex);
+            if (auto *cached = sendCache.Find(keys)) program = *cached;
+        }
+        if (!program) {
+            program = std::make_shared<const SendProgram>(CompileSend(keys));
+            std::lock_guard<std::mutex> lock(sendCacheMutex);
+            sendCache.Put(keys, program);
+        }
+        RunSendProgram(*program);
+#endif
+    }
 
-        // Linux (X11 / uinput)
+    bool IO::Type(const std::string &text) {
+        return textTyper.Type(display, uinputFd, text);
+    }
+
+    // Turn a Send() string into the key events it produces. Modifier
+    // prefixes (^!+#), {Key}, {Key down}/{Key up} and @ (toggle between
+    // uinput and X11) are resolved here, so replaying is just the events.
+    SendProgram IO::CompileSend(const std::string &keys) {
+        SendProgram program;
         bool useUinput = true;
         std::vector<std::string> activeModifiers;
         std::unordered_map<std::string, std::string> modifierKeys = {
@@ -830,11 +949,16 @@ HHOOK IO::keyboardHook = NULL;
 
         auto SendKeyImpl = [&](const std::string &keyName, bool down) {
             if (useUinput) {
-                int code = EvdevNameToKeyCode(keyName);
                 // must return evdev keycode
-                if (code != -1) SendUInput(code, down);
+                Key code = EvdevNameToKeyCode(keyName);
+                if (code != 0) program.push_back({code, down, false});
             } else {
-                SendX11Key(keyName, down);
+                Key keysym = StringToVirtualKey(keyName);
+                if (keysym != NoSymbol) {
+                    program.push_back({keysym, down, true});
+                } else {
+                    std::cerr << "Invalid key: " << keyName << std::endl;
+                }
             }
         };
 
@@ -923,15 +1047,51 @@ HHOOK IO::keyboardHook = NULL;
             }
         }
         activeModifiers.clear();
-#endif
+        return program;
+    }
+
+    void IO::RunSendProgram(const SendProgram &program) {
+        // uinput events go out in as few writes as possible and X11 events
+        // with a single flush; switching backends flushes the other one
+        // first so the order is kept
+        UinputFrame frame;
+        bool x11Pending = false;
+        std::shared_ptr<const KeymapTable> keysyms;
+
+        for (const auto &op: program) {
+            if (op.x11) {
+                if (!frame.Empty()) frame.Flush(uinputFd);
+                if (!display) continue;
+                if (!keysyms) keysyms = KeymapTable::Get(display);
+                KeyCode keycode = keysyms->Keycode(op.code);
+                if (keycode == 0) continue;
+                XTestFakeKeyEvent(display, keycode, op.down, CurrentTime);
+                x11Pending = true;
+            } else {
+                if (x11Pending) {
+                    XFlush(display);
+                    x11Pending = false;
+                }
+                if (uinputFd < 0) continue;
+                // Each event is its own report, as with SendUInput
+                if (frame.Size() + 2 > UinputFrame::Capacity) frame.Flush(uinputFd);
+                frame.Key(static_cast<int>(op.code), op.down ? 1 : 0);
+                frame.Sync();
+            }
+        }
+
+        frame.Flush(uinputFd);
+        if (x11Pending) XFlush(display);
     }
 
     // Method to suspend hotkeys
     bool IO::Suspend(int id) {
         std::cout << "Suspending hotkey ID: " << id << std::endl;
+        std::lock_guard<std::mutex> lock(hotkeyWriteMutex);
         auto it = hotkeys.find(id);
         if (it != hotkeys.end()) {
             it->second.enabled = false;
+            PublishHotkeys({id});
             return true;
         }
         return false;
@@ -940,14 +1100,118 @@ HHOOK IO::keyboardHook = NULL;
     // Method to resume hotkeys
     bool IO::Resume(int id) {
         std::cout << "Resuming hotkey ID: " << id << std::endl;
+        std::lock_guard<std::mutex> lock(hotkeyWriteMutex);
         auto it = hotkeys.find(id);
         if (it != hotkeys.end()) {
             it->second.enabled = true;
+            PublishHotkeys({id});
             return true;
         }
         return false;
     }
 
+    bool IO::RemoveHotkey(int id) {
+        std::string alias;
+        Key key = 0;
+        int modifiers = 0;
+        bool grabbed = false;
+        {
+            std::lock_guard<std::mutex> lock(hotkeyWriteMutex);
+            auto it = hotkeys.find(id);
+            if (it == hotkeys.end()) {
+                return false;
+            }
+            alias = it->second.alias;
+            key = it->second.key;
+            modifiers = it->second.modifiers;
+            grabbed = it->second.grabbed;
+            hotkeys.erase(it);
+            PublishHotkeys({id});
+        }
+#ifdef __linux__
+        if (display && grabbed) {
+            Ungrab(key, modifiers, DefaultRootWindow(display));
+        }
+#endif
+        hotkeyExecutor.Forget(id);
+        latency.ForgetHotkey(id);
+        lo.info("Removed hotkey: " + alias);
+        return true;
+    }
+
+    std::string IO::LatencyReport() const {
+        auto table = HotkeyTable();
+        return latency.Report([&table](int id) {
+            const HotKey *hotkey = table->Find(id);
+            return hotkey ? hotkey->alias : std::string();
+        });
+    }
+
+    void IO::PublishHotkeys(std::initializer_list<int> ids) {
+        pendingPublish.insert(ids.begin(), ids.end());
+        if (publishDepth == 0) {
+            FlushPublish();
+        }
+    }
+
+    IO::HotkeyBatch::HotkeyBatch() {
+        std::lock_guard<std::mutex> lock(hotkeyWriteMutex);
+        ++publishDepth;
+    }
+
+    IO::HotkeyBatch::~HotkeyBatch() {
+        std::lock_guard<std::mutex> lock(hotkeyWriteMutex);
+        if (--publishDepth == 0) {
+            FlushPublish();
+        }
+    }
+
+    void IO::RemapHotkeys() {
+#ifdef __linux__
+        if (!display) return;
+        auto keymap = KeymapTable::Get(display);
+        Window root = DefaultRootWindow(display);
+
+        HotkeyBatch batch;
+        std::lock_guard<std::mutex> lock(hotkeyWriteMutex);
+        for (auto &[id, hotkey] : hotkeys) {
+            if (hotkey.evdev || hotkey.keysym == 0) continue;
+            KeyCode keycode = keymap->Keycode(hotkey.keysym);
+            if (keycode == 0 || keycode == hotkey.key) continue;
+
+            if (hotkey.grabbed) {
+                Ungrab(hotkey.key, hotkey.modifiers, root);
+                Grab(keycode, hotkey.modifiers, root, hotkey.exclusive);
+            }
+            lo.info("Hotkey " + hotkey.alias + " moved from keycode " +
+                    std::to_string(hotkey.key) + " to " + std::to_string(keycode));
+            hotkey.key = keycode;
+            PublishHotkeys({id});
+        }
+#endif
+    }
+
+    // One copy of the snapshot for everything changed since the last one
+    void IO::FlushPublish() {
+        if (pendingPublish.empty()) {
+            return;
+        }
+        auto next = std::make_shared<HotkeySnapshot>(*HotkeyTable());
+        for (int id : pendingPublish) {
+            auto it = hotkeys.find(id);
+            if (it == hotkeys.end()) {
+                next->index.Remove(id);
+                next->bindings.erase(id);
+                continue;
+            }
+            auto binding = std::make_shared<const HotKey>(it->second);
+            next->index.Update(id, *binding);
+            next->bindings[id] = std::move(binding);
+        }
+        pendingPublish.clear();
+        hotkeySnapshot.store(std::move(next), std::memory_order_release);
+    }
+
     HotKey IO::AddHotkey(const std::string &rawInput,
                          std::function<void()> action, int id) const {
         if (id == 0) id = ++hotkeyCount;
@@ -982,6 +1246,7 @@ HHOOK IO::keyboardHook = NULL;
         hotkeyStr = hotkeyStr.substr(i); // Strip modifiers
 
         KeyCode keycode = 0;
+        Key keysym = 0;
         bool isEvdev = false;
 
         if (!hotkeyStr.empty() && hotkeyStr[0] == '@') {
@@ -1000,8 +1265,8 @@ HHOOK IO::keyboardHook = NULL;
             std::string keyLower = hotkeyStr;
             std::transform(keyLower.begin(), keyLower.end(), keyLower.begin(),
                            ::tolower);
-            Key keysym = StringToVirtualKey(keyLower);
-            keycode = keysym < 10 ? keysym : XKeysymToKeycode(display, keysym);
+            keysym = StringToVirtualKey(keyLower);
+            keycode = keysym < 10 ? keysym : KeymapTable::Get(display)->Keycode(keysym);
             if (keycode <= 0) {
                 std::cerr << "Failed to convert keysym to keycode: " << keyLower
                         << std::endl;
@@ -1022,18 +1287,28 @@ HHOOK IO::keyboardHook = NULL;
         hk.success = (display && keycode > 0);
         hk.evdev = isEvdev;
         hk.isKeyUp = isKeyUp;
+        // Below 10 the "keysym" is a raw keycode already
+        hk.keysym = keysym >= 10 ? keysym : 0;
 
+        std::lock_guard<std::mutex> lock(hotkeyWriteMutex);
         hotkeys[id] = hk;
+        PublishHotkeys({id});
         return hotkeys[id];
     }
 
     bool IO::Hotkey(const std::string &rawInput, std::function<void()> action,
                     int id) {
+        if (id == 0) id = ++hotkeyCount;
         HotKey result = AddHotkey(rawInput, action, id);
         if (result.success) {
             std::cout << "Grabbing hotkey: " << rawInput << std::endl;
             Grab(result.key, result.modifiers, DefaultRootWindow(display),
                  result.exclusive);
+            {
+                std::lock_guard<std::mutex> lock(hotkeyWriteMutex);
+                auto it = hotkeys.find(id);
+                if (it != hotkeys.end()) it->second.grabbed = !result.evdev;
+            }
             std::cout << "Registered hotkey: " << rawInput << (result.suspend
                 ? " (suspend key)"
                 : "") << "\n";
@@ -1097,6 +1372,98 @@ HHOOK IO::keyboardHook = NULL;
         return 0; // Invalid / unrecognized
     }
 
+#ifndef WINDOWS
+    // Key names StringToVirtualKey accepts, sorted for binary search
+    static constexpr std::pair<std::string_view, KeySym> X11KeyNames[] = {
+        {"alt", XK_Alt_L},
+        {"backspace", XK_BackSpace},
+        {"capslock", XK_Caps_Lock},
+        {"ctrl", XK_Control_L},
+        {"delete", XK_Delete},
+        {"down", XK_Down},
+        {"end", XK_End},
+        {"enter", XK_Return},
+        {"equal", XK_equal},
+        {"equals", XK_equal},
+        {"esc", XK_Escape},
+        {"f1", XK_F1},
+        {"f10", XK_F10},
+        {"f11", XK_F11},
+        {"f12", XK_F12},
+        {"f13", XK_F13},
+        {"f14", XK_F14},
+        {"f15", XK_F15},
+        {"f16", XK_F16},
+        {"f17", XK_F17},
+        {"f18", XK_F18},
+        {"f19", XK_F19},
+        {"f2", XK_F2},
+        {"f20", XK_F20},
+        {"f21", XK_F21},
+        {"f22", XK_F22},
+        {"f23", XK_F23},
+        {"f24", XK_F24},
+        {"f3", XK_F3},
+        {"f4", XK_F4},
+        {"f5", XK_F5},
+        {"f6", XK_F6},
+        {"f7", XK_F7},
+        {"f8", XK_F8},
+        {"f9", XK_F9},
+        {"home", XK_Home},
+        {"insert", XK_Insert},
+        {"lalt", XK_Alt_L},
+        {"lctrl", XK_Control_L},
+        {"left", XK_Left},
+        {"lshift", XK_Shift_L},
+        {"lwin", XK_Super_L},
+        {"medianext", XF86XK_AudioNext},
+        {"mediaplay", XF86XK_AudioPlay},
+        {"mediaprev", XF86XK_AudioPrev},
+        {"menu", XK_Menu},
+        {"minus", XK_minus},
+        {"numlock", XK_Num_Lock},
+        {"numpad0", XK_KP_0},
+        {"numpad1", XK_KP_1},
+        {"numpad2", XK_KP_2},
+        {"numpad3", XK_KP_3},
+        {"numpad4", XK_KP_4},
+        {"numpad5", XK_KP_5},
+        {"numpad6", XK_KP_6},
+        {"numpad7", XK_KP_7},
+        {"numpad8", XK_KP_8},
+        {"numpad9", XK_KP_9},
+        {"numpadadd", XK_KP_Add},
+        {"numpaddec", XK_KP_Decimal},
+        {"numpaddiv", XK_KP_Divide},
+        {"numpadenter", XK_KP_Enter},
+        {"numpadmul", XK_KP_Multiply},
+        {"numpadsub", XK_KP_Subtract},
+        {"pause", XK_Pause},
+        {"pgdn", XK_Page_Down},
+        {"pgup", XK_Page_Up},
+        {"printscreen", XK_Print},
+        {"ralt", XK_Alt_R},
+        {"rctrl", XK_Control_R},
+        {"right", XK_Right},
+        {"rshift", XK_Shift_R},
+        {"rwin", XK_Super_R},
+        {"scrolllock", XK_Scroll_Lock},
+        {"shift", XK_Shift_L},
+        {"space", XK_space},
+        {"tab", XK_Tab},
+        {"up", XK_Up},
+        {"volumedown", XF86XK_AudioLowerVolume},
+        {"volumemute", XF86XK_AudioMute},
+        {"volumeup", XF86XK_AudioRaiseVolume},
+        {"win", XK_Super_L},
+    };
+    static_assert(std::is_sorted(std::begin(X11KeyNames), std::end(X11KeyNames),
+                                 [](const auto &a, const auto &b) { return a.first < b.first; }),
+                  "X11KeyNames must stay sorted by name for the binary search");
+
+#endif
+
     // Helper function to convert string to virtual key code
     Key IO::StringToVirtualKey(str keyName) {
         removeSpecialCharacters(keyName);
@@ -1266,171 +1633,16 @@ HHOOK IO::keyboardHook = NULL;
     return 0; // Default case for unrecognized keys
 #else
         if (keyName.length() == 1) {
-            return XStringToKeysym(keyName.c_str());
+            return KeymapTable::Get(DisplayManager::GetDisplay())->FromName(keyName);
         }
         keyName = ToLower(keyName);
-        if (keyName == "minus")
-            return XK_minus;
-        if (keyName == "equals" || keyName == "equal")
-            return XK_equal;
-        if (keyName == "esc")
-            return XK_Escape;
-        if (keyName == "enter")
-            return XK_Return;
-        if (keyName == "space")
-            return XK_space;
-        if (keyName == "tab")
-            return XK_Tab;
-        if (keyName == "ctrl")
-            return XK_Control_L;
-        if (keyName == "lctrl")
-            return XK_Control_L;
-        if (keyName == "rctrl")
-            return XK_Control_R;
-        if (keyName == "shift")
-            return XK_Shift_L;
-        if (keyName == "lshift")
-            return XK_Shift_L;
-        if (keyName == "rshift")
-            return XK_Shift_R;
-        if (keyName == "alt")
-            return XK_Alt_L;
-        if (keyName == "lalt")
-            return XK_Alt_L;
-        if (keyName == "ralt")
-            return XK_Alt_R;
-        if (keyName == "win")
-            return XK_Super_L;
-        if (keyName == "lwin")
-            return XK_Super_L;
-        if (keyName == "rwin")
-            return XK_Super_R;
-        if (keyName == "backspace")
-            return XK_BackSpace;
-        if (keyName == "delete")
-            return XK_Delete;
-        if (keyName == "insert")
-            return XK_Insert;
-        if (keyName == "home")
-            return XK_Home;
-        if (keyName == "end")
-            return XK_End;
-        if (keyName == "pgup")
-            return XK_Page_Up;
-        if (keyName == "pgdn")
-            return XK_Page_Down;
-        if (keyName == "left")
-            return XK_Left;
-        if (keyName == "right")
-            return XK_Right;
-        if (keyName == "up")
-            return XK_Up;
-        if (keyName == "down")
-            return XK_Down;
-        if (keyName == "capslock")
-            return XK_Caps_Lock;
-        if (keyName == "numlock")
-            return XK_Num_Lock;
-        if (keyName == "scrolllock")
-            return XK_Scroll_Lock;
-        if (keyName == "pause")
-            return XK_Pause;
-        if (keyName == "f1")
-            return XK_F1;
-        if (keyName == "f2")
-            return XK_F2;
-        if (keyName == "f3")
-            return XK_F3;
-        if (keyName == "f4")
-            return XK_F4;
-        if (keyName == "f5")
-            return XK_F5;
-        if (keyName == "f6")
-            return XK_F6;
-        if (keyName == "f7")
-            return XK_F7;
-        if (keyName == "f8")
-            return XK_F8;
-        if (keyName == "f9")
-            return XK_F9;
-        if (keyName == "f10")
-            return XK_F10;
-        if (keyName == "f11")
-            return XK_F11;
-        if (keyName == "f12")
-            return XK_F12;
-        if (keyName == "f13")
-            return XK_F13;
-        if (keyName == "f14")
-            return XK_F14;
-        if (keyName == "f15")
-            return XK_F15;
-        if (keyName == "f16")
-            return XK_F16;
-        if (keyName == "f17")
-            return XK_F17;
-        if (keyName == "f18")
-            return XK_F18;
-        if (keyName == "f19")
-            return XK_F19;
-        if (keyName == "f20")
-            return XK_F20;
-        if (keyName == "f21")
-            return XK_F21;
-        if (keyName == "f22")
-            return XK_F22;
-        if (keyName == "f23")
-            return XK_F23;
-        if (keyName == "f24")
-            return XK_F24;
-        if (keyName == "numpad0")
-            return XK_KP_0;
-        if (keyName == "numpad1")
-            return XK_KP_1;
-        if (keyName == "numpad2")
-            return XK_KP_2;
-        if (keyName == "numpad3")
-            return XK_KP_3;
-        if (keyName == "numpad4")
-            return XK_KP_4;
-        if (keyName == "numpad5")
-            return XK_KP_5;
-        if (keyName == "numpad6")
-            return XK_KP_6;
-        if (keyName == "numpad7")
-            return XK_KP_7;
-        if (keyName == "numpad8")
-            return XK_KP_8;
-        if (keyName == "numpad9")
-            return XK_KP_9;
-        if (keyName == "numpadadd")
-            return XK_KP_Add;
-        if (keyName == "numpadsub")
-            return XK_KP_Subtract;
-        if (keyName == "numpadmul")
-            return XK_KP_Multiply;
-        if (keyName == "numpaddiv")
-            return XK_KP_Divide;
-        if (keyName == "numpaddec")
-            return XK_KP_Decimal;
-        if (keyName == "numpadenter")
-            return XK_KP_Enter;
-        if (keyName == "menu")
-            return XK_Menu;
-        if (keyName == "printscreen")
-            return XK_Print;
-        if (keyName == "volumeup")
-            return XF86XK_AudioRaiseVolume; // Requires <X11/XF86keysym.h>
-        if (keyName == "volumedown")
-            return XF86XK_AudioLowerVolume; // Requires <X11/XF86keysym.h>
-        if (keyName == "volumemute")
-            return XF86XK_AudioMute; // Requires <X11/XF86keysym.h>
-        if (keyName == "medianext")
-            return XF86XK_AudioNext;
-        if (keyName == "mediaprev")
-            return XF86XK_AudioPrev;
-        if (keyName == "mediaplay")
-            return XF86XK_AudioPlay;
+        auto it = std::lower_bound(std::begin(X11KeyNames), std::end(X11KeyNames),
+                                   keyName, [](const auto &entry, const std::string &name) {
+                                       return entry.first < name;
+                                   });
+        if (it != std::end(X11KeyNames) && it->first == keyName) {
+            return it->second;
+        }
 
         return IO::StringToButton(keyName); // Default for unsupported keys}
 #endif
@@ -1512,22 +1724,58 @@ HHOOK IO::keyboardHook = NULL;
 
         std::cout << "Setting timer for " << milliseconds << " ms" << std::endl;
 
-        std::thread([=]() {
-            if (milliseconds < 0) {
-                // One-time timer after delay
-                std::this_thread::sleep_for(
-                    std::chrono::milliseconds(-milliseconds));
-                if (*running) func();
-            } else {
-                // Repeating timer
-                while (*running) {
-                    std::this_thread::sleep_for(
-                        std::chrono::milliseconds(milliseconds));
-                    if (!*running) break;
-                    func();
-                }
+        // The timer thread is shared with the autoclicker and the other
+        // automation loops and must never block, so ticks only hand `func`
+        // to the executor. Each timer gets an executor id of its own: its
+        // runs never overlap, and ticks that arrive while one is running
+        // fold into a single waiting run.
+        int job = nextTimerJob.fetch_sub(1);
+        auto retire = [this, job](TimerService::TimerId id) {
+            {
+                std::lock_guard<std::mutex> lock(setTimersMutex);
+                setTimers.erase(id);
             }
-        }).detach();
+            hotkeyExecutor.Forget(job);
+        };
+
+        auto &timers = TimerService::Get();
+        // Held until the id is recorded, so a tick can't retire it first
+        std::lock_guard<std::mutex> lock(setTimersMutex);
+        TimerService::TimerId id;
+        if (milliseconds < 0) {
+            // One-time timer after delay
+            id = timers.After(std::chrono::milliseconds(-milliseconds), [=, this]() {
+                TimerService::TimerId self = TimerService::Get().Current();
+                bool queued = *running && hotkeyExecutor.Submit(job, [=]() {
+                    if (*running) func();
+                    *running = false;
+                    retire(self);
+                });
+                if (!queued) {
+                    *running = false;
+                    retire(self);
+                }
+            });
+        } else {
+            // Repeating timer; clearing the flag retires it at the next tick
+            id = timers.Every(std::chrono::milliseconds(milliseconds), [=, this]() {
+                if (!*running) {
+                    auto &service = TimerService::Get();
+                    TimerService::TimerId self = service.Current();
+                    service.Cancel(self);
+                    retire(self);
+                    return;
+                }
+                hotkeyExecutor.Submit(job, [=]() {
+                    if (*running) func();
+                });
+            });
+        }
+        if (id != 0) {
+            setTimers.insert(id);
+        } else {
+            *running = false;
+        }
 
         return running;
     }
@@ -1546,7 +1794,11 @@ HHOOK IO::keyboardHook = NULL;
         }
 
         // Register the hotkey
-        hotkeys[id] = hotkey;
+        {
+            std::lock_guard<std::mutex> lock(hotkeyWriteMutex);
+            hotkeys[id] = hotkey;
+            PublishHotkeys({id});
+        }
 
         // Platform-specific registration
 #ifdef __linux__
@@ -1555,7 +1807,7 @@ HHOOK IO::keyboardHook = NULL;
 
         Window root = DefaultRootWindow(display);
 
-        KeyCode keycode = XKeysymToKeycode(display, hotkey.key);
+        KeyCode keycode = KeymapTable::Get(display)->Keycode(hotkey.key);
         if (keycode == 0) {
             std::cerr << "Invalid key code for hotkey: " << hotkey.alias <<
                     std::endl;
@@ -1706,14 +1958,15 @@ LRESULT CALLBACK IO::KeyboardProc(int nCode, WPARAM wParam, LPARAM lParam)
         }
 
         // Convert string to keysym
-        KeySym keysym = XStringToKeysym(keyName.c_str());
+        auto keysyms = KeymapTable::Get(display);
+        KeySym keysym = keysyms->FromName(keyName);
         if (keysym == NoSymbol) {
             std::cerr << "Unknown keysym for: " << keyName << "\n";
             return;
         }
 
         // Convert keysym to keycode
-        KeyCode keycode = XKeysymToKeycode(display, keysym);
+        KeyCode keycode = keysyms->Keycode(keysym);
         if (keycode == 0) {
             std::cerr << "Invalid keycode for keysym: " << keyName << "\n";
             return;
@@ -1735,8 +1988,10 @@ LRESULT CALLBACK IO::KeyboardProc(int nCode, WPARAM wParam, LPARAM lParam)
         hotkey.modifiers = modifiers;
         hotkey.callback = callback;
 
-        hotkeyCount++;
-        hotkeys[hotkeyCount] = hotkey;
+        int id = ++hotkeyCount;
+        std::lock_guard<std::mutex> lock(hotkeyWriteMutex);
+        hotkeys[id] = hotkey;
+        PublishHotkeys({id});
         return true;
     }
 
@@ -1745,28 +2000,49 @@ LRESULT CALLBACK IO::KeyboardProc(int nCode, WPARAM wParam, LPARAM lParam)
 #ifdef __linux__
         if (!display) return false;
 
-        auto it = hotkeys.find(hotkeyId);
-        if (it == hotkeys.end()) {
-            std::cerr << "Hotkey ID not found: " << hotkeyId << std::endl;
-            return false;
+        // Copied out so the X calls run without the lock
+        std::string alias;
+        KeyCode keycode = 0;
+        int modifiers = 0;
+        bool exclusive = false;
+        bool evdev = false;
+        {
+            std::lock_guard<std::mutex> lock(hotkeyWriteMutex);
+            auto it = hotkeys.find(hotkeyId);
+            if (it == hotkeys.end()) {
+                std::cerr << "Hotkey ID not found: " << hotkeyId << std::endl;
+                return false;
+            }
+            alias = it->second.alias;
+            keycode = it->second.key;
+            modifiers = it->second.modifiers;
+            exclusive = it->second.exclusive;
+            evdev = it->second.evdev;
         }
-
-        const HotKey &hotkey = it->second;
         Window root = DefaultRootWindow(display);
-        KeyCode keycode = hotkey.key;
 
         if (keycode == 0) {
-            std::cerr << "Invalid keycode for hotkey: " << hotkey.alias <<
+            std::cerr << "Invalid keycode for hotkey: " << alias <<
                     std::endl;
             return false;
         }
 
         // Use our improved method to grab with all modifier variants
-        if (!hotkey.evdev) {
-            Grab(keycode, hotkey.modifiers, root, hotkey.exclusive);
+        if (!evdev) {
+            Grab(keycode, modifiers, root, exclusive);
+        }
+        {
+            // Callers may have edited IO::hotkeys directly; resync. The
+            // hotkey may have been removed while we were grabbing.
+            std::lock_guard<std::mutex> lock(hotkeyWriteMutex);
+            auto it = hotkeys.find(hotkeyId);
+            if (it != hotkeys.end()) {
+                it->second.grabbed = !evdev;
+                PublishHotkeys({hotkeyId});
+            }
         }
 
-        std::cout << "Successfully grabbed hotkey: " << hotkey.alias <<
+        std::cout << "Successfully grabbed hotkey: " << alias <<
                 std::endl;
         return true;
 #else
@@ -1778,28 +2054,42 @@ LRESULT CALLBACK IO::KeyboardProc(int nCode, WPARAM wParam, LPARAM lParam)
 #ifdef __linux__
         if (!display) return false;
 
-        auto it = hotkeys.find(hotkeyId);
-        if (it == hotkeys.end()) {
-            std::cerr << "Hotkey ID not found: " << hotkeyId << std::endl;
-            return false;
+        std::string alias;
+        KeyCode keycode = 0;
+        int modifiers = 0;
+        bool evdev = false;
+        {
+            std::lock_guard<std::mutex> lock(hotkeyWriteMutex);
+            auto it = hotkeys.find(hotkeyId);
+            if (it == hotkeys.end()) {
+                std::cerr << "Hotkey ID not found: " << hotkeyId << std::endl;
+                return false;
+            }
+            alias = it->second.alias;
+            keycode = it->second.key;
+            modifiers = it->second.modifiers;
+            evdev = it->second.evdev;
         }
-        const HotKey &hotkey = it->second;
-        lo.info("Ungrabbing hotkey: " + hotkey.alias);
+        lo.info("Ungrabbing hotkey: " + alias);
         Window root = DefaultRootWindow(display);
-        KeyCode keycode = hotkey.key;
 
         if (keycode == 0) {
-            std::cerr << "Invalid keycode for hotkey: " << hotkey.alias <<
+            std::cerr << "Invalid keycode for hotkey: " << alias <<
                     std::endl;
             return false;
         }
 
         // Use our improved method to ungrab with all modifier variants
-        if (!hotkey.evdev) {
-            Ungrab(keycode, hotkey.modifiers, root);
+        if (!evdev) {
+            Ungrab(keycode, modifiers, root);
+        }
+        {
+            std::lock_guard<std::mutex> lock(hotkeyWriteMutex);
+            auto it = hotkeys.find(hotkeyId);
+            if (it != hotkeys.end()) it->second.grabbed = false;
         }
 
-        std::cout << "Successfully ungrabbed hotkey: " << hotkey.alias <<
+        std::cout << "Successfully ungrabbed hotkey: " << alias <<
                 std::endl;
         return true;
 #else
@@ -1807,16 +2097,26 @@ LRESULT CALLBACK IO::KeyboardProc(int nCode, WPARAM wParam, LPARAM lParam)
 #endif
     }
 
+    // Collected under the lock; GrabHotkey and UngrabHotkey take it again
+    std::vector<int> IO::HotkeyIdsByPrefix(const std::string &prefix) {
+        std::vector<int> ids;
+        std::lock_guard<std::mutex> lock(hotkeyWriteMutex);
+        for (const auto &[id, hotkey]: hotkeys) {
+            if (hotkey.alias.find(prefix) == 0) {
+                ids.push_back(id);
+            }
+        }
+        return ids;
+    }
+
     bool IO::GrabHotkeysByPrefix(const std::string &prefix) {
 #ifdef __linux__
         if (!display) return false;
 
         bool success = true;
-        for (const auto &[id, hotkey]: hotkeys) {
-            if (hotkey.alias.find(prefix) == 0) {
-                if (!GrabHotkey(id)) {
-                    success = false;
-                }
+        for (int id: HotkeyIdsByPrefix(prefix)) {
+            if (!GrabHotkey(id)) {
+                success = false;
             }
         }
         return success;
@@ -1830,11 +2130,9 @@ LRESULT CALLBACK IO::KeyboardProc(int nCode, WPARAM wParam, LPARAM lParam)
         if (!display) return false;
 
         bool success = true;
-        for (const auto &[id, hotkey]: hotkeys) {
-            if (hotkey.alias.find(prefix) == 0) {
-                if (!UngrabHotkey(id)) {
-                    success = false;
-                }
+        for (int id: HotkeyIdsByPrefix(prefix)) {
+            if (!UngrabHotkey(id)) {
+                success = false;
             }
         }
         return success;
@@ -1843,136 +2141,483 @@ LRESULT CALLBACK IO::KeyboardProc(int nCode, WPARAM wParam, LPARAM lParam)
 #endif
     }
 
-    bool IO::MatchModifiers(uint hotkeyMods,
-                            const std::map<int, bool> &keyState) {
-        return ((hotkeyMods & ControlMask) == 0 ||
-                keyState.at(KEY_LEFTCTRL) || keyState.at(KEY_RIGHTCTRL)) &&
-               ((hotkeyMods & ShiftMask) == 0 ||
-                keyState.at(KEY_LEFTSHIFT) || keyState.at(KEY_RIGHTSHIFT)) &&
-               ((hotkeyMods & Mod1Mask) == 0 ||
-                keyState.at(KEY_LEFTALT) || keyState.at(KEY_RIGHTALT)) &&
-               ((hotkeyMods & Mod4Mask) == 0 ||
-                keyState.at(KEY_LEFTMETA) || keyState.at(KEY_RIGHTMETA));
+    bool IO::StartEvdevHotkeyListener(const std::string &devicePath) {
+        return StartEvdevHotkeyListener(std::vector<std::string>{devicePath});
     }
 
-    bool IO::StartEvdevHotkeyListener(const std::string &devicePath) {
+    bool IO::StartEvdevHotkeyListener(const std::vector<std::string> &devicePaths) {
         if (evdevRunning) return false;
-        evdevDevicePath = devicePath;
+        if (evdevThread.joinable()) evdevThread.join();
+        evdevDevicePaths = devicePaths;
+
+        // Created up front so StopEvdevHotkeyListener can always wake the loop
+        if (evdevWakeFd < 0) {
+            evdevWakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+            if (evdevWakeFd < 0) {
+                std::cerr << "evdev: eventfd failed: " << strerror(errno) << "\n";
+                return false;
+            }
+        }
         evdevRunning = true;
 
-        evdevThread = std::thread([this]() {
-            int fd = open(evdevDevicePath.c_str(), O_RDONLY | O_NONBLOCK);
+        evdevThread = std::thread(&IO::EvdevLoop, this);
+        return true;
+    }
+
+    static constexpr const char *EvdevInputDir = "/dev/input";
+
+    static bool HasEvdevBit(const unsigned char *bits, int bit) {
+        return bits[bit / 8] & (1 << (bit % 8));
+    }
+
+    bool IO::WantsEvdevDevice(const std::string &path, int fd) const {
+        // Captured devices are grabbed and re-emitted through uinput, which
+        // only reproduces keys, buttons and relative motion. Touchpads and
+        // tablets would lose their input.
+        unsigned char evBits[EV_MAX / 8 + 1] = {};
+        if (ioctl(fd, EVIOCGBIT(0, sizeof(evBits)), evBits) < 0 ||
+            HasEvdevBit(evBits, EV_ABS)) {
+            return false;
+        }
+
+        // Never capture our own output device, that would loop forever.
+        // Checked before the configured paths too: the uinput device exists
+        // by now and may sit at one of them.
+        char name[256] = {};
+        ioctl(fd, EVIOCGNAME(sizeof(name)), name);
+        if (strcmp(name, UinputDeviceName) == 0 ||
+            strcmp(name, HotkeyUinputDeviceName) == 0) {
+            return false;
+        }
+
+        if (!evdevDevicePaths.empty()) {
+            for (const auto &wanted: evdevDevicePaths) {
+                if (wanted == path) return true;
+                // Configured paths may be by-id/by-path symlinks
+                std::error_code ec;
+                auto resolved = std::filesystem::canonical(wanted, ec);
+                if (!ec && resolved == path) return true;
+            }
+            return false;
+        }
+
+        // Keyboards and macro pads only; mice are left to the X server
+        if (HasEvdevBit(evBits, EV_REL)) {
+            return false;
+        }
+        unsigned char keyBits[KEY_MAX / 8 + 1] = {};
+        if (ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keyBits)), keyBits) < 0) {
+            return false;
+        }
+        for (int code = KEY_ESC; code <= KEY_MICMUTE; ++code) {
+            if (HasEvdevBit(keyBits, code)) return true;
+        }
+        return false;
+    }
+
+    void IO::EvdevLoop() {
+        if (!SetupUinputDevice()) {
+            evdevRunning = false;
+            std::cerr << "evdev: failed to setup uinput device\n";
+            return;
+        }
+
+        evdevKeyState.Clear();
+
+        int epfd = epoll_create1(EPOLL_CLOEXEC);
+        if (epfd < 0) {
+            std::cerr << "evdev: epoll_create1 failed: " << strerror(errno) << "\n";
+            evdevRunning = false;
+            return;
+        }
+        epoll_event reg{};
+        reg.events = EPOLLIN;
+        reg.data.fd = evdevWakeFd;
+        epoll_ctl(epfd, EPOLL_CTL_ADD, evdevWakeFd, &reg);
+
+        // Device nodes show up with IN_CREATE, but udev usually fixes their
+        // permissions afterwards, so retry on IN_ATTRIB as well
+        int inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotifyFd >= 0 &&
+            inotify_add_watch(inotifyFd, EvdevInputDir,
+                              IN_CREATE | IN_ATTRIB | IN_DELETE) >= 0) {
+            reg.data.fd = inotifyFd;
+            epoll_ctl(epfd, EPOLL_CTL_ADD, inotifyFd, &reg);
+        } else {
+            std::cerr << "evdev: hotplug disabled, inotify failed: " <<
+                    strerror(errno) << "\n";
+            if (inotifyFd >= 0) close(inotifyFd);
+            inotifyFd = -1;
+        }
+
+        std::unordered_map<int, EvdevDevice> devices; // By fd
+
+        auto addDevice = [&](const std::string &path) {
+            for (const auto &[fd, dev]: devices) {
+                if (dev.path == path) return;
+            }
+            int fd = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
             if (fd < 0) {
-                std::cerr << "evdev: cannot open " << evdevDevicePath << ": " <<
+                // Expected while udev is still setting the node up
+                if (errno != EACCES && errno != ENOENT) {
+                    std::cerr << "evdev: cannot open " << path << ": " <<
+                            strerror(errno) << "\n";
+                }
+                return;
+            }
+            if (!WantsEvdevDevice(path, fd)) {
+                close(fd);
+                return;
+            }
+            // Everything the device sends is re-emitted through uinput, so
+            // clients must not also get it directly
+            if (ioctl(fd, EVIOCGRAB, 1) < 0) {
+                std::cerr << "evdev: cannot grab " << path << ": " <<
                         strerror(errno) << "\n";
-                evdevRunning = false;
+                close(fd);
                 return;
             }
-            if (!SetupUinputDevice()) {
+            // Timestamp events on the steady clock so latency can be
+            // measured from them
+            int clockId = CLOCK_MONOTONIC;
+            bool monotonic = ioctl(fd, EVIOCSCLOCKID, &clockId) == 0;
+            if (!monotonic) {
+                lo.warning("evdev: cannot set the clock of " + path + " (" +
+                           strerror(errno) + "), not measuring its latency");
+            }
+            epoll_event devReg{};
+            devReg.events = EPOLLIN;
+            devReg.data.fd = fd;
+            if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &devReg) < 0) {
+                std::cerr << "evdev: cannot watch " << path << ": " <<
+                        strerror(errno) << "\n";
                 close(fd);
-                evdevRunning = false;
-                std::cerr << "evdev: failed to setup uinput device\n";
                 return;
             }
+            auto &dev = devices[fd];
+            dev.fd = fd;
+            dev.path = path;
+            dev.monotonic = monotonic;
+            lo.info("evdev: capturing " + path);
+        };
 
+        auto removeDevice = [&](int fd) {
+            auto it = devices.find(fd);
+            if (it == devices.end()) return;
+            lo.info("evdev: device " + it->second.path + " went away");
+            ReleaseEvdevDevice(it->second);
+            epoll_ctl(epfd, EPOLL_CTL_DEL, fd, nullptr);
+            close(fd);
+            devices.erase(it);
+        };
 
-            struct input_event ev{};
-            std::map<int, bool> modState;
+        auto isEventNode = [](std::string_view name) {
+            return name.rfind("event", 0) == 0;
+        };
 
-            while (evdevRunning) {
-                ssize_t n = read(fd, &ev, sizeof(ev));
-                if (n != sizeof(ev)) {
-                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
-                    continue;
+        auto scanDevices = [&]() {
+            std::error_code ec;
+            for (const auto &entry:
+                 std::filesystem::directory_iterator(EvdevInputDir, ec)) {
+                if (isEventNode(entry.path().filename().string())) {
+                    addDevice(entry.path().string());
                 }
+            }
+        };
 
-                if (ev.type != EV_KEY) continue;
-
-                bool down = (ev.value == 1 || ev.value == 2);
-                int code = ev.code;
-                evdevKeyState[code] = down;
-
-                // Now aggregate modifiers
-                modState[ControlMask] =
-                        evdevKeyState[KEY_LEFTCTRL] || evdevKeyState[
-                            KEY_RIGHTCTRL];
-                modState[ShiftMask] =
-                        evdevKeyState[KEY_LEFTSHIFT] || evdevKeyState[
-                            KEY_RIGHTSHIFT];
-                modState[Mod1Mask] =
-                        evdevKeyState[KEY_LEFTALT] || evdevKeyState[
-                            KEY_RIGHTALT];
-                modState[Mod4Mask] =
-                        evdevKeyState[KEY_LEFTMETA] || evdevKeyState[
-                            KEY_RIGHTMETA];
-                // Emergency exit: Ctrl + Alt + Esc
-                if (code == KEY_ESC && down && modState[ControlMask] && modState
-                    [Mod1Mask]) {
-                    std::cerr << "[evdev] Emergency exit triggered\n";
-                    StopEvdevHotkeyListener();
-                    return;
-                }
+        scanDevices();
+        if (devices.empty()) {
+            std::cerr << "evdev: no input devices yet, waiting for hotplug\n";
+        }
 
-                bool wasDown = keyDownState[code];
-                keyDownState[code] = down;
+        epoll_event ready[16];
+        alignas(inotify_event) char notifyBuf[4096];
 
-                // Only trigger on fresh key press
-                if (!down || wasDown) {
-                    EmitToUinput(code, down);
-                    continue;
-                } {
-                    std::vector<std::function<void()>> callbacks;
-                        {
-                            std::scoped_lock hotkeyLock(hotkeyMutex);  // Only lock here
-                            for (auto &[id, hotkey]: hotkeys) {
-                            if (!hotkey.enabled || !hotkey.evdev || hotkey.key != static_cast<Key>(code))
-                                continue;
+        while (evdevRunning) {
+            int n = epoll_wait(epfd, ready, 16, -1);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                std::cerr << "evdev: epoll_wait failed: " << strerror(errno) << "\n";
+                break;
+            }
 
-                            // Exact modifier matching
-                            if (!MatchModifiers(hotkey.modifiers, evdevKeyState))
+            for (int i = 0; i < n && evdevRunning; ++i) {
+                int fd = ready[i].data.fd;
+                if (fd == evdevWakeFd) {
+                    DrainWakeFd(evdevWakeFd, "evdev");
+                } else if (fd == inotifyFd) {
+                    bool rescan = false;
+                    ssize_t len;
+                    while ((len = read(inotifyFd, notifyBuf, sizeof(notifyBuf))) > 0) {
+                        for (char *p = notifyBuf; p < notifyBuf + len;) {
+                            auto *ev = reinterpret_cast<inotify_event *>(p);
+                            p += sizeof(inotify_event) + ev->len;
+                            if (ev->mask & IN_Q_OVERFLOW) {
+                                rescan = true;
                                 continue;
-
-                            // Context checks
-                            if (!hotkey.contexts.empty()) {
-                                if (!std::all_of(hotkey.contexts.begin(),
-                                                hotkey.contexts.end(),
-                                                [](auto &ctx) { return ctx(); })) {
-                                    continue;
-                                }
                             }
-
-                            hotkey.success = true;
-                            if (hotkey.callback) {
-                                callbacks.push_back(hotkey.callback);
+                            if (ev->len == 0 || !isEventNode(ev->name)) continue;
+
+                            std::string path = std::string(EvdevInputDir) + "/" + ev->name;
+                            if (ev->mask & IN_DELETE) {
+                                for (const auto &[devFd, dev]: devices) {
+                                    if (dev.path == path) {
+                                        removeDevice(devFd);
+                                        break;
+                                    }
+                                }
+                            } else {
+                                addDevice(path);
                             }
                         }
                     }
-
-                    // Then, execute all callbacks without holding the lock
-                    for (auto &callback: callbacks) {
-                        try {
-                            callback();
-                        } catch (const std::exception &e) {
-                            std::cerr << "Error in hotkey callback: " << e.what() << std::endl;
-                        }
+                    if (rescan) scanDevices();
+                } else {
+                    auto it = devices.find(fd);
+                    if (it == devices.end()) continue;
+                    // Read before honouring HUP so the last report is not lost
+                    bool alive = ReadEvdevDevice(it->second);
+                    if (!alive || (ready[i].events & (EPOLLERR | EPOLLHUP))) {
+                        removeDevice(fd);
                     }
                 }
-                EmitToUinput(code, down);
             }
+        }
 
+        // Release whatever is still held, as removeDevice does; on the
+        // emergency exit that includes the Ctrl and Alt it was typed with
+        for (auto &[fd, dev]: devices) {
+            ReleaseEvdevDevice(dev);
             close(fd);
-        });
+        }
+        if (inotifyFd >= 0) close(inotifyFd);
+        close(epfd);
+        evdevRunning = false;
+    }
 
+    bool IO::ReadEvdevDevice(EvdevDevice &device) {
+        input_event buf[EvdevReadBatch];
+
+        // Drain everything the kernel has queued, many events per syscall
+        while (evdevRunning) {
+            ssize_t r = read(device.fd, buf, sizeof(buf));
+            if (r < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN) return true;
+                if (errno != ENODEV) {
+                    std::cerr << "evdev: read " << device.path << " failed: " <<
+                            strerror(errno) << "\n";
+                }
+                return false;
+            }
+            if (r == 0) return true;
+
+            // A report ends at SYN_REPORT; anything after SYN_DROPPED up to
+            // the next SYN_REPORT is garbage and gets discarded, then the
+            // key state is read back from the kernel
+            size_t count = static_cast<size_t>(r) / sizeof(input_event);
+            for (size_t i = 0; i < count && evdevRunning; ++i) {
+                const input_event &ev = buf[i];
+                if (ev.type == EV_SYN && ev.code == SYN_DROPPED) {
+                    device.dropping = true;
+                    device.frameLen = 0;
+                    continue;
+                }
+                if (ev.type == EV_SYN && ev.code == SYN_REPORT) {
+                    if (device.dropping) {
+                        ResyncEvdevDevice(device);
+                    } else {
+                        ProcessEvdevFrame(device, device.frame, device.frameLen);
+                    }
+                    device.dropping = false;
+                    device.frameLen = 0;
+                    continue;
+                }
+                if (device.dropping) continue;
+                if (device.frameLen == EvdevFrameMax) {
+                    // Oversized report: flush what we have so far
+                    ProcessEvdevFrame(device, device.frame, device.frameLen);
+                    device.frameLen = 0;
+                }
+                device.frame[device.frameLen++] = ev;
+            }
+            if (static_cast<size_t>(r) < sizeof(buf)) return true;
+        }
         return true;
     }
 
+    void IO::ReleaseEvdevDevice(EvdevDevice &device) {
+        // Unplugging with a key held must not leave it stuck, neither in
+        // the shared modifier state nor on the uinput side
+        UinputFrame out;
+        for (int code = 0; code < KEY_CNT; ++code) {
+            if (!device.held.test(code)) continue;
+            evdevKeyState.Set(code, false);
+            if (!out.Key(code, 0)) {
+                out.Flush(uinputFd);
+                out.Key(code, 0);
+            }
+        }
+        out.Flush(uinputFd);
+        device.held.reset();
+    }
+
+    void IO::ResyncEvdevDevice(EvdevDevice &device) {
+        unsigned char keyBits[KEY_MAX / 8 + 1] = {};
+        if (ioctl(device.fd, EVIOCGKEY(sizeof(keyBits)), keyBits) < 0) {
+            std::cerr << "evdev: cannot resync " << device.path << ": " <<
+                    strerror(errno) << "\n";
+            return;
+        }
+
+        // Whatever changed while events were lost: releases we never saw
+        // would leave keys (modifiers above all) stuck down here and on the
+        // uinput side. Only the state is replayed, hotkeys don't fire.
+        UinputFrame out;
+        size_t changed = 0;
+        for (int code = 0; code < KEY_CNT; ++code) {
+            bool down = HasEvdevBit(keyBits, code);
+            if (device.held.test(code) == down) continue;
+            device.held.set(code, down);
+            evdevKeyState.Set(code, down);
+            if (!out.Key(code, down ? 1 : 0)) {
+                out.Flush(uinputFd);
+                out.Key(code, down ? 1 : 0);
+            }
+            changed++;
+        }
+        out.Flush(uinputFd);
+        if (changed) {
+            lo.warning("evdev: " + device.path + " dropped events, resynced " +
+                       std::to_string(changed) + " keys");
+        }
+    }
+
+    void IO::ProcessEvdevFrame(EvdevDevice &device, const input_event *events,
+                               size_t count) {
+        using Clock = LatencyTracker::Clock;
+
+        // Everything forwarded for this report goes out in one write
+        UinputFrame out;
+        Clock::time_point eventTime;
+        Clock::time_point forwardOrigin;    // Oldest event in `out`
+        const bool timed = device.monotonic;
+        auto flushForwarded = [&] {
+            out.Flush(uinputFd);
+            if (forwardOrigin != Clock::time_point{}) {
+                latency.Record(LatencyTracker::Stage::EvdevForward,
+                               Clock::now() - forwardOrigin);
+                forwardOrigin = {};
+            }
+        };
+        auto forward = [&](int code, bool down) {
+            if (!out.Key(code, down ? 1 : 0)) {
+                flushForwarded();
+                out.Key(code, down ? 1 : 0);
+            }
+            if (timed && forwardOrigin == Clock::time_point{}) {
+                forwardOrigin = eventTime;
+            }
+        };
+
+        for (size_t i = 0; i < count && evdevRunning; ++i) {
+            const input_event &ev = events[i];
+            if (ev.type == EV_REL) {
+                // A configured mouse is grabbed like any other device
+                if (!out.Rel(ev.code, ev.value)) {
+                    flushForwarded();
+                    out.Rel(ev.code, ev.value);
+                }
+                continue;
+            }
+            if (ev.type != EV_KEY) continue;
+
+            // The devices report CLOCK_MONOTONIC, the steady clock's base
+            eventTime = Clock::time_point(std::chrono::seconds(ev.input_event_sec) +
+                                          std::chrono::microseconds(ev.input_event_usec));
+            bool down = (ev.value == 1 || ev.value == 2);
+            int code = ev.code;
+            FlightRecorder::RecordKey(code);
+            bool wasDown = evdevKeyState.Set(code, down);
+            if (code < KEY_CNT) {
+                device.held.set(code, down);
+            }
+
+            // Emergency exit: Ctrl + Alt + Esc
+            constexpr unsigned int ctrlAlt = ControlMask | Mod1Mask;
+            if (code == KEY_ESC && down &&
+                (evdevKeyState.Modifiers() & ctrlAlt) == ctrlAlt) {
+                std::cerr << "[evdev] Emergency exit triggered\n";
+                // Esc itself was never forwarded, so there is nothing to release
+                device.held.reset(code);
+                evdevRunning = false;
+                break;
+            }
+
+            // Only trigger on a fresh press or release; auto-repeat is
+            // forwarded untouched
+            if (down == wasDown) {
+                forward(code, down);
+                continue;
+            }
+
+            {
+                // Pin the current snapshot for this event; writers never
+                // block us while they rebuild
+                auto table = HotkeyTable();
+                for (const auto &entry: table->index.Candidates(
+                         HotkeySource::Evdev, code, !down)) {
+                    // Required modifiers must be held
+                    if (!evdevKeyState.Matches(entry.modifiers))
+                        continue;
+
+                    const HotKey *match = table->Find(entry.id);
+                    if (!match)
+                        continue;
+                    const HotKey &hotkey = *match;
+
+                    // Context checks
+                    if (!hotkey.contexts.empty()) {
+                        if (!std::all_of(hotkey.contexts.begin(),
+                                         hotkey.contexts.end(),
+                                         [](auto &ctx) { return ctx(); })) {
+                            continue;
+                        }
+                    }
+
+                    FlightRecorder::Record(TraceEvent::HotkeyMatched, entry.id);
+
+                    // Run on the executor so a slow action never stalls
+                    // key forwarding
+                    if (hotkey.callback) {
+                        if (timed) {
+                            latency.Record(LatencyTracker::Stage::EvdevDispatch,
+                                           Clock::now() - eventTime);
+                        }
+                        hotkeyExecutor.Submit(entry.id, hotkey.callback, true,
+                                              timed ? eventTime : HotkeyExecutor::NoOrigin);
+                    }
+                }
+            }
+            forward(code, down);
+        }
+        flushForwarded();
+    }
+
     void IO::StopEvdevHotkeyListener() {
-        if (!evdevRunning) return;
         evdevRunning = false;
-        if (evdevThread.joinable()) evdevThread.join(); {
+        if (evdevWakeFd >= 0) {
+            SignalWakeFd(evdevWakeFd, "evdev");
+        }
+        if (evdevThread.joinable()) evdevThread.join();
+        {
             std::scoped_lock lock(blockedKeysMutex);
             blockedKeys.clear();
         }
+        if (evdevWakeFd >= 0) {
+            close(evdevWakeFd);
+            evdevWakeFd = -1;
+        }
 
         CleanupUinputDevice();
     }
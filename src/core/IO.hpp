@@ -12,12 +12,24 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <atomic>
+#include <bitset>
 #include <cstring>
 #include <set>
 #include <sstream>
 #include <linux/uinput.h>   // ✅ This gives you UI_SET_* and uinput_setup
 #include <sys/ioctl.h>
 #include <memory>
+#include "HotkeyIndex.hpp"
+#include "HotkeyExecutor.hpp"
+#include "EvdevKeyState.hpp"
+#include "UinputFrame.hpp"
+#include "../utils/LruCache.hpp"
+#include "TextTyper.hpp"
+#include "MotionEngine.hpp"
+#include "LatencyTracker.hpp"
+#include "TimerService.hpp"
+#include <mutex>
+#include <unordered_set>
 
 namespace havel {
 
@@ -49,6 +61,10 @@ enum class MouseAction {
         bool success = false;
         bool evdev = false;
         bool isKeyUp = false; // Tracks if this is a key release hotkey
+        // X11 hotkeys: the keysym `key` is the keycode of, so the keycode
+        // can be looked up again when the keyboard mapping changes
+        Key keysym = 0;
+        bool grabbed = false; // Writer side only; stale in snapshots
     };
 
     struct ModifierState {
@@ -62,6 +78,27 @@ enum class MouseAction {
         bool rightMeta = false;
     };
 
+    // Immutable view of the hotkey table read by the input threads. Writers
+    // copy the current snapshot, apply their change and publish the copy;
+    // the old one is freed once the last reader drops its reference.
+    struct HotkeySnapshot {
+        HotkeyIndex index;
+        std::unordered_map<int, std::shared_ptr<const HotKey>> bindings;
+
+        const HotKey *Find(int id) const {
+            auto it = bindings.find(id);
+            return it != bindings.end() ? it->second.get() : nullptr;
+        }
+    };
+
+    // One key event of a compiled Send() string
+    struct SendOp {
+        Key code;  // evdev code, or an X keysym when x11 is set
+        bool down;
+        bool x11;
+    };
+    using SendProgram = std::vector<SendOp>;
+
     struct IoEvent {
         Key key;
         int modifiers;
@@ -69,12 +106,51 @@ enum class MouseAction {
     };
 
     class IO {
+        // Dispatch latency per stage and per hotkey; declared before the
+        // executor, which reports into it
+        LatencyTracker latency;
+        // Runs matched hotkey callbacks for both the X11 and evdev paths
+        HotkeyExecutor hotkeyExecutor;
         std::thread evdevThread;
         std::atomic<bool> evdevRunning{false};
-        std::string evdevDevicePath;
+        // Devices captured (and grabbed) by the evdev listener; empty
+        // captures every keyboard, including ones plugged in later
+        std::vector<std::string> evdevDevicePaths;
+        // eventfd used to wake the evdev loop out of epoll_wait() on shutdown
+        int evdevWakeFd = -1;
+        static constexpr size_t EvdevReadBatch = 64;
+        static constexpr size_t EvdevFrameMax = 64;
 
     public:
+        // Writer-side hotkey table. Mutate it under hotkeyWriteMutex and
+        // then call PublishHotkeys so the input threads see the change.
         static std::unordered_map<int, HotKey> hotkeys;
+        static std::mutex hotkeyWriteMutex;
+
+        // Current snapshot. Readers never wait for hotkeyWriteMutex or a
+        // rebuild, but std::atomic<std::shared_ptr> is not lock-free:
+        // libstdc++ guards it with a spin lock held for the refcount
+        // update, so a load can briefly contend with a publish.
+        static std::shared_ptr<const HotkeySnapshot> HotkeyTable() {
+            return hotkeySnapshot.load(std::memory_order_acquire);
+        }
+
+        // Rebuild the snapshot entries for `ids` from `hotkeys` and publish,
+        // or inside a HotkeyBatch, once the batch ends.
+        // Caller must hold hotkeyWriteMutex.
+        static void PublishHotkeys(std::initializer_list<int> ids);
+
+        // Defers PublishHotkeys while alive, so a config load or a script
+        // block that registers many hotkeys copies the table once, when
+        // the outermost batch ends. Do not hold hotkeyWriteMutex when
+        // creating or destroying one.
+        class HotkeyBatch {
+        public:
+            HotkeyBatch();
+            ~HotkeyBatch();
+            HotkeyBatch(const HotkeyBatch &) = delete;
+            HotkeyBatch &operator=(const HotkeyBatch &) = delete;
+        };
         bool suspendHotkeys = false;
 
         IO();
@@ -85,6 +161,9 @@ enum class MouseAction {
         void Send(Key key, bool down = true);
 
         void Send(cstr keys);
+
+        // Type literal UTF-8 text; unlike Send() nothing is interpreted
+        bool Type(const std::string &text);
         void SendUInput(int keycode, bool down);
         void SendSpecific(const std::string &keys);
 
@@ -110,6 +189,19 @@ enum class MouseAction {
 
         bool Resume(int id);
 
+        // Ungrab and drop hotkey `id`, along with its latency histogram
+        // and executor stats
+        bool RemoveHotkey(int id);
+
+        // Per-hotkey callback counts and latency from the executor
+        std::unordered_map<int, HotkeyExecutor::LatencyStats> HotkeyStats() const {
+            return hotkeyExecutor.Stats();
+        }
+
+        // Dispatch latency histograms, hotkeys named by alias
+        std::string LatencyReport() const;
+        void ResetLatency() { latency.Reset(); }
+
         // Suspend or resume all hotkeys
         void suspendAllHotkeys(bool suspend) {
             suspendHotkeys = suspend;
@@ -133,6 +225,8 @@ enum class MouseAction {
         static void PressKey(const std::string &keyName, bool press);
 
         // Utility methods
+        // Run `func` on the executor every `milliseconds`, or once after
+        // -`milliseconds`; clear the returned flag to stop it
         std::shared_ptr<std::atomic<bool>> SetTimer(int milliseconds, const std::function<void()> &func);
 
         void MsgBox(const std::string &message);
@@ -167,9 +261,18 @@ enum class MouseAction {
 
         static Key StringToVirtualKey(std::string keyName);
 
+        static Key EvdevNameToKeyCode(std::string keyName);
+
+        // The key events a Send() string produces; Send() caches these
+        static SendProgram CompileSend(const std::string &keys);
+
         // Call this to start listening on your keyboard device
         bool StartEvdevHotkeyListener(const std::string &devicePath);
 
+        // Listen on several devices at once from a single thread. Devices
+        // that disappear are dropped and picked up again when they return.
+        bool StartEvdevHotkeyListener(const std::vector<std::string> &devicePaths);
+
         // Call this to stop the thread cleanly
         void StopEvdevHotkeyListener();
 
@@ -205,7 +308,13 @@ enum class MouseAction {
         }
 
         bool MouseClick(int btnCode, int dx, int dy, int speed, float accel);
+        // Blocks until the pointer has moved, as it always has; moves from
+        // several threads at once add up
         bool MouseMove(int dx, int dy, int speed, float accel);
+        // Eased/curved pointer motion on the motion thread, added to any
+        // motion already playing
+        std::future<bool> MouseMoveAsync(const MotionEngine::Motion &motion);
+        void CancelMouseMove();
         bool Scroll(int dy, int dx = 0);
     private:
         template<typename T>
@@ -221,26 +330,83 @@ enum class MouseAction {
         // X11 hotkey monitoring
         void MonitorHotkeys();
 
-        static Key EvdevNameToKeyCode(std::string keyName);
-        bool MatchModifiers(uint hotkeyMods, const std::map<int, bool> &keyState);
+        // One device captured by the evdev listener. Reports are assembled
+        // per device; key and modifier state is shared across all of them.
+        struct EvdevDevice {
+            int fd = -1;
+            std::string path;
+            input_event frame[EvdevFrameMax];
+            size_t frameLen = 0;
+            bool dropping = false;
+            std::bitset<KEY_CNT> held; // Keys this device currently holds down
+            // Event times are on the steady clock (EVIOCSCLOCKID took);
+            // latency is only measured for devices where they are
+            bool monotonic = false;
+        };
+
+        void EvdevLoop();
+        bool WantsEvdevDevice(const std::string &path, int fd) const;
+        // Drain a readable device; false once it is gone
+        bool ReadEvdevDevice(EvdevDevice &device);
+        // Release whatever a vanished device left held down
+        void ReleaseEvdevDevice(EvdevDevice &device);
+        // After a SYN_DROPPED, bring the tracked and forwarded key state in
+        // line with what the kernel says is held (EVIOCGKEY)
+        void ResyncEvdevDevice(EvdevDevice &device);
+        // Handle one SYN_REPORT-delimited evdev report (without the SYN)
+        void ProcessEvdevFrame(EvdevDevice &device, const input_event *events,
+                               size_t count);
         // Platform specific implementations
         Display *display;
         std::map<std::string, Key> keyMap;
-        std::map<int, bool> evdevKeyState;
+        // Shared by every captured device; only the evdev thread touches it
+        EvdevKeyState evdevKeyState;
         std::map<std::string, HotKey> instanceHotkeys;
         // Renamed to avoid conflict
         std::map<std::string, bool> hotkeyStates;
         std::thread timerThread;
-        bool timerRunning = false;
+        std::atomic<bool> timerRunning{false};
+        // TimerService timers started by SetTimer, cancelled with the IO
+        std::mutex setTimersMutex;
+        std::unordered_set<TimerService::TimerId> setTimers;
+        // Executor ids for SetTimer callbacks, negative so they never
+        // collide with hotkey ids
+        std::atomic<int> nextTimerJob{-1};
+        // eventfd used to wake the X11 loop out of poll(), on shutdown and
+        // after other threads' round trips on the shared display
+        int x11WakeFd = -1;
+        // Called after an XSync on another thread: it may have moved the
+        // monitor's events into Xlib's queue without the socket waking it
+        void WakeX11Monitor();
+        static constexpr int X11PollFallbackMs = 1000;
         int uinputFd = -1;
         std::set<int> blockedKeys;
 
         // Static members
         static bool hotkeyEnabled;
-        static int hotkeyCount;
-        std::mutex hotkeyMutex;
+        static std::atomic<std::shared_ptr<const HotkeySnapshot>> hotkeySnapshot;
+        // Open HotkeyBatch count and the ids they deferred; both guarded
+        // by hotkeyWriteMutex
+        static int publishDepth;
+        static std::unordered_set<int> pendingPublish;
+        static void FlushPublish();
+        // Move X11 hotkeys, and their grabs, to the keycodes their keysyms
+        // have in the current keyboard mapping
+        void RemapHotkeys();
+        // Ids of the hotkeys whose alias starts with `prefix`
+        static std::vector<int> HotkeyIdsByPrefix(const std::string &prefix);
+        // Last id handed out; registrations race for it outside the lock
+        static std::atomic<int> hotkeyCount;
         std::mutex blockedKeysMutex;
-        std::map<int, bool> keyDownState;
+
+        // Send() strings compiled to key ops, keyed by the string
+        static constexpr size_t SendCacheSize = 256;
+        LruCache<std::string, std::shared_ptr<const SendProgram>> sendCache{SendCacheSize};
+        std::mutex sendCacheMutex;
+        void RunSendProgram(const SendProgram &program);
+
+        TextTyper textTyper;
+        MotionEngine motionEngine;
 
         // Key mapping and sending utilities
         void InitKeyMap();
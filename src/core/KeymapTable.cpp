@@ -0,0 +1,210 @@
+#include "KeymapTable.hpp"
+#include <X11/XKBlib.h>
+#include <X11/keysym.h>
+#include <linux/input.h>
+#include <algorithm>
+#include <atomic>
+
+namespace havel {
+
+static std::atomic<std::shared_ptr<const KeymapTable>> sharedTable;
+
+// XKeysymToString mallocs the names of most Unicode keysyms and the caller
+// cannot tell which results to free, so those are always spelled in the
+// "U20AC" form here; XStringToKeysym reads it back
+static std::string KeysymName(KeySym sym) {
+    if ((sym & 0xff000000) == 0x01000000) {
+        KeySym cp = sym & 0x00ffffff;
+        std::string name = "U";
+        for (int shift = (cp & 0xff0000) ? 28 : 12; shift >= 0; shift -= 4) {
+            name += "0123456789ABCDEF"[(cp >> shift) & 0xf];
+        }
+        return name;
+    }
+    const char *name = XKeysymToString(sym);
+    return name ? name : std::string();
+}
+
+char32_t KeymapTable::KeysymToCodepoint(KeySym sym) {
+    // Latin-1 keysyms are their own code points
+    if ((sym >= 0x20 && sym <= 0x7e) || (sym >= 0xa0 && sym <= 0xff)) {
+        return static_cast<char32_t>(sym);
+    }
+    // Directly encoded Unicode keysyms
+    if ((sym & 0xff000000) == 0x01000000) {
+        return static_cast<char32_t>(sym & 0x00ffffff);
+    }
+    switch (sym) {
+        case XK_Return:
+            return U'\n';
+        case XK_Tab:
+            return U'\t';
+        default:
+            // Legacy non-Latin-1 keysym sets are not translated; text that
+            // needs them falls back to pasting
+            return 0;
+    }
+}
+
+std::shared_ptr<const KeymapTable> KeymapTable::Build(Display *display) {
+    if (!display) {
+        return std::make_shared<KeymapTable>();
+    }
+
+    int minKeycode = 0, maxKeycode = 0;
+    XDisplayKeycodes(display, &minKeycode, &maxKeycode);
+    maxKeycode = std::min(maxKeycode, 255);
+
+    std::vector<Levels> levels;
+    for (int keycode = minKeycode; keycode <= maxKeycode; ++keycode) {
+        Levels &syms = levels.emplace_back();
+        for (int level = 0; level < 4; ++level) {
+            syms[level] = XkbKeycodeToKeysym(display, keycode, 0, level);
+        }
+    }
+    return Build(minKeycode, levels);
+}
+
+std::shared_ptr<const KeymapTable> KeymapTable::Build(int minKeycode,
+                                                      const std::vector<Levels> &levels) {
+    auto table = std::make_shared<KeymapTable>();
+    int maxKeycode = std::min<int>(minKeycode + static_cast<int>(levels.size()) - 1, 255);
+
+    // Levels outermost, like XKeysymToKeycode, so a keysym reachable
+    // without modifiers maps to that key, and a character reachable
+    // without modifiers is never recorded as a shifted one
+    auto &entries = table->byKeysym;
+    for (int level = 0; level < 4; ++level) {
+        for (int keycode = std::max(minKeycode, 0); keycode <= maxKeycode; ++keycode) {
+            KeySym sym = levels[keycode - minKeycode][level];
+            if (sym == NoSymbol) {
+                continue;
+            }
+            if (level == 0) {
+                table->byKeycode[keycode] = sym;
+            }
+            entries.push_back({sym, static_cast<KeyCode>(keycode), {}});
+
+            char32_t cp = KeysymToCodepoint(sym);
+            if (cp != 0 && keycode >= EvdevKeycodeOffset) {
+                Stroke stroke;
+                stroke.code = static_cast<uint16_t>(keycode - EvdevKeycodeOffset);
+                stroke.shift = (level & 1) != 0;
+                stroke.altGr = (level & 2) != 0;
+                table->AddCharacter(cp, stroke);
+            }
+        }
+    }
+
+    // Stable, so the first (lowest level, lowest keycode) entry wins
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const Entry &a, const Entry &b) { return a.sym < b.sym; });
+    entries.erase(std::unique(entries.begin(), entries.end(),
+                              [](const Entry &a, const Entry &b) { return a.sym == b.sym; }),
+                  entries.end());
+
+    for (uint32_t i = 0; i < entries.size(); ++i) {
+        entries[i].name = KeysymName(entries[i].sym);
+        if (!entries[i].name.empty()) {
+            table->byName.push_back(i);
+        }
+    }
+    std::sort(table->byName.begin(), table->byName.end(),
+              [&entries](uint32_t a, uint32_t b) { return entries[a].name < entries[b].name; });
+
+    auto &others = table->others;
+    std::stable_sort(others.begin(), others.end(),
+                     [](const auto &a, const auto &b) { return a.first < b.first; });
+    others.erase(std::unique(others.begin(), others.end(),
+                             [](const auto &a, const auto &b) { return a.first == b.first; }),
+                 others.end());
+
+    auto modifierCode = [&table](KeySym sym, uint16_t fallback) {
+        KeyCode keycode = table->Keycode(sym);
+        return keycode >= EvdevKeycodeOffset
+                   ? static_cast<uint16_t>(keycode - EvdevKeycodeOffset)
+                   : fallback;
+    };
+    table->shiftCode = modifierCode(XK_Shift_L, KEY_LEFTSHIFT);
+    table->altGrCode = modifierCode(XK_ISO_Level3_Shift, KEY_RIGHTALT);
+    return table;
+}
+
+std::shared_ptr<const KeymapTable> KeymapTable::Get(Display *display) {
+    auto table = sharedTable.load(std::memory_order_acquire);
+    if (table || !display) {
+        return table ? table : Build(nullptr);
+    }
+    // Two threads may both build after an invalidation; either result is
+    // current, so the last store winning is harmless
+    table = Build(display);
+    sharedTable.store(table, std::memory_order_release);
+    return table;
+}
+
+void KeymapTable::Invalidate() {
+    sharedTable.store(nullptr, std::memory_order_release);
+}
+
+const KeymapTable::Entry *KeymapTable::FindKeysym(KeySym sym) const {
+    auto it = std::lower_bound(byKeysym.begin(), byKeysym.end(), sym,
+        [](const Entry &entry, KeySym value) { return entry.sym < value; });
+    return it != byKeysym.end() && it->sym == sym ? &*it : nullptr;
+}
+
+KeyCode KeymapTable::Keycode(KeySym sym) const {
+    const Entry *entry = FindKeysym(sym);
+    return entry ? entry->code : 0;
+}
+
+KeySym KeymapTable::Keysym(KeyCode keycode) const {
+    return byKeycode[keycode];
+}
+
+KeySym KeymapTable::FromName(std::string_view name) const {
+    auto it = std::lower_bound(byName.begin(), byName.end(), name,
+        [this](uint32_t index, std::string_view value) {
+            return byKeysym[index].name < value;
+        });
+    if (it != byName.end() && byKeysym[*it].name == name) {
+        return byKeysym[*it].sym;
+    }
+    return XStringToKeysym(std::string(name).c_str());
+}
+
+std::string_view KeymapTable::Name(KeySym sym) const {
+    const Entry *entry = FindKeysym(sym);
+    return entry ? std::string_view(entry->name) : std::string_view();
+}
+
+void KeymapTable::AddCharacter(char32_t cp, Stroke stroke) {
+    if (cp < ascii.size()) {
+        if (ascii[cp].code == 0) {
+            ascii[cp] = stroke;
+        }
+        return;
+    }
+    others.emplace_back(cp, stroke);
+}
+
+const KeymapTable::Stroke *KeymapTable::Find(char32_t cp) const {
+    if (cp < ascii.size()) {
+        return ascii[cp].code ? &ascii[cp] : nullptr;
+    }
+    auto it = std::lower_bound(others.begin(), others.end(), cp,
+        [](const auto &entry, char32_t value) { return entry.first < value; });
+    if (it != others.end() && it->first == cp) {
+        return &it->second;
+    }
+    return nullptr;
+}
+
+size_t KeymapTable::CharacterCount() const {
+    size_t count = others.size();
+    for (const auto &stroke : ascii) {
+        if (stroke.code) ++count;
+    }
+    return count;
+}
+
+} // namespace havel
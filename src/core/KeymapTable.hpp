@@ -0,0 +1,94 @@
+#pragma once
+
+#include <X11/Xlib.h>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace havel {
+
+// X keycodes of evdev-driven keyboards are the kernel codes shifted by 8
+inline constexpr int EvdevKeycodeOffset = 8;
+
+// Everything the current X keyboard mapping says about keys: keysym,
+// keycode and keysym name conversions, and which key, with which
+// modifiers, types each character. Built once from the XKB keymap so
+// lookups never go back to Xlib. Keycodes and ASCII index flat arrays;
+// keysyms, names and other characters are binary searches over sorted
+// flat arrays.
+//
+// The process-wide table is rebuilt lazily after Invalidate(), which the X
+// event loop calls on MappingNotify and XkbNewKeyboardNotify.
+class KeymapTable {
+public:
+    struct Stroke {
+        uint16_t code = 0; // evdev key code (X keycode - 8); 0 = unmapped
+        bool shift = false;
+        bool altGr = false;
+    };
+
+    // The keysyms on the first four levels of group 1, per keycode
+    using Levels = std::array<KeySym, 4>;
+
+    static std::shared_ptr<const KeymapTable> Build(Display *display);
+    // `levels[i]` belongs to keycode `minKeycode + i`
+    static std::shared_ptr<const KeymapTable> Build(int minKeycode,
+                                                    const std::vector<Levels> &levels);
+
+    // Shared table for `display`, built on first use
+    static std::shared_ptr<const KeymapTable> Get(Display *display);
+    static void Invalidate();
+
+    // Lowest keycode producing `sym` on any of the first four levels, 0 if
+    // none; what XKeysymToKeycode would return
+    KeyCode Keycode(KeySym sym) const;
+
+    // Unshifted keysym on `keycode`, NoSymbol if none
+    KeySym Keysym(KeyCode keycode) const;
+
+    // Keysym spelled `name` as XStringToKeysym spells it. Names of keysyms
+    // the keymap does not carry fall back to Xlib.
+    KeySym FromName(std::string_view name) const;
+
+    // Name of `sym`, empty if the keymap does not carry it
+    std::string_view Name(KeySym sym) const;
+
+    // How to type `cp`, or nullptr when the layout cannot produce it
+    const Stroke *Find(char32_t cp) const;
+
+    // evdev codes of the keys used to reach the shifted levels
+    uint16_t ShiftCode() const { return shiftCode; }
+    uint16_t AltGrCode() const { return altGrCode; }
+
+    // Distinct keysyms, and characters with a stroke
+    size_t Size() const { return byKeysym.size(); }
+    size_t CharacterCount() const;
+
+    // Unicode code point a keysym types, or 0 if it is not a character
+    static char32_t KeysymToCodepoint(KeySym sym);
+
+private:
+    struct Entry {
+        KeySym sym;
+        KeyCode code;
+        std::string name;
+    };
+
+    const Entry *FindKeysym(KeySym sym) const;
+    void AddCharacter(char32_t cp, Stroke stroke);
+
+    std::array<KeySym, 256> byKeycode{};
+    std::vector<Entry> byKeysym;        // Sorted by keysym
+    std::vector<uint32_t> byName;       // Indices into byKeysym, sorted by name
+
+    std::array<Stroke, 128> ascii{};
+    std::vector<std::pair<char32_t, Stroke>> others; // Sorted by code point
+    uint16_t shiftCode = 0;
+    uint16_t altGrCode = 0;
+};
+
+} // namespace havel
@@ -0,0 +1,82 @@
+#include "LatencyTracker.hpp"
+#include <cstdio>
+#include <map>
+
+namespace havel {
+
+const char *LatencyTracker::StageName(Stage stage) {
+    switch (stage) {
+        case Stage::EvdevDispatch: return "evdev.dispatch";
+        case Stage::EvdevForward:  return "evdev.forward";
+        case Stage::X11Dispatch:   return "x11.dispatch";
+        case Stage::CallbackStart: return "callback.start";
+        default:                   return "unknown";
+    }
+}
+
+void LatencyTracker::RecordHotkey(int id, std::chrono::nanoseconds latency) {
+    Record(Stage::CallbackStart, latency);
+
+    std::shared_ptr<LatencyHistogram> histogram;
+    {
+        std::lock_guard<std::mutex> lock(hotkeysMutex);
+        auto &slot = hotkeys[id];
+        if (!slot) {
+            slot = std::make_shared<LatencyHistogram>();
+        }
+        histogram = slot;
+    }
+    histogram->Record(latency);
+}
+
+void LatencyTracker::ForgetHotkey(int id) {
+    std::lock_guard<std::mutex> lock(hotkeysMutex);
+    hotkeys.erase(id);
+}
+
+static void AppendLine(std::string &out, const std::string &name,
+                       const LatencyHistogram &histogram) {
+    auto us = [](std::chrono::nanoseconds ns) { return ns.count() / 1000.0; };
+    char line[256];
+    snprintf(line, sizeof(line),
+             "%s count=%llu p50=%.1f p99=%.1f p999=%.1f max=%.1f\n",
+             name.c_str(), static_cast<unsigned long long>(histogram.Count()),
+             us(histogram.Percentile(0.5)), us(histogram.Percentile(0.99)),
+             us(histogram.Percentile(0.999)), us(histogram.Max()));
+    out += line;
+}
+
+std::string LatencyTracker::Report(
+    const std::function<std::string(int)> &hotkeyName) const {
+    std::string out = "# latency in microseconds\n";
+    for (size_t i = 0; i < static_cast<size_t>(Stage::Count); ++i) {
+        AppendLine(out, StageName(static_cast<Stage>(i)), stages[i]);
+    }
+
+    // Sorted by id so repeated queries line up
+    std::map<int, std::shared_ptr<const LatencyHistogram>> fired;
+    {
+        std::lock_guard<std::mutex> lock(hotkeysMutex);
+        for (const auto &[id, histogram] : hotkeys) {
+            if (histogram->Count()) fired[id] = histogram;
+        }
+    }
+    for (const auto &[id, histogram] : fired) {
+        std::string name = hotkeyName ? hotkeyName(id) : std::string();
+        AppendLine(out, "hotkey " + (name.empty() ? std::to_string(id) : name),
+                   *histogram);
+    }
+    return out;
+}
+
+void LatencyTracker::Reset() {
+    for (auto &stage : stages) {
+        stage.Reset();
+    }
+    std::lock_guard<std::mutex> lock(hotkeysMutex);
+    for (auto &[id, histogram] : hotkeys) {
+        histogram->Reset();
+    }
+}
+
+} // namespace havel
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "../utils/LatencyHistogram.hpp"
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace havel {
+
+// Latency histograms for the stages of hotkey dispatch, plus one for the
+// full path to each hotkey's callback.
+//
+// Stage times are measured from the event's origin: the kernel timestamp
+// of an evdev event (the devices are switched to CLOCK_MONOTONIC, the
+// steady clock) or, for X11, the moment the event was dequeued.
+class LatencyTracker {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class Stage {
+        EvdevDispatch,      // Kernel timestamp -> callback queued
+        EvdevForward,       // Kernel timestamp -> forwarded by uinput
+        X11Dispatch,        // Dequeued -> callback queued
+        CallbackStart,      // Origin -> callback running, any hotkey
+        Count
+    };
+
+    static const char *StageName(Stage stage);
+
+    void Record(Stage stage, std::chrono::nanoseconds latency) {
+        stages[static_cast<size_t>(stage)].Record(latency);
+    }
+
+    // Origin to callback start for hotkey `id`
+    void RecordHotkey(int id, std::chrono::nanoseconds latency);
+
+    // Drop the histogram of a hotkey that was removed
+    void ForgetHotkey(int id);
+
+    // One line per stage and per hotkey that fired:
+    //   <name> count=<n> p50=<us> p99=<us> p999=<us> max=<us>
+    // `hotkeyName` turns an id into its alias.
+    std::string Report(const std::function<std::string(int)> &hotkeyName) const;
+
+    void Reset();
+
+private:
+    LatencyHistogram stages[static_cast<size_t>(Stage::Count)];
+    mutable std::mutex hotkeysMutex;
+    // Shared so a record in flight survives ForgetHotkey
+    std::unordered_map<int, std::shared_ptr<LatencyHistogram>> hotkeys;
+};
+
+} // namespace havel
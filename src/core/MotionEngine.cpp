@@ -0,0 +1,163 @@
+#include "MotionEngine.hpp"
+#include "../utils/Logger.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace havel {
+
+static double Ease(MotionEngine::Easing easing, double t) {
+    switch (easing) {
+        case MotionEngine::Easing::EaseIn:
+            return t * t;
+        case MotionEngine::Easing::EaseOut:
+            return 1.0 - (1.0 - t) * (1.0 - t);
+        case MotionEngine::Easing::EaseInOut:
+            return t * t * (3.0 - 2.0 * t);
+        case MotionEngine::Easing::Linear:
+        default:
+            return t;
+    }
+}
+
+MotionEngine::MotionEngine(Emitter emitter, std::chrono::microseconds tickLength)
+    : emit(std::move(emitter)), tick(tickLength) {
+    if (tick <= std::chrono::microseconds::zero()) {
+        tick = std::chrono::microseconds(1000);
+    }
+    thread = std::thread(&MotionEngine::Loop, this);
+}
+
+MotionEngine::~MotionEngine() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cv.notify_all();
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+std::future<bool> MotionEngine::Start(const Motion &motion) {
+    Job job;
+    job.motion = motion;
+    auto result = job.done.get_future();
+
+    // Quadratic Bezier from the origin to the target, bowed sideways
+    // around the midpoint
+    job.controlX = motion.dx / 2.0 - motion.dy * motion.curvature;
+    job.controlY = motion.dy / 2.0 + motion.dx * motion.curvature;
+    job.ticks = std::max<long long>(
+        1, std::chrono::duration_cast<std::chrono::microseconds>(motion.duration) / tick);
+    job.start = Clock::now();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (stopping) {
+        job.done.set_value(false);
+        return result;
+    }
+    active.push_back(std::move(job));
+    cv.notify_one();
+    return result;
+}
+
+void MotionEngine::Cancel() {
+    std::lock_guard<std::mutex> lock(mutex);
+    FailAll(active);
+}
+
+bool MotionEngine::Busy() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !active.empty();
+}
+
+void MotionEngine::FailAll(std::vector<Job> &jobs) {
+    for (auto &job : jobs) {
+        job.done.set_value(false);
+    }
+    jobs.clear();
+}
+
+bool MotionEngine::Advance(Job &job, Clock::time_point now, int &stepX, int &stepY) const {
+    // Follow the clock: after a late wakeup jump to where the pointer
+    // should be now instead of replaying the missed ticks
+    long long due = std::clamp<long long>((now - job.start) / tick, 0, job.ticks);
+    if (due == 0) {
+        return false;
+    }
+
+    int x = job.motion.dx;
+    int y = job.motion.dy;
+    if (due < job.ticks) {
+        double u = Ease(job.motion.easing, static_cast<double>(due) / job.ticks);
+        double a = 2.0 * (1.0 - u) * u;
+        double b = u * u;
+        x = static_cast<int>(std::lround(a * job.controlX + b * job.motion.dx));
+        y = static_cast<int>(std::lround(a * job.controlY + b * job.motion.dy));
+    }
+
+    stepX += x - job.sentX;
+    stepY += y - job.sentY;
+    job.sentX = x;
+    job.sentY = y;
+    return due == job.ticks;
+}
+
+void MotionEngine::Loop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        cv.wait(lock, [this] { return stopping || !active.empty(); });
+        if (stopping) {
+            break;
+        }
+
+        auto deadline = Clock::now() + tick;
+        while (!active.empty()) {
+            // Start() notifies too; only stopping ends the tick early
+            if (cv.wait_until(lock, deadline, [this] { return stopping; })) {
+                break;
+            }
+
+            auto now = Clock::now();
+            int stepX = 0;
+            int stepY = 0;
+            std::vector<Job> finished;
+            for (auto it = active.begin(); it != active.end();) {
+                if (Advance(*it, now, stepX, stepY)) {
+                    finished.push_back(std::move(*it));
+                    it = active.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+
+            bool ok = true;
+            if (stepX != 0 || stepY != 0) {
+                lock.unlock();
+                try {
+                    ok = emit(stepX, stepY);
+                } catch (const std::exception &e) {
+                    lo.error("Error in mouse motion: " + std::string(e.what()));
+                    ok = false;
+                }
+                lock.lock();
+            }
+
+            for (auto &job : finished) {
+                job.done.set_value(ok);
+            }
+            if (!ok) {
+                FailAll(active);
+            }
+
+            deadline += tick;
+            if (deadline < now) {
+                deadline = now + tick;
+            }
+        }
+    }
+
+    FailAll(active);
+}
+
+} // namespace havel
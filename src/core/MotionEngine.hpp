@@ -0,0 +1,93 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace havel {
+
+// Moves the pointer along a curve on a dedicated thread.
+//
+// A motion is a relative offset covered over a duration. The thread emits
+// one relative step per tick (1 kHz by default) against absolute
+// deadlines. Positions along the path are computed in floating point and
+// only the whole-pixel difference to what was already emitted is sent,
+// so rounding never accumulates and the motion ends exactly on target.
+//
+// Motions started while others are playing are added to them, each
+// following its own clock, the way two threads writing steps to the
+// pointer would combine; every tick emits their summed step.
+class MotionEngine {
+public:
+    enum class Easing {
+        Linear,
+        EaseIn,
+        EaseOut,
+        EaseInOut
+    };
+
+    struct Motion {
+        int dx = 0;
+        int dy = 0;
+        std::chrono::milliseconds duration{100};
+        Easing easing = Easing::EaseInOut;
+        // Bow of the quadratic Bezier path, as a fraction of the distance,
+        // to the left of the direction of travel; 0 is a straight line
+        float curvature = 0.0f;
+    };
+
+    // Writes one relative pointer step; returns false on failure
+    using Emitter = std::function<bool(int dx, int dy)>;
+
+    explicit MotionEngine(Emitter emit,
+                          std::chrono::microseconds tick = std::chrono::microseconds(1000));
+    ~MotionEngine();
+
+    MotionEngine(const MotionEngine&) = delete;
+    MotionEngine& operator=(const MotionEngine&) = delete;
+
+    // Start `motion` alongside whatever is playing. The future is true
+    // once the full offset was emitted, false if it was cancelled or a
+    // write failed.
+    std::future<bool> Start(const Motion &motion);
+
+    // Stop every motion after the step in flight
+    void Cancel();
+
+    bool Busy() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Job {
+        Motion motion;
+        std::promise<bool> done;
+        Clock::time_point start;
+        long long ticks = 1;
+        double controlX = 0.0;
+        double controlY = 0.0;
+        int sentX = 0;
+        int sentY = 0;
+    };
+
+    void Loop();
+    // Adds the whole-pixel step `job` owes at `now` to `stepX`/`stepY`;
+    // returns true once the job reached its target
+    bool Advance(Job &job, Clock::time_point now, int &stepX, int &stepY) const;
+    void FailAll(std::vector<Job> &jobs);
+
+    Emitter emit;
+    std::chrono::microseconds tick;
+
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<Job> active;
+    bool stopping = false;
+    std::thread thread;
+};
+
+} // namespace havel
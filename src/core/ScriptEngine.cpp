@@ -35,6 +35,8 @@ void ScriptEngine::RegisterFunctions() {
 }
 
 bool ScriptEngine::LoadScript(const std::string& filename) {
+    // Hotkeys the script registers go live together when it finishes
+    IO::HotkeyBatch batch;
     try {
         lua.script_file(filename);
         return true;
@@ -45,6 +47,7 @@ bool ScriptEngine::LoadScript(const std::string& filename) {
 }
 
 bool ScriptEngine::ExecuteString(const std::string& code) {
+    IO::HotkeyBatch batch;
     try {
         lua.script(code);
         return true;
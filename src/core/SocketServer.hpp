@@ -5,6 +5,8 @@
 #include <sys/un.h>
 #include <unistd.h>
 #include <atomic>
+#include <cerrno>
+#include <cstring>
 
 namespace havel {
 
@@ -20,6 +22,13 @@ public:
     
 protected:
     virtual void HandleCommand(const std::string& cmd) = 0;
+
+    // Commands that answer override this; the returned text is written
+    // back to the client before the connection is closed
+    virtual std::string HandleRequest(const std::string& cmd) {
+        HandleCommand(cmd);
+        return {};
+    }
     
 private:
     void ServerThread();
@@ -53,7 +62,15 @@ private:
             ssize_t count = read(client, buffer, sizeof(buffer)-1);
             if (count > 0) {
                 buffer[count] = '\0';
-                HandleCommand(buffer);
+                std::string reply = HandleRequest(buffer);
+                for (size_t sent = 0; sent < reply.size();) {
+                    // MSG_NOSIGNAL: a client that hung up must not kill us with SIGPIPE
+                    ssize_t n = send(client, reply.data() + sent, reply.size() - sent,
+                                     MSG_NOSIGNAL);
+                    if (n < 0 && errno == EINTR) continue;
+                    if (n <= 0) break;
+                    sent += static_cast<size_t>(n);
+                }
             }
             close(client);
         }
@@ -0,0 +1,273 @@
+#include "TextTyper.hpp"
+#include "UinputFrame.hpp"
+#include "../utils/Logger.hpp"
+#include <X11/extensions/XTest.h>
+#include <cstdio>
+#include <optional>
+#include <thread>
+
+namespace havel {
+
+// Invalid sequences decode to U+FFFD, which no layout types, so such text
+// ends up being pasted rather than mistyped
+static std::u32string DecodeUtf8(std::string_view text) {
+    std::u32string out;
+    out.reserve(text.size());
+
+    size_t i = 0;
+    while (i < text.size()) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        char32_t cp;
+        size_t extra;
+        if (c < 0x80) {
+            cp = c;
+            extra = 0;
+        } else if ((c & 0xe0) == 0xc0) {
+            cp = c & 0x1f;
+            extra = 1;
+        } else if ((c & 0xf0) == 0xe0) {
+            cp = c & 0x0f;
+            extra = 2;
+        } else if ((c & 0xf8) == 0xf0) {
+            cp = c & 0x07;
+            extra = 3;
+        } else {
+            out.push_back(0xfffd);
+            ++i;
+            continue;
+        }
+
+        if (i + extra >= text.size()) {
+            out.push_back(0xfffd);
+            break;
+        }
+        bool valid = true;
+        for (size_t k = 1; k <= extra; ++k) {
+            unsigned char next = static_cast<unsigned char>(text[i + k]);
+            if ((next & 0xc0) != 0x80) {
+                valid = false;
+                break;
+            }
+            cp = (cp << 6) | (next & 0x3f);
+        }
+        if (!valid) {
+            out.push_back(0xfffd);
+            ++i;
+            continue;
+        }
+        out.push_back(cp);
+        i += extra + 1;
+    }
+    return out;
+}
+
+TextTyper::TextTyper() : TextTyper(Options{}) {
+}
+
+TextTyper::TextTyper(Options opts) : options(std::move(opts)) {
+    if (options.charsPerFrame == 0) {
+        options.charsPerFrame = 1;
+    }
+}
+
+bool TextTyper::Type(Display *display, int uinputFd, std::string_view text) {
+    if (text.empty()) {
+        return true;
+    }
+    return Type(display, uinputFd, text, *KeymapTable::Get(display));
+}
+
+bool TextTyper::Type(Display *display, int uinputFd, std::string_view text,
+                     const KeymapTable &keymap) {
+    if (text.empty()) {
+        return true;
+    }
+    if (uinputFd < 0 && !display) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(typeMutex);
+
+    if (options.clipboardThreshold && text.size() > options.clipboardThreshold) {
+        return Paste(display, uinputFd, text, keymap);
+    }
+
+    std::u32string chars = DecodeUtf8(text);
+    for (char32_t cp : chars) {
+        if (!keymap.Find(cp)) {
+            // The layout cannot type all of it; paste the whole text so it
+            // arrives in one piece
+            return Paste(display, uinputFd, text, keymap);
+        }
+    }
+    return TypeStrokes(display, uinputFd, chars, keymap);
+}
+
+bool TextTyper::TypeStrokes(Display *display, int uinputFd,
+                            const std::u32string &chars,
+                            const KeymapTable &table) {
+    using Clock = std::chrono::steady_clock;
+
+    UinputFrame frame;
+    bool ok = true;
+    auto emit = [&](uint16_t code, bool down) {
+        if (uinputFd >= 0) {
+            frame.Key(code, down ? 1 : 0);
+            frame.Sync();
+        } else {
+            XTestFakeKeyEvent(display, code + EvdevKeycodeOffset, down, CurrentTime);
+        }
+    };
+    auto flush = [&]() {
+        if (uinputFd >= 0) {
+            ok = frame.Flush(uinputFd) && ok;
+        } else {
+            XFlush(display);
+        }
+    };
+
+    // Modifiers stay down across consecutive characters that need them
+    bool shiftDown = false;
+    bool altGrDown = false;
+    size_t inFrame = 0;
+    auto deadline = Clock::now();
+
+    for (char32_t cp : chars) {
+        const KeymapTable::Stroke *stroke = table.Find(cp);
+
+        // Worst case: both modifiers change, plus press and release
+        if (frame.Size() + 8 > UinputFrame::Capacity) {
+            flush();
+        }
+        if (stroke->shift != shiftDown) {
+            shiftDown = stroke->shift;
+            emit(table.ShiftCode(), shiftDown);
+        }
+        if (stroke->altGr != altGrDown) {
+            altGrDown = stroke->altGr;
+            emit(table.AltGrCode(), altGrDown);
+        }
+        emit(stroke->code, true);
+        emit(stroke->code, false);
+
+        if (++inFrame == options.charsPerFrame) {
+            flush();
+            inFrame = 0;
+            // Pace against absolute deadlines; after a stall start over
+            // rather than bursting to catch up
+            deadline += options.framePeriod;
+            auto now = Clock::now();
+            if (deadline < now - options.framePeriod) {
+                deadline = now;
+            }
+            std::this_thread::sleep_until(deadline);
+        }
+    }
+
+    if (shiftDown) emit(table.ShiftCode(), false);
+    if (altGrDown) emit(table.AltGrCode(), false);
+    flush();
+    return ok;
+}
+
+// Everything `command` prints, or nothing if it fails
+static std::optional<std::string> ReadCommand(const std::string &command) {
+    FILE *pipe = popen(command.c_str(), "r");
+    if (!pipe) {
+        return std::nullopt;
+    }
+    std::string out;
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), pipe)) > 0) {
+        out.append(buffer, n);
+    }
+    if (pclose(pipe) != 0) {
+        return std::nullopt;
+    }
+    return out;
+}
+
+static bool WriteCommand(const std::string &command, std::string_view text) {
+    FILE *pipe = popen(command.c_str(), "w");
+    if (!pipe) {
+        lo.error("Typing: cannot run " + command);
+        return false;
+    }
+    size_t written = fwrite(text.data(), 1, text.size(), pipe);
+    int status = pclose(pipe);
+    if (written != text.size() || status != 0) {
+        lo.error("Typing: " + command + " failed");
+        return false;
+    }
+    return true;
+}
+
+// Wait until the clipboard command's process has taken the selection,
+// rather than guessing how long it takes
+static void WaitForClipboardOwner(Display *display, ::Window previous) {
+    constexpr auto step = std::chrono::milliseconds(2);
+    constexpr auto limit = std::chrono::milliseconds(500);
+    if (!display) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        return;
+    }
+    Atom clipboard = XInternAtom(display, "CLIPBOARD", False);
+    for (auto waited = std::chrono::milliseconds(0); waited < limit; waited += step) {
+        ::Window owner = XGetSelectionOwner(display, clipboard);
+        if (owner != None && owner != previous) {
+            return;
+        }
+        std::this_thread::sleep_for(step);
+    }
+    lo.warning("Typing: clipboard owner did not change, pasting anyway");
+}
+
+bool TextTyper::Paste(Display *display, int uinputFd, std::string_view text,
+                      const KeymapTable &keymap) {
+    std::optional<std::string> saved;
+    if (!options.clipboardReadCommand.empty()) {
+        saved = ReadCommand(options.clipboardReadCommand);
+    }
+    ::Window previousOwner = None;
+    if (display) {
+        previousOwner = XGetSelectionOwner(display, XInternAtom(display, "CLIPBOARD", False));
+    }
+
+    if (!WriteCommand(options.clipboardCommand, text)) {
+        return false;
+    }
+    WaitForClipboardOwner(display, previousOwner);
+
+    // Ctrl+V, with V looked up in the layout in case it is not QWERTY
+    const KeymapTable::Stroke *v = keymap.Find(U'v');
+    uint16_t vCode = v ? v->code : KEY_V;
+
+    bool ok = true;
+    if (uinputFd >= 0) {
+        UinputFrame frame;
+        frame.Key(KEY_LEFTCTRL, 1);
+        frame.Sync();
+        frame.Key(vCode, 1);
+        frame.Sync();
+        frame.Key(vCode, 0);
+        frame.Sync();
+        frame.Key(KEY_LEFTCTRL, 0);
+        ok = frame.Flush(uinputFd);
+    } else {
+        XTestFakeKeyEvent(display, KEY_LEFTCTRL + EvdevKeycodeOffset, True, CurrentTime);
+        XTestFakeKeyEvent(display, vCode + EvdevKeycodeOffset, True, CurrentTime);
+        XTestFakeKeyEvent(display, vCode + EvdevKeycodeOffset, False, CurrentTime);
+        XTestFakeKeyEvent(display, KEY_LEFTCTRL + EvdevKeycodeOffset, False, CurrentTime);
+        XFlush(display);
+    }
+
+    // Put back what the user had copied once the paste has been read
+    if (saved) {
+        std::this_thread::sleep_for(options.clipboardRestoreDelay);
+        WriteCommand(options.clipboardCommand, *saved);
+    }
+    return ok;
+}
+
+} // namespace havel
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "KeymapTable.hpp"
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace havel {
+
+// Types text fast. Characters are resolved to key strokes through the
+// shared KeymapTable and written to uinput a few characters per frame, paced
+// against absolute deadlines so the X server's input queue never
+// overflows. Text the layout cannot type, and optionally text long enough
+// that pacing it would be slow, is put on the clipboard and pasted
+// instead; the previous clipboard contents are put back afterwards.
+class TextTyper {
+public:
+    struct Options {
+        // Characters per uinput write. A character is four events, more
+        // when a modifier changes, and evdev client buffers can be as
+        // small as 64 events.
+        size_t charsPerFrame = 8;
+        std::chrono::microseconds framePeriod{1000};
+        // Texts longer than this (in bytes) are pasted; 0 never pastes.
+        // Typing this much at the defaults takes about 30 ms.
+        size_t clipboardThreshold = 256;
+        // Reads the text to place on the clipboard from stdin
+        std::string clipboardCommand = "xclip -selection clipboard";
+        // Prints the current clipboard, saved before pasting and restored
+        // after; empty leaves the pasted text on the clipboard
+        std::string clipboardReadCommand = "xclip -selection clipboard -o";
+        // How long the target application gets to read the pasted text
+        // before the saved clipboard is put back
+        std::chrono::milliseconds clipboardRestoreDelay{300};
+    };
+
+    TextTyper();
+    explicit TextTyper(Options options);
+
+    // Type UTF-8 `text`. Uses uinput when `uinputFd` is valid, XTest on
+    // `display` otherwise. Returns false if nothing could be sent.
+    bool Type(Display *display, int uinputFd, std::string_view text);
+    // The same with the strokes of `keymap` instead of the shared table
+    bool Type(Display *display, int uinputFd, std::string_view text,
+              const KeymapTable &keymap);
+
+    const Options &GetOptions() const { return options; }
+
+private:
+    bool TypeStrokes(Display *display, int uinputFd, const std::u32string &chars,
+                     const KeymapTable &keymap);
+    bool Paste(Display *display, int uinputFd, std::string_view text,
+               const KeymapTable &keymap);
+
+    Options options;
+    std::mutex typeMutex;  // One text at a time, or they would interleave
+};
+
+} // namespace havel
@@ -0,0 +1,224 @@
+#include "TimerService.hpp"
+#include "../utils/Logger.hpp"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+namespace havel {
+
+TimerService& TimerService::Get() {
+    static TimerService instance;
+    return instance;
+}
+
+TimerService::TimerService() {
+    timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (timerFd < 0) {
+        throw std::runtime_error("timerfd_create failed: " +
+                                 std::string(strerror(errno)));
+    }
+    thread = std::thread(&TimerService::Loop, this);
+}
+
+TimerService::~TimerService() {
+    Shutdown();
+}
+
+TimerService::TimerId TimerService::After(std::chrono::milliseconds delay,
+                                          Callback callback) {
+    return Schedule(Clock::now() + delay, Clock::duration::zero(),
+                    std::move(callback));
+}
+
+TimerService::TimerId TimerService::Every(std::chrono::milliseconds period,
+                                          Callback callback,
+                                          std::chrono::milliseconds initialDelay) {
+    // A zero period would spin the timer thread
+    if (period <= std::chrono::milliseconds::zero()) {
+        period = std::chrono::milliseconds(1);
+    }
+    return Schedule(Clock::now() + initialDelay, period, std::move(callback));
+}
+
+TimerService::TimerId TimerService::Schedule(Clock::time_point deadline,
+                                             Clock::duration period,
+                                             Callback callback) {
+    if (!callback) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (stopping) {
+        return 0;
+    }
+    TimerId id = nextId++;
+    timers.emplace(id, Timer{std::make_shared<const Callback>(std::move(callback)),
+                             period});
+    queue.push(Due{deadline, id});
+    Arm();
+    return id;
+}
+
+bool TimerService::Cancel(TimerId id) {
+    if (id == 0) {
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    bool found = timers.erase(id) > 0;
+    // A callback cancelling its own timer must not wait for itself
+    if (std::this_thread::get_id() != thread.get_id()) {
+        callbackDone.wait(lock, [this, id] { return runningId != id; });
+    }
+    return found;
+}
+
+TimerService::TimerId TimerService::Current() const {
+    // Only the timer thread writes runningId, so it can read it unlocked
+    if (std::this_thread::get_id() != thread.get_id()) {
+        return 0;
+    }
+    return runningId;
+}
+
+bool TimerService::Active(TimerId id) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return timers.count(id) > 0;
+}
+
+size_t TimerService::Pending() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return timers.size();
+}
+
+void TimerService::Arm() {
+    Clock::time_point next = queue.empty() ? Clock::time_point::max()
+                                           : queue.top().deadline;
+    if (next == armedFor) {
+        return;
+    }
+    armedFor = next;
+
+    // All zero disarms the timerfd
+    itimerspec spec{};
+    if (next != Clock::time_point::max()) {
+        // steady_clock is CLOCK_MONOTONIC; a deadline in the past fires at once
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            next.time_since_epoch()).count();
+        if (ns <= 0) ns = 1;
+        spec.it_value.tv_sec = ns / 1000000000;
+        spec.it_value.tv_nsec = ns % 1000000000;
+    }
+    if (timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &spec, nullptr) < 0) {
+        lo.error("timerfd_settime failed: " + std::string(strerror(errno)));
+    }
+}
+
+void TimerService::Loop() {
+    struct Ready {
+        TimerId id;
+        std::shared_ptr<const Callback> callback;
+        bool oneShot;
+    };
+    std::vector<Ready> ready;
+
+    while (true) {
+        uint64_t expirations;
+        if (read(timerFd, &expirations, sizeof(expirations)) < 0 &&
+            errno != EINTR) {
+            lo.error("Timer thread read failed: " + std::string(strerror(errno)));
+            return;
+        }
+
+        ready.clear();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping) {
+                return;
+            }
+
+            auto now = Clock::now();
+            armedFor = Clock::time_point::max(); // The timerfd has fired
+            while (!queue.empty() && queue.top().deadline <= now) {
+                Due due = queue.top();
+                queue.pop();
+                auto it = timers.find(due.id);
+                if (it == timers.end()) {
+                    continue; // Cancelled
+                }
+                const Timer &timer = it->second;
+                bool oneShot = timer.period == Clock::duration::zero();
+                ready.push_back(Ready{due.id, timer.callback, oneShot});
+
+                if (!oneShot) {
+                    // Next deadline follows from the previous one, skipping
+                    // any periods we are already past
+                    auto next = due.deadline + timer.period;
+                    if (next <= now) {
+                        next += timer.period * ((now - next) / timer.period + 1);
+                    }
+                    queue.push(Due{next, due.id});
+                }
+            }
+            Arm();
+        }
+
+        for (const auto &job : ready) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (stopping) {
+                    return;
+                }
+                // An earlier callback in this batch may have cancelled it
+                if (!timers.count(job.id)) {
+                    continue;
+                }
+                runningId = job.id;
+            }
+
+            try {
+                (*job.callback)();
+            } catch (const std::exception &e) {
+                lo.error("Error in timer callback: " + std::string(e.what()));
+            } catch (...) {
+                lo.error("Unknown error in timer callback");
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                runningId = 0;
+                if (job.oneShot) {
+                    timers.erase(job.id);
+                }
+            }
+            callbackDone.notify_all();
+        }
+    }
+}
+
+void TimerService::Shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) {
+            return;
+        }
+        stopping = true;
+        timers.clear();
+
+        // Fire right away so the thread wakes up and sees `stopping`
+        itimerspec spec{};
+        spec.it_value.tv_nsec = 1;
+        timerfd_settime(timerFd, 0, &spec, nullptr);
+    }
+
+    if (thread.joinable()) {
+        thread.join();
+    }
+    callbackDone.notify_all();
+    close(timerFd);
+    timerFd = -1;
+}
+
+} // namespace havel
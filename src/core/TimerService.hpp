@@ -0,0 +1,99 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace havel {
+
+// One thread that runs every timer in the process.
+//
+// Deadlines are kept in a min-heap and the earliest one is armed on a
+// timerfd, so the thread sleeps in the kernel until something is due.
+// Periodic timers are rescheduled from their previous deadline rather than
+// from when the callback returned, so they do not drift; if a callback
+// overruns, the missed periods are skipped instead of fired in a burst.
+//
+// Callbacks run on the timer thread and must not block. Anything slow
+// belongs on a worker.
+class TimerService {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimerId = uint64_t;
+    using Callback = std::function<void()>;
+
+    // Process-wide instance, started on first use
+    static TimerService& Get();
+
+    TimerService();
+    ~TimerService();
+
+    TimerService(const TimerService&) = delete;
+    TimerService& operator=(const TimerService&) = delete;
+
+    // Run `callback` once after `delay`
+    TimerId After(std::chrono::milliseconds delay, Callback callback);
+
+    // Run `callback` every `period`, the first time after `initialDelay`
+    TimerId Every(std::chrono::milliseconds period, Callback callback,
+                  std::chrono::milliseconds initialDelay);
+    TimerId Every(std::chrono::milliseconds period, Callback callback) {
+        return Every(period, std::move(callback), period);
+    }
+
+    // Stop a timer. If its callback is running, wait for it to return
+    // unless called from the timer thread. False if it was not scheduled.
+    bool Cancel(TimerId id);
+
+    // Inside a callback, the id of the timer it belongs to, already valid on
+    // the first tick; 0 on any other thread
+    TimerId Current() const;
+
+    bool Active(TimerId id) const;
+    size_t Pending() const;
+
+    // Stop the thread; pending timers are dropped
+    void Shutdown();
+
+private:
+    struct Timer {
+        std::shared_ptr<const Callback> callback;
+        Clock::duration period; // Zero for one-shot timers
+    };
+
+    struct Due {
+        Clock::time_point deadline;
+        TimerId id;
+        bool operator>(const Due &other) const {
+            return deadline != other.deadline ? deadline > other.deadline
+                                              : id > other.id;
+        }
+    };
+
+    TimerId Schedule(Clock::time_point deadline, Clock::duration period,
+                     Callback callback);
+    // Point the timerfd at the earliest deadline; mutex must be held
+    void Arm();
+    void Loop();
+
+    mutable std::mutex mutex;
+    std::condition_variable callbackDone;
+    // May hold entries of cancelled timers; they are skipped when popped
+    std::priority_queue<Due, std::vector<Due>, std::greater<>> queue;
+    std::unordered_map<TimerId, Timer> timers;
+    TimerId nextId = 1;
+    TimerId runningId = 0;
+    Clock::time_point armedFor = Clock::time_point::max();
+    int timerFd = -1;
+    bool stopping = false;
+    std::thread thread;
+};
+
+} // namespace havel
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <linux/input.h>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <unistd.h>
+
+namespace havel {
+
+// Events for one or more uinput reports, collected on the stack and
+// submitted with a single write(). Besides saving syscalls this keeps a
+// report from interleaving with one written concurrently by another thread.
+class UinputFrame {
+public:
+    static constexpr size_t Capacity = 64;
+
+    // Called after every write with the number of events in it; lets the
+    // trace see uinput traffic without this header depending on it
+    using FlushHook = void (*)(size_t events);
+    static void SetFlushHook(FlushHook hook) { flushHook.store(hook, std::memory_order_relaxed); }
+
+    bool Key(int code, int value) { return Add(EV_KEY, code, value); }
+    bool Rel(int code, int value) { return Add(EV_REL, code, value); }
+
+    // End the current report; more reports may follow in the same frame
+    bool Sync() { return Add(EV_SYN, SYN_REPORT, 0); }
+
+    bool Empty() const { return count == 0; }
+    size_t Size() const { return count; }
+
+    // Write everything collected so far, closing the last report if needed.
+    // The frame is empty afterwards even if the write failed.
+    bool Flush(int fd) {
+        if (count == 0) {
+            return true;
+        }
+        if (!IsSyncReport(events[count - 1])) {
+            Sync();
+        }
+
+        const size_t bytes = count * sizeof(input_event);
+        count = 0;
+        if (fd < 0) {
+            return false;
+        }
+        ssize_t written;
+        do {
+            written = write(fd, events, bytes);
+        } while (written < 0 && errno == EINTR);
+        if (FlushHook hook = flushHook.load(std::memory_order_relaxed)) {
+            hook(bytes / sizeof(input_event));
+        }
+        return written == static_cast<ssize_t>(bytes);
+    }
+
+private:
+    static bool IsSyncReport(const input_event &ev) {
+        return ev.type == EV_SYN && ev.code == SYN_REPORT;
+    }
+
+    bool Add(int type, int code, int value) {
+        // Keep the last slot free for the closing SYN_REPORT
+        if (count >= Capacity - 1 && type != EV_SYN) {
+            return false;
+        }
+        if (count >= Capacity) {
+            return false;
+        }
+        input_event &ev = events[count++];
+        ev = {};
+        ev.type = static_cast<__u16>(type);
+        ev.code = static_cast<__u16>(code);
+        ev.value = value;
+        return true;
+    }
+
+    input_event events[Capacity];
+    size_t count = 0;
+
+    static inline std::atomic<FlushHook> flushHook{nullptr};
+};
+
+} // namespace havel
@@ -0,0 +1,78 @@
+#include "WindowClassifier.hpp"
+#include <sstream>
+
+namespace havel {
+
+WindowClassifier::WindowClassifier(const Rules &rules)
+    : contains(rules.contains),
+      exact(rules.exact.begin(), rules.exact.end()) {
+}
+
+bool WindowClassifier::Matches(std::string_view windowClass) const {
+    if (windowClass.empty()) {
+        return false;
+    }
+    return contains.Contains(windowClass) || exact.count(std::string(windowClass));
+}
+
+std::vector<std::string> WindowClassifier::SplitList(const std::string &list) {
+    std::vector<std::string> items;
+    std::istringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        // Trim whitespace
+        item.erase(0, item.find_first_not_of(" \t"));
+        item.erase(item.find_last_not_of(" \t") + 1);
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+std::string WindowClassifier::JoinList(const std::vector<std::string> &items) {
+    std::string list;
+    for (const auto &item : items) {
+        if (!list.empty()) list += ",";
+        list += item;
+    }
+    return list;
+}
+
+WindowClassifier::Rules WindowClassifier::DefaultGamingRules() {
+    Rules rules;
+    rules.contains = {
+        "steam_app_default", // Steam games
+        "retroarch",         // RetroArch emulator
+        "ryujinx",           // Nintendo Switch emulator
+        "pcsx2",             // PlayStation 2 emulator
+        "dolphin-emu",       // GameCube/Wii emulator
+        "rpcs3",             // PlayStation 3 emulator
+        "cemu",              // Wii U emulator
+        "yuzu",              // Another Switch emulator
+        "duckstation",       // PlayStation 1 emulator
+        "ppsspp",            // PSP emulator
+        "xemu",              // Original Xbox emulator
+        "wine",              // Wine (Windows games on Linux)
+        "lutris",            // Lutris game launcher
+        "heroic",            // Epic Games launcher for Linux
+        "gamescope",         // Valve's gaming compositor
+        "games",             // Generic games category
+        "minecraft",
+        "nierautomata"
+    };
+    rules.exact = {
+        "Minecraft",
+        "minecraft-launcher",
+        "factorio",
+        "stardew_valley",
+        "terraria",
+        "dota2",
+        "csgo",
+        "goggalaxy",         // GOG Galaxy
+        "MangoHud"           // Often used with games
+    };
+    return rules;
+}
+
+} // namespace havel
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "../utils/AhoCorasick.hpp"
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace havel {
+
+// Decides whether a window belongs to a class of applications, e.g. games,
+// from its WM_CLASS.
+//
+// Substring rules are compiled into one Aho-Corasick automaton and exact
+// rules into a hash set, so a lookup is a single pass over the class name
+// whatever the number of rules. That pass is cheap enough for every focus
+// change, so answers are not cached.
+class WindowClassifier {
+public:
+    struct Rules {
+        // Matched anywhere in the class, ignoring ASCII case
+        std::vector<std::string> contains;
+        // Matched against the whole class, case-sensitively
+        std::vector<std::string> exact;
+    };
+
+    explicit WindowClassifier(const Rules &rules);
+
+    bool Matches(std::string_view windowClass) const;
+
+    // Comma separated lists, as rules are written in the config
+    static std::vector<std::string> SplitList(const std::string &list);
+    static std::string JoinList(const std::vector<std::string> &items);
+
+    // What HotkeyManager::isGamingWindow recognized before it was configurable
+    static Rules DefaultGamingRules();
+
+private:
+    AhoCorasick contains;
+    std::unordered_set<std::string> exact;
+};
+
+} // namespace havel
@@ -7,14 +7,19 @@
 #include "core/ConfigManager.hpp"
 #include "core/ScriptEngine.hpp"
 #include <csignal>
+#include <cstdlib>
+#include <filesystem>
 #include "core/HotkeyManager.hpp"
 // #include "media/MPVController.hpp"  // Comment out this include since we already have core/MPVController.hpp
 #include "core/SocketServer.hpp"
+#include "core/FlightRecorder.hpp"
+#include "core/UinputFrame.hpp"
 #include "core/AutoClicker.hpp"
 #include "core/EmergencySystem.hpp"
 #include "core/SequenceDetector.hpp"
 #include "utils/Notifier.hpp"
 #include "window/WindowRules.hpp"
+#include "window/WindowMonitor.hpp"
 #include "core/MouseGesture.hpp"
 #include "core/MacroSystem.hpp"
 
@@ -53,10 +58,35 @@ void SignalHandler(int signal) {
 
 using namespace havel;
 
+// Where traces go unless Trace.DumpDir says otherwise. They can hold
+// recent hotkeys and, with Trace.KeyCodes, keystrokes, so never a shared
+// directory: the session's runtime dir, else ~/.local/state
+static std::string DefaultTraceDir() {
+    if (const char* runtime = std::getenv("XDG_RUNTIME_DIR"); runtime && *runtime) {
+        return runtime;
+    }
+    const char* home = std::getenv("HOME");
+    std::string dir = std::string(home ? home : ".") + "/.local/state";
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    return dir;
+}
+
 // Simple socket server for external control
 class AppServer : public SocketServer {
 public:
-    AppServer(int port) : SocketServer(port) {}
+    AppServer(int port, IO& io) : SocketServer(port), io(io) {}
+
+    std::string HandleRequest(const std::string& request) override {
+        std::string cmd = request.substr(0, request.find_last_not_of(" \r\n") + 1);
+        if (cmd == "latency") return io.LatencyReport();
+        if (cmd == "latency_reset") {
+            io.ResetLatency();
+            return "ok\n";
+        }
+        HandleCommand(request);
+        return {};
+    }
     
     void HandleCommand(const std::string& cmd) override {
         lo.debug("Socket command received: " + cmd);
@@ -65,15 +95,38 @@ public:
             int vol = std::stoi(cmd.substr(7));
             AdjustVolume(vol);
         }
+        else if (cmd.find("trace_dump") == 0) {
+            // trace_dump[:name]. Anyone who can reach the socket may ask
+            // for a dump, so it only ever lands in Trace.DumpDir, under a
+            // plain file name
+            std::string name = cmd.size() > 11 && cmd[10] == ':'
+                ? cmd.substr(11)
+                : "havel-" + std::to_string(getpid()) + ".trace";
+            name.erase(name.find_last_not_of(" \r\n") + 1);
+            if (name.empty() || name[0] == '.' || name.find('/') != std::string::npos) {
+                lo.error("trace_dump: invalid file name " + name);
+                return;
+            }
+            std::string path =
+                Configs::Get().Get<std::string>("Trace.DumpDir", DefaultTraceDir()) + "/" + name;
+            if (FlightRecorder::Dump(path))
+                lo.info("Trace written to " + path);
+            else
+                lo.error("Cannot write trace to " + path);
+        }
     }
     
     void ToggleMute() { /* ... */ }
     void AdjustVolume(int) { /* ... */ }
+
+private:
+    IO& io;
 };
 void print_hotkeys() {
     static int counter = 0;
     counter++;
     lo.info("Hotkeys " + std::to_string(counter));
+    std::lock_guard<std::mutex> lock(IO::hotkeyWriteMutex);
     for (const auto& [id, hotkey] : IO::hotkeys) {
         lo.info("Hotkey ID: " + std::to_string(id) + ", alias: " + hotkey.alias + ", keycode: " + std::to_string(hotkey.key) + ", modifiers: " + std::to_string(hotkey.modifiers) + ", action: " + hotkey.action + ", enabled: " + std::to_string(hotkey.enabled) + ", blockInput: " + std::to_string(hotkey.blockInput) + ", exclusive: " + std::to_string(hotkey.exclusive) + ", success: " + std::to_string(hotkey.success) + ", suspend: " + std::to_string(hotkey.suspend));
     }
@@ -99,6 +152,20 @@ int main(int argc, char* argv[]) {
         // Load configuration
         auto& config = Configs::Get();
         config.Load("config.json");
+
+        // Keep log I/O off the input threads
+        lo.setAsync(config.Get<bool>("Logging.Async", true));
+
+        FlightRecorder::SetEnabled(config.Get<bool>("Trace.Enabled", true));
+        FlightRecorder::SetRecordKeyCodes(config.Get<bool>("Trace.KeyCodes", false));
+        std::string crashDump = config.Get<std::string>(
+            "Trace.CrashDump", DefaultTraceDir() + "/havel-crash.trace");
+        if (!FlightRecorder::InstallCrashHandler(crashDump)) {
+            lo.warning("Cannot prepare crash trace " + crashDump);
+        }
+        UinputFrame::SetFlushHook([](size_t events) {
+            FlightRecorder::Record(TraceEvent::UinputEmitted, -1, static_cast<int>(events));
+        });
         
         // Create IO manager
         auto io = std::make_shared<IO>();
@@ -143,8 +210,21 @@ int main(int argc, char* argv[]) {
         int moveSpeed = config.Get<int>("Window.MoveSpeed", 10);
         // windowManager->SetMoveSpeed(moveSpeed);
         
+        // Follow the active window from X events instead of polling it
+        WindowMonitor windowMonitor;
+        if (config.Get<bool>("Window.TrackEvents", true)) {
+            windowMonitor.SetActiveWindowCallback([&hotkeyManager](const WindowInfo& info) {
+                hotkeyManager->onActiveWindowChanged(info);
+            });
+            try {
+                windowMonitor.Start();
+            } catch (const WindowMonitorError& e) {
+                lo.warning(std::string("Window events unavailable, polling instead: ") + e.what());
+            }
+        }
+
         // Start socket server for external control
-        AppServer server(config.Get<int>("Network.Port", 8765));
+        AppServer server(config.Get<int>("Network.Port", 8765), *io);
         server.Start();
         
         // Watch for theme changes
@@ -204,6 +284,7 @@ int main(int argc, char* argv[]) {
         // Cleanup
         lo.info("Stopping server...");
         server.Stop();
+        windowMonitor.Stop();
         
         lo.info("Shutting down HvC...");
         
@@ -24,24 +24,19 @@ void AutoRunner::start(const std::string& dir) {
     // Press and hold the key
     io.Send(direction);
 
-    // Start monitoring thread
-    runnerThread = std::thread([this]() {
-        while (running) {
-            // Keep checking if window changed, etc.
-            if (!HotkeyManager::isGamingWindow()) {
-                stop();
-                break;
-            }
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    // Keep checking if window changed, etc.
+    monitorTimer = TimerService::Get().Every(std::chrono::milliseconds(100), [this]() {
+        if (!HotkeyManager::isGamingWindow()) {
+            stop();
         }
     });
-    runnerThread.detach();
 }
 
 void AutoRunner::stop() {
-    if (!running) return;
+    if (!running.exchange(false)) return;
 
-    running = false;
+    TimerService::Get().Cancel(monitorTimer);
+    monitorTimer = 0;
 
     // Release the key
     io.Send(direction + " up");
@@ -1,8 +1,9 @@
 #ifndef AUTORUNNER_H
 #define AUTORUNNER_H
 
+#include <atomic>
 #include <string>
-#include <thread>
+#include "../core/TimerService.hpp"
 
 namespace havel {
     class IO; // Forward declaration
@@ -10,8 +11,8 @@ namespace havel {
 
     class AutoRunner {
     private:
-        bool running;
-        std::thread runnerThread;
+        std::atomic<bool> running;
+        TimerService::TimerId monitorTimer = 0;
         IO& io;
         std::string direction;
 
@@ -0,0 +1,135 @@
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <string>
+#include "../core/ConditionCache.hpp"
+
+using namespace havel;
+
+// Test framework macros
+#define TEST_ASSERT(condition) do { \
+    if (!(condition)) { \
+        std::cerr << "ASSERTION FAILED: " << #condition << " at " << __FILE__ << ":" << __LINE__ << std::endl; \
+        return false; \
+    } \
+} while(0)
+
+#define RUN_TEST(test_func) do { \
+    std::cout << "Running test: " << #test_func << "... "; \
+    bool result = test_func(); \
+    if (result) { \
+        std::cout << "PASSED" << std::endl; \
+        passed_tests++; \
+    } else { \
+        std::cout << "FAILED" << std::endl; \
+        failed_tests++; \
+    } \
+    total_tests++; \
+} while(0)
+
+int passed_tests = 0;
+int failed_tests = 0;
+int total_tests = 0;
+
+bool test_cached_until_invalidated() {
+    std::atomic<bool> gaming{false};
+    ConditionCache cache([&](const CompiledCondition &) { return gaming.load(); });
+
+    auto entry = cache.Add("currentMode == 'gaming'");
+    TEST_ASSERT(cache.Add("currentMode == 'gaming'") == entry);
+
+    TEST_ASSERT(!cache.Resolve(*entry));
+    TEST_ASSERT(cache.Evaluations() == 1);
+
+    // The context changed but nobody said so: still the cached answer
+    gaming = true;
+    for (int i = 0; i < 100; ++i) {
+        TEST_ASSERT(!cache.Resolve(*entry));
+    }
+    TEST_ASSERT(cache.Evaluations() == 1);
+
+    cache.Invalidate();
+    TEST_ASSERT(cache.Resolve(*entry));
+    TEST_ASSERT(cache.Resolve(*entry));
+    TEST_ASSERT(cache.Evaluations() == 2);
+    return true;
+}
+
+bool test_negation_and_refresh() {
+    ConditionFacts facts;
+    facts.title = "mpv - video.mkv";
+    ConditionCache cache([&](const CompiledCondition &condition) {
+        return condition.Evaluate(facts);
+    });
+
+    TEST_ASSERT(!cache.Needs(CompiledCondition::NeedsTitle));
+    cache.Add("Window.Active(name:mpv)");
+    cache.Add("!Window.Active(name:mpv)");
+    cache.Add("IsZooming");
+    TEST_ASSERT(cache.Needs(CompiledCondition::NeedsTitle));
+    TEST_ASSERT(!cache.Needs(CompiledCondition::NeedsExe));
+
+    int reported = 0;
+    bool ok = true;
+    cache.Refresh([&](const CompiledCondition &condition, bool met) {
+        ++reported;
+        if (condition.Text() == "Window.Active(name:mpv)") ok = ok && met;
+        if (condition.Text() == "!Window.Active(name:mpv)") ok = ok && !met;
+        if (condition.Text() == "IsZooming") ok = ok && !met;
+    });
+    TEST_ASSERT(reported == 3);
+    TEST_ASSERT(ok);
+    TEST_ASSERT(cache.Evaluations() == 3);
+
+    // Nothing stale, so refreshing evaluates nothing
+    cache.Refresh();
+    TEST_ASSERT(cache.Evaluations() == 3);
+    TEST_ASSERT(cache.Resolve("!Window.Active(name:mpv)") == false);
+    return true;
+}
+
+bool test_concurrent_resolve() {
+    std::atomic<int> value{0};
+    ConditionCache cache([&](const CompiledCondition &) { return value.load() % 2 == 1; });
+    auto entry = cache.Add("IsZooming");
+
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&] {
+            while (!stop.load()) {
+                cache.Resolve(*entry);
+            }
+        });
+    }
+    for (int i = 1; i <= 1000; ++i) {
+        value = i;
+        cache.Invalidate();
+    }
+    stop = true;
+    for (auto &reader : readers) reader.join();
+
+    // Whatever raced with the last invalidation, the answer settles on the
+    // final context
+    TEST_ASSERT(cache.Resolve(*entry) == false);
+    value = 1001;
+    cache.Invalidate();
+    TEST_ASSERT(cache.Resolve(*entry) == true);
+    return true;
+}
+
+int main() {
+    std::cout << "Starting condition cache tests..." << std::endl;
+
+    RUN_TEST(test_cached_until_invalidated);
+    RUN_TEST(test_negation_and_refresh);
+    RUN_TEST(test_concurrent_resolve);
+
+    std::cout << "\nTest Summary:" << std::endl;
+    std::cout << "  Total tests: " << total_tests << std::endl;
+    std::cout << "  Passed: " << passed_tests << std::endl;
+    std::cout << "  Failed: " << failed_tests << std::endl;
+
+    return failed_tests > 0 ? 1 : 0;
+}
@@ -0,0 +1,214 @@
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include "../core/ConditionExpr.hpp"
+
+using namespace havel;
+
+// Test framework macros
+#define TEST_ASSERT(condition) do { \
+    if (!(condition)) { \
+        std::cerr << "ASSERTION FAILED: " << #condition << " at " << __FILE__ << ":" << __LINE__ << std::endl; \
+        return false; \
+    } \
+} while(0)
+
+#define RUN_TEST(test_func) do { \
+    std::cout << "Running test: " << #test_func << "... "; \
+    bool result = test_func(); \
+    if (result) { \
+        std::cout << "PASSED" << std::endl; \
+        passed_tests++; \
+    } else { \
+        std::cout << "FAILED" << std::endl; \
+        failed_tests++; \
+    } \
+    total_tests++; \
+} while(0)
+
+int passed_tests = 0;
+int failed_tests = 0;
+int total_tests = 0;
+
+static std::unordered_map<std::string, std::string> variables = {
+    {"profile", "work"},
+    {"paused", "1"},
+    {"muted", "0"},
+};
+
+static ConditionFacts Facts() {
+    ConditionFacts facts;
+    facts.className = "firefox";
+    facts.title = "Lofi Beats - YouTube - Mozilla Firefox";
+    facts.exe = "firefox-bin";
+    facts.mode = "default";
+    facts.variables = &variables;
+    return facts;
+}
+
+static bool Eval(const std::string &text, const ConditionFacts &facts = Facts()) {
+    return CompiledCondition::Compile(text).Evaluate(facts);
+}
+
+bool test_legacy_forms() {
+    auto facts = Facts();
+    TEST_ASSERT(Eval("Window.Active(class:fire)", facts));
+    TEST_ASSERT(Eval("Window.Active('class:firefox')", facts));
+    TEST_ASSERT(!Eval("Window.Active(class:mpv)", facts));
+    TEST_ASSERT(Eval("Window.Active(name:YouTube)", facts));
+    TEST_ASSERT(Eval("Window.Active('title:Lofi')", facts));
+    TEST_ASSERT(Eval("Window.Active(Mozilla)", facts));
+    TEST_ASSERT(!Eval("!Window.Active(Mozilla)", facts));
+
+    // Quoted text may hold parentheses
+    facts.title = "Foo (1) - Editor";
+    TEST_ASSERT(Eval("Window.Active('name:Foo (1)')", facts));
+    TEST_ASSERT(Eval("Window.Active( \"title:(1)\" ) && class ~ 'fire'", facts));
+    TEST_ASSERT(!Eval("Window.Active('name:Foo (2)')", facts));
+    facts = Facts();
+
+    TEST_ASSERT(!Eval("currentMode == 'gaming'", facts));
+    facts.mode = "gaming";
+    TEST_ASSERT(Eval("currentMode == 'gaming'", facts));
+
+    TEST_ASSERT(!Eval("IsZooming", facts));
+    facts.zooming = true;
+    TEST_ASSERT(Eval("IsZooming", facts));
+    TEST_ASSERT(!Eval("!IsZooming", facts));
+    return true;
+}
+
+bool test_operators() {
+    TEST_ASSERT(Eval("class == 'firefox' && exe == \"firefox-bin\""));
+    TEST_ASSERT(Eval("class == 'mpv' || title ~ 'YouTube'"));
+    TEST_ASSERT(Eval("class != 'mpv' and not (mode == 'gaming')"));
+    TEST_ASSERT(Eval("title =~ '^Lofi.*(YouTube|Twitch)'"));
+    TEST_ASSERT(Eval("title !~ 'Netflix'"));
+    TEST_ASSERT(!Eval("title =~ '^YouTube'"));
+    // And binds tighter than or
+    TEST_ASSERT(Eval("class == 'x' && mode == 'x' || exe ~ 'fire'"));
+    TEST_ASSERT(!Eval("class == 'x' && (mode == 'x' || exe ~ 'fire')"));
+    return true;
+}
+
+bool test_variables() {
+    TEST_ASSERT(Eval("$profile == 'work'"));
+    TEST_ASSERT(Eval("$paused"));
+    TEST_ASSERT(!Eval("$muted"));
+    TEST_ASSERT(!Eval("$missing"));
+    TEST_ASSERT(Eval("$missing == ''"));
+    TEST_ASSERT(Eval("$paused == 1 && !$muted"));
+
+    ConditionFacts none = Facts();
+    none.variables = nullptr;
+    TEST_ASSERT(!Eval("$profile == 'work'", none));
+    return true;
+}
+
+bool test_constant_folding() {
+    auto folded = CompiledCondition::Compile("true || class == 'mpv'");
+    TEST_ASSERT(folded.Ok());
+    TEST_ASSERT(folded.Constant() == std::optional<bool>(true));
+
+    auto never = CompiledCondition::Compile("!(1 == 1) && title =~ 'x'");
+    TEST_ASSERT(never.Constant() == std::optional<bool>(false));
+
+    auto reduced = CompiledCondition::Compile("true && !!(class == 'firefox')");
+    TEST_ASSERT(!reduced.Constant().has_value());
+    TEST_ASSERT(reduced.Evaluate(Facts()));
+
+    // Nested ands are flattened into one node
+    auto flat = CompiledCondition::Compile("(class ~ 'a' && (exe ~ 'b' && mode ~ 'c')) && $x");
+    TEST_ASSERT(!flat.Constant().has_value());
+    TEST_ASSERT(flat.Needs() == (CompiledCondition::NeedsExe | CompiledCondition::NeedsMode));
+
+    auto title = CompiledCondition::Compile("title ~ 'x' || exe ~ 'y'");
+    TEST_ASSERT(title.Needs() == (CompiledCondition::NeedsTitle | CompiledCondition::NeedsExe));
+    // Folded away, so the title is not needed after all
+    TEST_ASSERT(CompiledCondition::Compile("false && title ~ 'x'").Needs() == 0);
+
+    // Either spelling of the mode, however it is compared
+    for (const char *text : {"currentMode == 'gaming'", "mode == 'gaming'",
+                             "!(mode != 'gaming') && class ~ 'x'"}) {
+        TEST_ASSERT(CompiledCondition::Compile(text).Needs() & CompiledCondition::NeedsMode);
+    }
+    TEST_ASSERT(!(CompiledCondition::Compile("Window.Active(mpv)").Needs() &
+                  CompiledCondition::NeedsMode));
+    return true;
+}
+
+bool test_errors() {
+    const char *bad[] = {
+        "",
+        "class ==",
+        "class == 'unterminated",
+        "(class == 'x'",
+        "class == 'x')",
+        "nonsense",
+        "title",
+        "title =~ '('",
+        "title =~ class",
+        "class == 'x' &&",
+        "Window.Active(class:x",
+        "Window.Active('name:x (1)'",
+        "Window.Active('name:x)",
+    };
+    for (const char *text : bad) {
+        auto compiled = CompiledCondition::Compile(text);
+        if (compiled.Ok()) {
+            std::cerr << "accepted: " << text << std::endl;
+            return false;
+        }
+        TEST_ASSERT(!compiled.Evaluate(Facts()));
+        TEST_ASSERT(compiled.Text() == text);
+    }
+    return true;
+}
+
+bool test_bounds() {
+    std::string deep(CompiledCondition::MaxDepth + 5, '(');
+    deep += "true";
+    deep += std::string(CompiledCondition::MaxDepth + 5, ')');
+    TEST_ASSERT(!CompiledCondition::Compile(deep).Ok());
+
+    std::string nots(CompiledCondition::MaxDepth + 5, '!');
+    TEST_ASSERT(!CompiledCondition::Compile(nots + "IsZooming").Ok());
+
+    std::string wide = "class == '0'";
+    for (size_t i = 1; i < CompiledCondition::MaxNodes * 2; ++i) {
+        wide += " || class == '" + std::to_string(i) + "'";
+    }
+    auto tooWide = CompiledCondition::Compile(wide);
+    TEST_ASSERT(!tooWide.Ok());
+
+    auto fits = CompiledCondition::Compile("class == '1' || class == '2' || class == '3'");
+    TEST_ASSERT(fits.Ok());
+    TEST_ASSERT(fits.Size() <= CompiledCondition::MaxNodes);
+
+    // Only the first MaxSubject bytes of a long title are searched
+    std::string title(CompiledCondition::MaxSubject + 100, 'a');
+    title += "needle";
+    ConditionFacts facts = Facts();
+    facts.title = title;
+    TEST_ASSERT(!Eval("title =~ 'needle'", facts));
+    TEST_ASSERT(Eval("title ~ 'needle'", facts));
+    return true;
+}
+
+int main() {
+    std::cout << "Starting condition expression tests..." << std::endl;
+
+    RUN_TEST(test_legacy_forms);
+    RUN_TEST(test_operators);
+    RUN_TEST(test_variables);
+    RUN_TEST(test_constant_folding);
+    RUN_TEST(test_errors);
+    RUN_TEST(test_bounds);
+
+    std::cout << "\nTest Summary:" << std::endl;
+    std::cout << "  Total tests: " << total_tests << std::endl;
+    std::cout << "  Passed: " << passed_tests << std::endl;
+    std::cout << "  Failed: " << failed_tests << std::endl;
+
+    return failed_tests > 0 ? 1 : 0;
+}
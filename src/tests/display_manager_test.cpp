@@ -0,0 +1,112 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <X11/Xlib.h>
+#include "../core/DisplayManager.hpp"
+
+using namespace havel;
+
+// Test framework macros
+#define TEST_ASSERT(condition) do { \
+    if (!(condition)) { \
+        std::cerr << "ASSERTION FAILED: " << #condition << " at " << __FILE__ << ":" << __LINE__ << std::endl; \
+        return false; \
+    } \
+} while(0)
+
+#define RUN_TEST(test_func) do { \
+    std::cout << "Running test: " << #test_func << "... "; \
+    bool result = test_func(); \
+    if (result) { \
+        std::cout << "PASSED" << std::endl; \
+        passed_tests++; \
+    } else { \
+        std::cout << "FAILED" << std::endl; \
+        failed_tests++; \
+    } \
+    total_tests++; \
+} while(0)
+
+int passed_tests = 0;
+int failed_tests = 0;
+int total_tests = 0;
+
+bool test_one_connection_per_thread() {
+    Display* mine = DisplayManager::GetThreadDisplay();
+    TEST_ASSERT(mine != nullptr);
+    TEST_ASSERT(DisplayManager::GetThreadDisplay() == mine);
+    TEST_ASSERT(mine != DisplayManager::GetDisplay());
+    size_t open = DisplayManager::ThreadDisplayCount();
+
+    Display* other = nullptr;
+    size_t openDuring = 0;
+    std::thread worker([&]() {
+        other = DisplayManager::GetThreadDisplay();
+        openDuring = DisplayManager::ThreadDisplayCount();
+    });
+    worker.join();
+
+    TEST_ASSERT(other != nullptr);
+    TEST_ASSERT(openDuring == open + 1);
+    // Closed when the worker exited
+    TEST_ASSERT(DisplayManager::ThreadDisplayCount() == open);
+    return true;
+}
+
+bool test_atoms_match_xlib() {
+    Display* display = DisplayManager::GetThreadDisplay();
+    TEST_ASSERT(display != nullptr);
+
+    Atom first = DisplayManager::InternAtom(display, "_NET_ACTIVE_WINDOW");
+    TEST_ASSERT(first != None);
+    TEST_ASSERT(DisplayManager::InternAtom(display, "_NET_ACTIVE_WINDOW") == first);
+    TEST_ASSERT(XInternAtom(display, "_NET_ACTIVE_WINDOW", False) == first);
+
+    // Connections that are not the thread's go straight to Xlib
+    Display* shared = DisplayManager::GetDisplay();
+    TEST_ASSERT(DisplayManager::InternAtom(shared, "_NET_ACTIVE_WINDOW") == first);
+
+    // A mix of cached and new names
+    const char* names[] = {"_NET_ACTIVE_WINDOW", "_NET_WM_PID", "UTF8_STRING"};
+    Atom atoms[3] = {};
+    DisplayManager::InternAtoms(display, names, 3, false, atoms);
+    TEST_ASSERT(atoms[0] == first);
+    TEST_ASSERT(atoms[1] == XInternAtom(display, "_NET_WM_PID", False));
+    TEST_ASSERT(atoms[2] == XInternAtom(display, "UTF8_STRING", False));
+    return true;
+}
+
+// A missing atom is looked up again, so it is found once someone creates it
+bool test_missing_atoms_not_cached() {
+    Display* display = DisplayManager::GetThreadDisplay();
+    TEST_ASSERT(display != nullptr);
+
+    std::string name = "_HAVEL_TEST_" + std::to_string(getpid());
+    TEST_ASSERT(DisplayManager::InternAtom(display, name, true) == None);
+    Atom created = XInternAtom(DisplayManager::GetDisplay(), name.c_str(), False);
+    TEST_ASSERT(created != None);
+    TEST_ASSERT(DisplayManager::InternAtom(display, name, true) == created);
+    return true;
+}
+
+int main() {
+    std::cout << "Starting display manager tests..." << std::endl;
+
+    DisplayManager::Initialize();
+    if (!DisplayManager::IsInitialized()) {
+        std::cout << "No X display, skipping" << std::endl;
+        return 0;
+    }
+
+    RUN_TEST(test_one_connection_per_thread);
+    RUN_TEST(test_atoms_match_xlib);
+    RUN_TEST(test_missing_atoms_not_cached);
+
+    std::cout << "\nTest Summary:" << std::endl;
+    std::cout << "  Total tests: " << total_tests << std::endl;
+    std::cout << "  Passed: " << passed_tests << std::endl;
+    std::cout << "  Failed: " << failed_tests << std::endl;
+
+    return failed_tests > 0 ? 1 : 0;
+}
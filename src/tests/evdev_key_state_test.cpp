@@ -0,0 +1,97 @@
+#include <iostream>
+#include <X11/Xlib.h>
+#include "../core/EvdevKeyState.hpp"
+
+// Test framework macros
+#define TEST_ASSERT(condition) do { \
+    if (!(condition)) { \
+        std::cerr << "ASSERTION FAILED: " << #condition << " at " << __FILE__ << ":" << __LINE__ << std::endl; \
+        return false; \
+    } \
+} while(0)
+
+#define RUN_TEST(test_func) do { \
+    std::cout << "Running test: " << #test_func << "... "; \
+    bool result = test_func(); \
+    if (result) { \
+        std::cout << "PASSED" << std::endl; \
+        passed_tests++; \
+    } else { \
+        std::cout << "FAILED" << std::endl; \
+        failed_tests++; \
+    } \
+    total_tests++; \
+} while(0)
+
+int passed_tests = 0;
+int failed_tests = 0;
+int total_tests = 0;
+
+// Set reports the previous state so callers can spot repeats
+bool test_set_returns_previous() {
+    havel::EvdevKeyState state;
+    TEST_ASSERT(state.Set(KEY_A, true) == false);
+    TEST_ASSERT(state.Set(KEY_A, true) == true);
+    TEST_ASSERT(state.IsDown(KEY_A));
+    TEST_ASSERT(state.Set(KEY_A, false) == true);
+    TEST_ASSERT(!state.IsDown(KEY_A));
+    return true;
+}
+
+// Either side sets the modifier bit; it clears only when both are up
+bool test_modifier_mask_tracks_both_sides() {
+    havel::EvdevKeyState state;
+    state.Set(KEY_LEFTCTRL, true);
+    state.Set(KEY_RIGHTCTRL, true);
+    TEST_ASSERT(state.Modifiers() == ControlMask);
+
+    state.Set(KEY_LEFTCTRL, false);
+    TEST_ASSERT(state.Modifiers() == ControlMask);
+    state.Set(KEY_RIGHTCTRL, false);
+    TEST_ASSERT(state.Modifiers() == 0);
+
+    // Repeated releases must not underflow the count
+    state.Set(KEY_RIGHTCTRL, false);
+    state.Set(KEY_LEFTALT, true);
+    TEST_ASSERT(state.Modifiers() == Mod1Mask);
+    return true;
+}
+
+// Required modifiers must be held; extra held modifiers are fine
+bool test_matches() {
+    havel::EvdevKeyState state;
+    TEST_ASSERT(state.Matches(0));
+    TEST_ASSERT(!state.Matches(ControlMask));
+
+    state.Set(KEY_LEFTCTRL, true);
+    state.Set(KEY_LEFTMETA, true);
+    TEST_ASSERT(state.Matches(ControlMask));
+    TEST_ASSERT(state.Matches(ControlMask | Mod4Mask));
+    TEST_ASSERT(!state.Matches(ControlMask | ShiftMask));
+    return true;
+}
+
+// Out of range codes are ignored
+bool test_out_of_range_code() {
+    havel::EvdevKeyState state;
+    TEST_ASSERT(state.Set(KEY_CNT + 1, true) == false);
+    TEST_ASSERT(!state.IsDown(KEY_CNT + 1));
+    TEST_ASSERT(!state.IsDown(-1));
+    return true;
+}
+
+int main() {
+    std::cout << "Starting evdev key state tests..." << std::endl;
+
+    RUN_TEST(test_set_returns_previous);
+    RUN_TEST(test_modifier_mask_tracks_both_sides);
+    RUN_TEST(test_matches);
+    RUN_TEST(test_out_of_range_code);
+
+    std::cout << "\nTest Summary:" << std::endl;
+    std::cout << "  Total tests: " << total_tests << std::endl;
+    std::cout << "  Passed: " << passed_tests << std::endl;
+    std::cout << "  Failed: " << failed_tests << std::endl;
+
+    return failed_tests > 0 ? 1 : 0;
+}
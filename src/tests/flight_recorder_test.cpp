@@ -0,0 +1,226 @@
+#include <iostream>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <csignal>
+#include <cstring>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../core/FlightRecorder.hpp"
+
+// Test framework macros
+#define TEST_ASSERT(condition) do { \
+    if (!(condition)) { \
+        std::cerr << "ASSERTION FAILED: " << #condition << " at " << __FILE__ << ":" << __LINE__ << std::endl; \
+        return false; \
+    } \
+} while(0)
+
+#define RUN_TEST(test_func) do { \
+    std::cout << "Running test: " << #test_func << "... "; \
+    bool result = test_func(); \
+    if (result) { \
+        std::cout << "PASSED" << std::endl; \
+        passed_tests++; \
+    } else { \
+        std::cout << "FAILED" << std::endl; \
+        failed_tests++; \
+    } \
+    total_tests++; \
+} while(0)
+
+int passed_tests = 0;
+int failed_tests = 0;
+int total_tests = 0;
+
+using havel::FlightRecorder;
+using havel::TraceEvent;
+using havel::TraceRecord;
+
+static std::string dumpPath;
+
+static bool read_dump(std::vector<TraceRecord> &records,
+                      const std::string &path = dumpPath) {
+    std::ifstream file(path, std::ios::binary);
+    havel::TraceFileHeader header{};
+    if (!file.read(reinterpret_cast<char *>(&header), sizeof(header))) return false;
+    if (memcmp(header.magic, "HVTRACE", 8) != 0) return false;
+    if (header.recordSize != sizeof(TraceRecord)) return false;
+    records.resize(header.recordCount);
+    return static_cast<bool>(file.read(reinterpret_cast<char *>(records.data()),
+                                       records.size() * sizeof(TraceRecord)));
+}
+
+bool test_dump_contains_each_thread() {
+    FlightRecorder::Clear();
+    auto worker = [](int hotkey) {
+        FlightRecorder::Record(TraceEvent::CallbackStarted, hotkey);
+        FlightRecorder::Record(TraceEvent::CallbackFinished, hotkey, 1);
+    };
+    std::thread a(worker, 1);
+    std::thread b(worker, 2);
+    a.join();
+    b.join();
+
+    TEST_ASSERT(FlightRecorder::Dump(dumpPath));
+    std::vector<TraceRecord> records;
+    TEST_ASSERT(read_dump(records));
+    TEST_ASSERT(records.size() == 4);
+
+    for (int hotkey : {1, 2}) {
+        std::vector<TraceRecord> mine;
+        for (const auto &r : records) {
+            if (r.hotkey == hotkey) mine.push_back(r);
+        }
+        TEST_ASSERT(mine.size() == 2);
+        TEST_ASSERT(mine[0].event == static_cast<uint16_t>(TraceEvent::CallbackStarted));
+        TEST_ASSERT(mine[1].event == static_cast<uint16_t>(TraceEvent::CallbackFinished));
+        TEST_ASSERT(mine[0].thread == mine[1].thread);
+        TEST_ASSERT(mine[0].timeNs <= mine[1].timeNs);
+    }
+    return true;
+}
+
+bool test_ring_keeps_latest() {
+    FlightRecorder::Clear();
+    const int total = static_cast<int>(FlightRecorder::RingCapacity) + 100;
+    std::thread writer([total] {
+        for (int i = 0; i < total; ++i) {
+            FlightRecorder::Record(TraceEvent::KeyEvent, -1, i);
+        }
+    });
+    writer.join();
+
+    TEST_ASSERT(FlightRecorder::Dump(dumpPath));
+    std::vector<TraceRecord> records;
+    TEST_ASSERT(read_dump(records));
+    TEST_ASSERT(records.size() == FlightRecorder::RingCapacity);
+    TEST_ASSERT(records.front().arg == 100);
+    TEST_ASSERT(records.back().arg == total - 1);
+    return true;
+}
+
+bool test_disabled_records_nothing() {
+    FlightRecorder::Clear();
+    FlightRecorder::SetEnabled(false);
+    std::thread writer([] { FlightRecorder::Record(TraceEvent::KeyEvent, -1, 1); });
+    writer.join();
+    FlightRecorder::SetEnabled(true);
+
+    TEST_ASSERT(FlightRecorder::Dump(dumpPath));
+    std::vector<TraceRecord> records;
+    TEST_ASSERT(read_dump(records));
+    TEST_ASSERT(records.empty());
+    return true;
+}
+
+// The crash file is made up front and filled in by the handler
+// Key codes are only kept when asked for
+bool test_key_codes_opt_in() {
+    FlightRecorder::Clear();
+    std::thread writer([] {
+        FlightRecorder::RecordKey(30);
+        FlightRecorder::SetRecordKeyCodes(true);
+        FlightRecorder::RecordKey(31);
+        FlightRecorder::SetRecordKeyCodes(false);
+    });
+    writer.join();
+
+    TEST_ASSERT(FlightRecorder::Dump(dumpPath));
+    std::vector<TraceRecord> records;
+    TEST_ASSERT(read_dump(records));
+    TEST_ASSERT(records.size() == 2);
+    TEST_ASSERT(records[0].event == static_cast<uint16_t>(TraceEvent::KeyEvent));
+    TEST_ASSERT(records[0].arg == 0);
+    TEST_ASSERT(records[1].arg == 31);
+    return true;
+}
+
+bool test_crash_dump() {
+    std::string crashPath = dumpPath + ".crash";
+    pid_t child = fork();
+    TEST_ASSERT(child >= 0);
+    if (child == 0) {
+        FlightRecorder::Clear();
+        if (!FlightRecorder::InstallCrashHandler(crashPath)) _exit(2);
+        FlightRecorder::Record(TraceEvent::HotkeyMatched, 5);
+        FlightRecorder::Record(TraceEvent::CallbackStarted, 5);
+        abort();
+    }
+    int status = 0;
+    TEST_ASSERT(waitpid(child, &status, 0) == child);
+    TEST_ASSERT(WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT);
+
+    std::vector<TraceRecord> records;
+    bool read = read_dump(records, crashPath);
+    std::remove(crashPath.c_str());
+    TEST_ASSERT(read);
+    TEST_ASSERT(records.size() == 2);
+    TEST_ASSERT(records[0].event == static_cast<uint16_t>(TraceEvent::HotkeyMatched));
+    TEST_ASSERT(records[1].hotkey == 5);
+    return true;
+}
+
+// A dump never writes through a symlink planted at its path
+bool test_dump_replaces_symlink() {
+    std::string target = dumpPath + ".target";
+    std::string link = dumpPath + ".link";
+    { std::ofstream(target) << "keep"; }
+    TEST_ASSERT(symlink(target.c_str(), link.c_str()) == 0);
+
+    bool dumped = FlightRecorder::Dump(link);
+    struct stat st{};
+    bool replaced = lstat(link.c_str(), &st) == 0 && S_ISREG(st.st_mode);
+    std::string contents;
+    std::getline(std::ifstream(target), contents);
+    std::remove(link.c_str());
+    std::remove(target.c_str());
+    TEST_ASSERT(dumped);
+    TEST_ASSERT(replaced);
+    TEST_ASSERT(contents == "keep");
+    return true;
+}
+
+// A file someone left at the path is replaced, not written into, and the
+// dump is private whatever the old file's mode was
+bool test_dump_is_private() {
+    { std::ofstream(dumpPath) << "old"; }
+    TEST_ASSERT(chmod(dumpPath.c_str(), 0666) == 0);
+    // Holding the old file open keeps it around to check afterwards
+    std::ifstream old(dumpPath);
+
+    TEST_ASSERT(FlightRecorder::Dump(dumpPath));
+    struct stat st{};
+    TEST_ASSERT(stat(dumpPath.c_str(), &st) == 0);
+    TEST_ASSERT((st.st_mode & 0777) == 0600);
+    std::string contents;
+    std::getline(old, contents);
+    TEST_ASSERT(contents == "old");
+    return true;
+}
+
+int main() {
+    std::cout << "Starting flight recorder tests..." << std::endl;
+
+    dumpPath = "/tmp/havel_flight_recorder_test_" + std::to_string(getpid()) + ".trace";
+
+    RUN_TEST(test_dump_contains_each_thread);
+    RUN_TEST(test_ring_keeps_latest);
+    RUN_TEST(test_disabled_records_nothing);
+    RUN_TEST(test_key_codes_opt_in);
+    RUN_TEST(test_crash_dump);
+    RUN_TEST(test_dump_replaces_symlink);
+    RUN_TEST(test_dump_is_private);
+
+    std::remove(dumpPath.c_str());
+
+    std::cout << "\nTest Summary:" << std::endl;
+    std::cout << "  Total tests: " << total_tests << std::endl;
+    std::cout << "  Passed: " << passed_tests << std::endl;
+    std::cout << "  Failed: " << failed_tests << std::endl;
+
+    return failed_tests > 0 ? 1 : 0;
+}
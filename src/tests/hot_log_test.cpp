@@ -0,0 +1,134 @@
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
+#include "../utils/HotLog.hpp"
+#include "../utils/Logger.hpp"
+
+// Test framework macros
+#define TEST_ASSERT(condition) do { \
+    if (!(condition)) { \
+        std::cerr << "ASSERTION FAILED: " << #condition << " at " << __FILE__ << ":" << __LINE__ << std::endl; \
+        return false; \
+    } \
+} while(0)
+
+#define RUN_TEST(test_func) do { \
+    std::cout << "Running test: " << #test_func << "... "; \
+    bool result = test_func(); \
+    if (result) { \
+        std::cout << "PASSED" << std::endl; \
+        passed_tests++; \
+    } else { \
+        std::cout << "FAILED" << std::endl; \
+        failed_tests++; \
+    } \
+    total_tests++; \
+} while(0)
+
+int passed_tests = 0;
+int failed_tests = 0;
+int total_tests = 0;
+
+// Records are written by the Logger, to its log file
+static std::string logPath;
+
+static std::vector<std::string> read_lines() {
+    std::vector<std::string> lines;
+    std::ifstream file(logPath);
+    std::string line;
+    while (std::getline(file, line)) {
+        lines.push_back(line);
+    }
+    // Start the next test with an empty file
+    std::filesystem::resize_file(logPath, 0);
+    return lines;
+}
+
+static int evaluations = 0;
+static int counted(int value) {
+    ++evaluations;
+    return value;
+}
+
+bool test_disabled_skips_arguments() {
+    havel::HotLog::SetEnabled(false);
+    evaluations = 0;
+    HOT_LOG("value %d", counted(1));
+    TEST_ASSERT(evaluations == 0);
+    return true;
+}
+
+bool test_records_reach_output() {
+    havel::HotLog::SetEnabled(true);
+    HOT_LOG("Hotkey matched: %s (state: %u)", "^a", 4u);
+    havel::HotLog::Flush();
+    havel::HotLog::SetEnabled(false);
+
+    auto lines = read_lines();
+    TEST_ASSERT(lines.size() == 1);
+    TEST_ASSERT(lines[0].find("[hot] Hotkey matched: ^a (state: 4)") != std::string::npos);
+    return true;
+}
+
+bool test_concurrent_writers() {
+    constexpr int threads = 4;
+    constexpr int perThread = 200;  // Fits the ring even if the writer stalls
+    havel::HotLog::SetEnabled(true);
+
+    std::vector<std::thread> writers;
+    for (int t = 0; t < threads; ++t) {
+        writers.emplace_back([t] {
+            for (int i = 0; i < perThread; ++i) {
+                HOT_LOG("writer %d record %d", t, i);
+            }
+        });
+    }
+    for (auto &writer : writers) writer.join();
+    havel::HotLog::Flush();
+    havel::HotLog::SetEnabled(false);
+
+    auto lines = read_lines();
+    TEST_ASSERT(havel::HotLog::Dropped() == 0);
+    TEST_ASSERT(lines.size() == threads * perThread);
+
+    // Each writer's records come out in the order it wrote them
+    std::vector<int> next(threads, 0);
+    for (const auto &line : lines) {
+        int t = -1, i = -1;
+        const char *text = strstr(line.c_str(), "writer ");
+        TEST_ASSERT(text && sscanf(text, "writer %d record %d", &t, &i) == 2);
+        TEST_ASSERT(t >= 0 && t < threads);
+        TEST_ASSERT(i == next[t]);
+        ++next[t];
+    }
+    return true;
+}
+
+int main() {
+    std::cout << "Starting hot path log tests..." << std::endl;
+
+    logPath = "/tmp/havel_hot_log_test_" + std::to_string(getpid()) + ".log";
+    std::remove(logPath.c_str());
+    lo.setLogFile(logPath);
+
+    RUN_TEST(test_disabled_skips_arguments);
+#if HAVEL_HOT_LOG
+    RUN_TEST(test_records_reach_output);
+    RUN_TEST(test_concurrent_writers);
+#endif
+
+    std::cout << "\nTest Summary:" << std::endl;
+    std::cout << "  Total tests: " << total_tests << std::endl;
+    std::cout << "  Passed: " << passed_tests << std::endl;
+    std::cout << "  Failed: " << failed_tests << std::endl;
+
+    std::remove(logPath.c_str());
+    return failed_tests > 0 ? 1 : 0;
+}
@@ -0,0 +1,166 @@
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <algorithm>
+#include <functional>
+#include "../core/HotkeyExecutor.hpp"
+
+// Test framework macros
+#define TEST_ASSERT(condition) do { \
+    if (!(condition)) { \
+        std::cerr << "ASSERTION FAILED: " << #condition << " at " << __FILE__ << ":" << __LINE__ << std::endl; \
+        return false; \
+    } \
+} while(0)
+
+#define RUN_TEST(test_func) do { \
+    std::cout << "Running test: " << #test_func << "... "; \
+    bool result = test_func(); \
+    if (result) { \
+        std::cout << "PASSED" << std::endl; \
+        passed_tests++; \
+    } else { \
+        std::cout << "FAILED" << std::endl; \
+        failed_tests++; \
+    } \
+    total_tests++; \
+} while(0)
+
+int passed_tests = 0;
+int failed_tests = 0;
+int total_tests = 0;
+
+static bool wait_until(const std::function<bool()> &condition, int timeout_ms = 2000) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+// A serialized hotkey never runs concurrently with itself
+bool test_serialized_hotkey_does_not_overlap() {
+    havel::HotkeyExecutor executor({4, 64, havel::HotkeyExecutor::OverflowPolicy::Drop});
+    std::atomic<int> active{0};
+    std::atomic<int> maxActive{0};
+    std::atomic<int> runs{0};
+
+    for (int i = 0; i < 10; ++i) {
+        executor.Submit(1, [&]() {
+            int now = ++active;
+            maxActive = std::max(maxActive.load(), now);
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            --active;
+            ++runs;
+        });
+    }
+
+    TEST_ASSERT(wait_until([&] { return runs == 10; }));
+    TEST_ASSERT(maxActive == 1);
+    return true;
+}
+
+// Repeats of a busy hotkey fold into a single waiting invocation
+bool test_repeats_are_coalesced() {
+    havel::HotkeyExecutor executor({2, 64, havel::HotkeyExecutor::OverflowPolicy::Coalesce});
+    std::atomic<bool> release{false};
+    std::atomic<int> runs{0};
+
+    auto slow = [&]() {
+        while (!release) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ++runs;
+    };
+    for (int i = 0; i < 20; ++i) {
+        executor.Submit(7, slow);
+    }
+    release = true;
+
+    TEST_ASSERT(wait_until([&] { return executor.QueueDepth() == 0 && runs == 2; }));
+    auto stats = executor.Stats().at(7);
+    TEST_ASSERT(stats.submitted == 20);
+    TEST_ASSERT(stats.coalesced == 18);
+    return true;
+}
+
+// Jobs beyond the queue limit are dropped and counted
+bool test_queue_limit_drops() {
+    havel::HotkeyExecutor executor({1, 2, havel::HotkeyExecutor::OverflowPolicy::Drop});
+    std::atomic<bool> release{false};
+    std::atomic<int> runs{0};
+
+    executor.Submit(1, [&]() {
+        while (!release) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ++runs;
+    }, false);
+    TEST_ASSERT(wait_until([&] { return executor.QueueDepth() == 0; }));
+
+    int accepted = 0;
+    for (int i = 0; i < 5; ++i) {
+        if (executor.Submit(2 + i, [&]() { ++runs; }, false)) accepted++;
+    }
+    release = true;
+
+    TEST_ASSERT(accepted == 2);
+    TEST_ASSERT(wait_until([&] { return runs == 3; }));
+    return true;
+}
+
+// The start hook sees the time since the origin passed to Submit
+bool test_start_reports_origin() {
+    std::atomic<int> seenId{0};
+    std::atomic<long long> seenNs{0};
+    havel::HotkeyExecutor executor({1, 64, havel::HotkeyExecutor::OverflowPolicy::Drop},
+        [&](int id, std::chrono::nanoseconds sinceOrigin) {
+            seenNs = sinceOrigin.count();
+            seenId = id;
+        });
+
+    auto origin = havel::HotkeyExecutor::Clock::now() - std::chrono::milliseconds(50);
+    executor.Submit(7, [] {}, true, origin);
+
+    TEST_ASSERT(wait_until([&] { return seenId == 7; }));
+    TEST_ASSERT(seenNs >= std::chrono::nanoseconds(std::chrono::milliseconds(50)).count());
+    return true;
+}
+
+// Forgotten ids drop their stats, even with a run still in flight
+bool test_forget_drops_stats() {
+    havel::HotkeyExecutor executor({1, 64, havel::HotkeyExecutor::OverflowPolicy::Drop});
+    std::atomic<bool> release{false};
+    std::atomic<int> runs{0};
+
+    executor.Submit(-1, [&]() {
+        while (!release) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ++runs;
+    });
+    executor.Forget(-1);
+    release = true;
+
+    TEST_ASSERT(wait_until([&] { return runs == 1 && executor.QueueDepth() == 0; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    TEST_ASSERT(executor.Stats().count(-1) == 0);
+
+    // The id is usable again afterwards
+    executor.Submit(-1, [&]() { ++runs; });
+    TEST_ASSERT(wait_until([&] { return runs == 2; }));
+    return true;
+}
+
+int main() {
+    std::cout << "Starting hotkey executor tests..." << std::endl;
+
+    RUN_TEST(test_serialized_hotkey_does_not_overlap);
+    RUN_TEST(test_repeats_are_coalesced);
+    RUN_TEST(test_queue_limit_drops);
+    RUN_TEST(test_start_reports_origin);
+    RUN_TEST(test_forget_drops_stats);
+
+    std::cout << "\nTest Summary:" << std::endl;
+    std::cout << "  Total tests: " << total_tests << std::endl;
+    std::cout << "  Passed: " << passed_tests << std::endl;
+    std::cout << "  Failed: " << failed_tests << std::endl;
+
+    return failed_tests > 0 ? 1 : 0;
+}
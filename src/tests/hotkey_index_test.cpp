@@ -0,0 +1,134 @@
+#include <iostream>
+#include <X11/Xlib.h>
+#include "../core/IO.hpp"
+#include "../core/HotkeyIndex.hpp"
+
+// Test framework macros
+#define TEST_ASSERT(condition) do { \
+    if (!(condition)) { \
+        std::cerr << "ASSERTION FAILED: " << #condition << " at " << __FILE__ << ":" << __LINE__ << std::endl; \
+        return false; \
+    } \
+} while(0)
+
+#define RUN_TEST(test_func) do { \
+    std::cout << "Running test: " << #test_func << "... "; \
+    bool result = test_func(); \
+    if (result) { \
+        std::cout << "PASSED" << std::endl; \
+        passed_tests++; \
+    } else { \
+        std::cout << "FAILED" << std::endl; \
+        failed_tests++; \
+    } \
+    total_tests++; \
+} while(0)
+
+int passed_tests = 0;
+int failed_tests = 0;
+int total_tests = 0;
+
+static havel::HotKey make_hotkey(havel::Key key, int modifiers, bool evdev = false,
+                                 bool isKeyUp = false) {
+    havel::HotKey hk;
+    hk.key = key;
+    hk.modifiers = modifiers;
+    hk.evdev = evdev;
+    hk.isKeyUp = isKeyUp;
+    return hk;
+}
+
+// Exact lookup picks the hotkey with the matching mask only
+bool test_exact_lookup() {
+    havel::HotkeyIndex index;
+    index.Update(1, make_hotkey(38, 0));
+    index.Update(2, make_hotkey(38, ControlMask));
+    index.Update(3, make_hotkey(38, ControlMask | ShiftMask));
+
+    auto *plain = index.FindExact(havel::HotkeySource::X11, 38, false, 0);
+    auto *ctrl = index.FindExact(havel::HotkeySource::X11, 38, false, ControlMask);
+    auto *alt = index.FindExact(havel::HotkeySource::X11, 38, false, Mod1Mask);
+
+    TEST_ASSERT(plain && plain->id == 1);
+    TEST_ASSERT(ctrl && ctrl->id == 2);
+    TEST_ASSERT(alt == nullptr);
+    TEST_ASSERT(index.Size() == 3);
+    return true;
+}
+
+// Press, release and evdev hotkeys land in separate buckets
+bool test_buckets_are_separate() {
+    havel::HotkeyIndex index;
+    index.Update(1, make_hotkey(30, 0));
+    index.Update(2, make_hotkey(30, 0, false, true));
+    index.Update(3, make_hotkey(30, 0, true));
+
+    TEST_ASSERT(index.Candidates(havel::HotkeySource::X11, 30, false).size() == 1);
+    TEST_ASSERT(index.Candidates(havel::HotkeySource::X11, 30, true).size() == 1);
+    TEST_ASSERT(index.Candidates(havel::HotkeySource::Evdev, 30, false).size() == 1);
+    TEST_ASSERT(index.Candidates(havel::HotkeySource::Evdev, 30, true).empty());
+    TEST_ASSERT(index.FindExact(havel::HotkeySource::X11, 30, true, 0)->id == 2);
+    return true;
+}
+
+// Candidates come back sorted by modifier mask
+bool test_candidates_sorted() {
+    havel::HotkeyIndex index;
+    index.Update(1, make_hotkey(50, Mod4Mask, true));
+    index.Update(2, make_hotkey(50, 0, true));
+    index.Update(3, make_hotkey(50, ControlMask, true));
+
+    auto bucket = index.Candidates(havel::HotkeySource::Evdev, 50, false);
+    TEST_ASSERT(bucket.size() == 3);
+    TEST_ASSERT(bucket[0].modifiers <= bucket[1].modifiers);
+    TEST_ASSERT(bucket[1].modifiers <= bucket[2].modifiers);
+    return true;
+}
+
+// Disabling, re-keying and removing update only the affected bucket
+bool test_incremental_updates() {
+    havel::HotkeyIndex index;
+    auto hk = make_hotkey(40, 0);
+    index.Update(7, hk);
+
+    hk.enabled = false;
+    index.Update(7, hk);
+    TEST_ASSERT(index.FindExact(havel::HotkeySource::X11, 40, false, 0) == nullptr);
+    TEST_ASSERT(index.Size() == 0);
+
+    hk.enabled = true;
+    hk.key = 41;
+    index.Update(7, hk);
+    TEST_ASSERT(index.FindExact(havel::HotkeySource::X11, 40, false, 0) == nullptr);
+    TEST_ASSERT(index.FindExact(havel::HotkeySource::X11, 41, false, 0)->id == 7);
+
+    index.Remove(7);
+    TEST_ASSERT(index.Candidates(havel::HotkeySource::X11, 41, false).empty());
+    return true;
+}
+
+// Codes outside the table are ignored instead of indexing out of range
+bool test_out_of_range_code() {
+    havel::HotkeyIndex index;
+    index.Update(1, make_hotkey(KEY_CNT + 5, 0));
+    TEST_ASSERT(index.Size() == 0);
+    TEST_ASSERT(index.Candidates(havel::HotkeySource::X11, KEY_CNT + 5, false).empty());
+    return true;
+}
+
+int main() {
+    std::cout << "Starting hotkey index tests..." << std::endl;
+
+    RUN_TEST(test_exact_lookup);
+    RUN_TEST(test_buckets_are_separate);
+    RUN_TEST(test_candidates_sorted);
+    RUN_TEST(test_incremental_updates);
+    RUN_TEST(test_out_of_range_code);
+
+    std::cout << "\nTest Summary:" << std::endl;
+    std::cout << "  Total tests: " << total_tests << std::endl;
+    std::cout << "  Passed: " << passed_tests << std::endl;
+    std::cout << "  Failed: " << failed_tests << std::endl;
+
+    return failed_tests > 0 ? 1 : 0;
+}
@@ -0,0 +1,125 @@
+#include <iostream>
+#include <memory>
+#include <vector>
+#include <linux/input.h>
+#include <X11/keysym.h>
+#include "../core/KeymapTable.hpp"
+
+using namespace havel;
+
+// Test framework macros
+#define TEST_ASSERT(condition) do { \
+    if (!(condition)) { \
+        std::cerr << "ASSERTION FAILED: " << #condition << " at " << __FILE__ << ":" << __LINE__ << std::endl; \
+        return false; \
+    } \
+} while(0)
+
+#define RUN_TEST(test_func) do { \
+    std::cout << "Running test: " << #test_func << "... "; \
+    bool result = test_func(); \
+    if (result) { \
+        std::cout << "PASSED" << std::endl; \
+        passed_tests++; \
+    } else { \
+        std::cout << "FAILED" << std::endl; \
+        failed_tests++; \
+    } \
+    total_tests++; \
+} while(0)
+
+int passed_tests = 0;
+int failed_tests = 0;
+int total_tests = 0;
+
+// A small layout: keycode 20 + i types the i-th letter, shifted on level 1
+static std::shared_ptr<const KeymapTable> TestLayout() {
+    constexpr int minKeycode = 8;
+    std::vector<KeymapTable::Levels> levels(120 - minKeycode);
+    auto at = [&](int keycode) -> KeymapTable::Levels & { return levels[keycode - minKeycode]; };
+    for (KeySym i = 0; i < 10; ++i) {
+        at(20 + i) = {XK_a + i, XK_A + i, NoSymbol, NoSymbol};
+    }
+    // AltGr+e types the euro sign, as a Unicode keysym
+    at(24)[2] = 0x10020ac;
+    // 'a' again, but shifted on a higher keycode: the unshifted one wins
+    at(40) = {XK_Z, XK_a, NoSymbol, NoSymbol};
+    at(36) = {XK_Return, NoSymbol, NoSymbol, NoSymbol};
+    at(50) = {XK_Shift_L, NoSymbol, NoSymbol, NoSymbol};
+    at(108) = {XK_ISO_Level3_Shift, NoSymbol, NoSymbol, NoSymbol};
+    return KeymapTable::Build(minKeycode, levels);
+}
+
+bool test_character_strokes() {
+    auto table = TestLayout();
+
+    const KeymapTable::Stroke *a = table->Find(U'a');
+    TEST_ASSERT(a != nullptr);
+    TEST_ASSERT(a->code == 20 - EvdevKeycodeOffset);
+    TEST_ASSERT(!a->shift && !a->altGr);
+
+    const KeymapTable::Stroke *upper = table->Find(U'C');
+    TEST_ASSERT(upper != nullptr);
+    TEST_ASSERT(upper->code == 22 - EvdevKeycodeOffset);
+    TEST_ASSERT(upper->shift && !upper->altGr);
+
+    const KeymapTable::Stroke *euro = table->Find(U'\u20ac');
+    TEST_ASSERT(euro != nullptr);
+    TEST_ASSERT(euro->code == 24 - EvdevKeycodeOffset);
+    TEST_ASSERT(euro->altGr && !euro->shift);
+
+    const KeymapTable::Stroke *newline = table->Find(U'\n');
+    TEST_ASSERT(newline != nullptr && newline->code == 36 - EvdevKeycodeOffset);
+
+    TEST_ASSERT(table->Find(U'q') == nullptr);
+    TEST_ASSERT(table->Find(U'\u00e9') == nullptr);
+    return true;
+}
+
+bool test_modifier_codes() {
+    auto table = TestLayout();
+    TEST_ASSERT(table->ShiftCode() == 50 - EvdevKeycodeOffset);
+    TEST_ASSERT(table->AltGrCode() == 108 - EvdevKeycodeOffset);
+
+    // Without the modifier keys the usual evdev codes are used
+    auto bare = KeymapTable::Build(8, std::vector<KeymapTable::Levels>(4));
+    TEST_ASSERT(bare->ShiftCode() == KEY_LEFTSHIFT);
+    TEST_ASSERT(bare->AltGrCode() == KEY_RIGHTALT);
+    TEST_ASSERT(bare->CharacterCount() == 0);
+    return true;
+}
+
+bool test_keysym_lookups() {
+    auto table = TestLayout();
+    // The lowest level wins, then the lowest keycode
+    TEST_ASSERT(table->Keycode(XK_a) == 20);
+    TEST_ASSERT(table->Keycode(XK_A) == 20);
+    TEST_ASSERT(table->Keycode(XK_Z) == 40);
+    TEST_ASSERT(table->Keycode(XK_q) == 0);
+    TEST_ASSERT(table->Keysym(21) == XK_b);
+    TEST_ASSERT(table->Keysym(100) == NoSymbol);
+
+    TEST_ASSERT(table->FromName("Shift_L") == XK_Shift_L);
+    TEST_ASSERT(table->Name(XK_Return) == "Return");
+    TEST_ASSERT(table->Name(XK_q).empty());
+    TEST_ASSERT(table->Name(0x10020ac) == "U20AC");
+    TEST_ASSERT(table->FromName("U20AC") == 0x10020ac);
+    // Names the layout does not carry still resolve through Xlib
+    TEST_ASSERT(table->FromName("q") == XK_q);
+    return true;
+}
+
+int main() {
+    std::cout << "Starting keymap table tests..." << std::endl;
+
+    RUN_TEST(test_character_strokes);
+    RUN_TEST(test_modifier_codes);
+    RUN_TEST(test_keysym_lookups);
+
+    std::cout << "\nTest Summary:" << std::endl;
+    std::cout << "  Total tests: " << total_tests << std::endl;
+    std::cout << "  Passed: " << passed_tests << std::endl;
+    std::cout << "  Failed: " << failed_tests << std::endl;
+
+    return failed_tests > 0 ? 1 : 0;
+}
@@ -0,0 +1,126 @@
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <cmath>
+#include "../utils/LatencyHistogram.hpp"
+#include "../core/LatencyTracker.hpp"
+
+// Test framework macros
+#define TEST_ASSERT(condition) do { \
+    if (!(condition)) { \
+        std::cerr << "ASSERTION FAILED: " << #condition << " at " << __FILE__ << ":" << __LINE__ << std::endl; \
+        return false; \
+    } \
+} while(0)
+
+#define RUN_TEST(test_func) do { \
+    std::cout << "Running test: " << #test_func << "... "; \
+    bool result = test_func(); \
+    if (result) { \
+        std::cout << "PASSED" << std::endl; \
+        passed_tests++; \
+    } else { \
+        std::cout << "FAILED" << std::endl; \
+        failed_tests++; \
+    } \
+    total_tests++; \
+} while(0)
+
+int passed_tests = 0;
+int failed_tests = 0;
+int total_tests = 0;
+
+using havel::LatencyHistogram;
+using namespace std::chrono_literals;
+
+// Every value falls in a bucket whose upper bound is at least the value
+// and at most ~3% above it
+bool test_bucket_bounds() {
+    size_t previous = 0;
+    for (uint64_t value = 0; value < (1ull << 36); value = value * 5 / 4 + 1) {
+        size_t index = LatencyHistogram::BucketIndex(value);
+        TEST_ASSERT(index < LatencyHistogram::BucketCount);
+        TEST_ASSERT(index >= previous);
+        uint64_t bound = LatencyHistogram::BucketUpperBound(index);
+        TEST_ASSERT(bound >= value);
+        TEST_ASSERT(bound - value <= value / 32 + 1);
+        previous = index;
+    }
+    TEST_ASSERT(LatencyHistogram::BucketIndex(~0ull) == LatencyHistogram::BucketCount - 1);
+    return true;
+}
+
+bool test_percentiles() {
+    LatencyHistogram histogram;
+    TEST_ASSERT(histogram.Percentile(0.5) == 0ns);
+
+    // 1..1000 us, uniformly
+    for (int us = 1; us <= 1000; ++us) {
+        histogram.Record(std::chrono::microseconds(us));
+    }
+    TEST_ASSERT(histogram.Count() == 1000);
+    TEST_ASSERT(histogram.Max() == 1000us);
+
+    auto near = [](std::chrono::nanoseconds actual, std::chrono::nanoseconds expected) {
+        return std::abs(static_cast<double>((actual - expected).count())) <=
+               expected.count() * 0.04;
+    };
+    TEST_ASSERT(near(histogram.Percentile(0.5), 500us));
+    TEST_ASSERT(near(histogram.Percentile(0.99), 990us));
+    TEST_ASSERT(histogram.Percentile(0.999) <= 1000us);
+    TEST_ASSERT(histogram.Percentile(1.0) == 1000us);
+
+    histogram.Reset();
+    TEST_ASSERT(histogram.Count() == 0);
+    TEST_ASSERT(histogram.Percentile(0.99) == 0ns);
+    return true;
+}
+
+bool test_concurrent_record() {
+    LatencyHistogram histogram;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&histogram, t] {
+            for (int i = 0; i < 10000; ++i) {
+                histogram.Record(std::chrono::microseconds(t + 1));
+            }
+        });
+    }
+    for (auto &thread : threads) thread.join();
+
+    TEST_ASSERT(histogram.Count() == 40000);
+    TEST_ASSERT(histogram.Max() == 4us);
+    return true;
+}
+
+// A removed hotkey's histogram is gone from the report
+bool test_forget_hotkey() {
+    havel::LatencyTracker tracker;
+    tracker.RecordHotkey(7, 120us);
+    tracker.RecordHotkey(8, 80us);
+    tracker.ForgetHotkey(7);
+
+    std::string report = tracker.Report({});
+    TEST_ASSERT(report.find("hotkey 7 ") == std::string::npos);
+    TEST_ASSERT(report.find("hotkey 8 count=1") != std::string::npos);
+    // Stage histograms keep what the hotkey recorded
+    TEST_ASSERT(report.find("callback.start count=2") != std::string::npos);
+    return true;
+}
+
+int main() {
+    std::cout << "Starting latency histogram tests..." << std::endl;
+
+    RUN_TEST(test_bucket_bounds);
+    RUN_TEST(test_percentiles);
+    RUN_TEST(test_concurrent_record);
+    RUN_TEST(test_forget_hotkey);
+
+    std::cout << "\nTest Summary:" << std::endl;
+    std::cout << "  Total tests: " << total_tests << std::endl;
+    std::cout << "  Passed: " << passed_tests << std::endl;
+    std::cout << "  Failed: " << failed_tests << std::endl;
+
+    return failed_tests > 0 ? 1 : 0;
+}
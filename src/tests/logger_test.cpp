@@ -0,0 +1,152 @@
+#include <iostream>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <chrono>
+#include <unistd.h>
+#include "../utils/Logger.hpp"
+
+// Test framework macros
+#define TEST_ASSERT(condition) do { \
+    if (!(condition)) { \
+        std::cerr << "ASSERTION FAILED: " << #condition << " at " << __FILE__ << ":" << __LINE__ << std::endl; \
+        return false; \
+    } \
+} while(0)
+
+#define RUN_TEST(test_func) do { \
+    std::cout << "Running test: " << #test_func << "... "; \
+    bool result = test_func(); \
+    if (result) { \
+        std::cout << "PASSED" << std::endl; \
+        passed_tests++; \
+    } else { \
+        std::cout << "FAILED" << std::endl; \
+        failed_tests++; \
+    } \
+    total_tests++; \
+} while(0)
+
+int passed_tests = 0;
+int failed_tests = 0;
+int total_tests = 0;
+
+static std::string logPath;
+
+static std::vector<std::string> read_log() {
+    std::vector<std::string> lines;
+    std::ifstream file(logPath);
+    std::string line;
+    while (std::getline(file, line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+static void reset_log() {
+    std::remove(logPath.c_str());
+    lo.setLogFile(logPath);
+}
+
+bool test_async_lines_are_written_on_flush() {
+    reset_log();
+    lo.setAsync(true);
+    lo.info("first");
+    lo.warning("second");
+    lo.flush();
+    lo.setAsync(false);
+
+    auto lines = read_log();
+    TEST_ASSERT(lines.size() == 2);
+    TEST_ASSERT(lines[0].find("[INFO] first") != std::string::npos);
+    TEST_ASSERT(lines[1].find("[WARNING] second") != std::string::npos);
+    return true;
+}
+
+bool test_async_threads_keep_their_order() {
+    constexpr int threads = 4;
+    constexpr int perThread = 100;
+    reset_log();
+    lo.setAsync(true);
+
+    std::vector<std::thread> writers;
+    for (int t = 0; t < threads; ++t) {
+        writers.emplace_back([t] {
+            for (int i = 0; i < perThread; ++i) {
+                lo.info("writer " + std::to_string(t) + " line " + std::to_string(i));
+            }
+        });
+    }
+    for (auto &writer : writers) writer.join();
+    lo.flush();
+    lo.setAsync(false);
+
+    auto lines = read_log();
+    TEST_ASSERT(lines.size() == threads * perThread);
+    std::vector<int> next(threads, 0);
+    for (const auto &line : lines) {
+        int t = -1, i = -1;
+        auto pos = line.find("writer ");
+        TEST_ASSERT(pos != std::string::npos);
+        TEST_ASSERT(sscanf(line.c_str() + pos, "writer %d line %d", &t, &i) == 2);
+        TEST_ASSERT(t >= 0 && t < threads);
+        TEST_ASSERT(i == next[t]);
+        ++next[t];
+    }
+    return true;
+}
+
+// The drain thread sleeps without a timeout, so the line itself has to
+// wake it
+bool test_idle_drain_wakes_on_log() {
+    reset_log();
+    lo.setAsync(true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    lo.info("wake up");
+
+    std::vector<std::string> lines;
+    for (int i = 0; i < 200 && lines.empty(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        lines = read_log();
+    }
+    lo.setAsync(false);
+    TEST_ASSERT(lines.size() == 1);
+    TEST_ASSERT(lines[0].find("[INFO] wake up") != std::string::npos);
+    return true;
+}
+
+bool test_fatal_flushes() {
+    reset_log();
+    lo.setAsync(true);
+    lo.info("before");
+    lo.fatal("crashing");
+
+    // No flush() and the drain thread is still running
+    auto lines = read_log();
+    lo.setAsync(false);
+    TEST_ASSERT(lines.size() == 2);
+    TEST_ASSERT(lines[1].find("[FATAL] crashing") != std::string::npos);
+    return true;
+}
+
+int main() {
+    std::cout << "Starting logger tests..." << std::endl;
+
+    logPath = "/tmp/havel_logger_test_" + std::to_string(getpid()) + ".log";
+
+    RUN_TEST(test_async_lines_are_written_on_flush);
+    RUN_TEST(test_async_threads_keep_their_order);
+    RUN_TEST(test_idle_drain_wakes_on_log);
+    RUN_TEST(test_fatal_flushes);
+
+    std::remove(logPath.c_str());
+
+    std::cout << "\nTest Summary:" << std::endl;
+    std::cout << "  Total tests: " << total_tests << std::endl;
+    std::cout << "  Passed: " << passed_tests << std::endl;
+    std::cout << "  Failed: " << failed_tests << std::endl;
+
+    return failed_tests > 0 ? 1 : 0;
+}
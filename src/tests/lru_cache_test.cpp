@@ -0,0 +1,101 @@
+#include <iostream>
+#include <string>
+#include "../utils/LruCache.hpp"
+
+using havel::LruCache;
+
+// Test framework macros
+#define TEST_ASSERT(condition) do { \
+    if (!(condition)) { \
+        std::cerr << "ASSERTION FAILED: " << #condition << " at " << __FILE__ << ":" << __LINE__ << std::endl; \
+        return false; \
+    } \
+} while(0)
+
+#define RUN_TEST(test_func) do { \
+    std::cout << "Running test: " << #test_func << "... "; \
+    bool result = test_func(); \
+    if (result) { \
+        std::cout << "PASSED" << std::endl; \
+        passed_tests++; \
+    } else { \
+        std::cout << "FAILED" << std::endl; \
+        failed_tests++; \
+    } \
+    total_tests++; \
+} while(0)
+
+int passed_tests = 0;
+int failed_tests = 0;
+int total_tests = 0;
+
+bool test_hit_and_miss() {
+    LruCache<std::string, int> cache(2);
+    TEST_ASSERT(cache.Find("a") == nullptr);
+
+    cache.Put("a", 1);
+    int *a = cache.Find("a");
+    TEST_ASSERT(a != nullptr && *a == 1);
+    TEST_ASSERT(cache.Find("b") == nullptr);
+
+    // Put on an existing key replaces the value without growing
+    cache.Put("a", 2);
+    TEST_ASSERT(*cache.Find("a") == 2);
+    TEST_ASSERT(cache.Size() == 1);
+    return true;
+}
+
+bool test_evicts_least_recently_used() {
+    LruCache<std::string, int> cache(3);
+    cache.Put("a", 1);
+    cache.Put("b", 2);
+    cache.Put("c", 3);
+
+    // A hit makes "a" the most recent, so "b" is the oldest now
+    TEST_ASSERT(cache.Find("a") != nullptr);
+    cache.Put("d", 4);
+    TEST_ASSERT(cache.Size() == 3);
+    TEST_ASSERT(cache.Find("b") == nullptr);
+    TEST_ASSERT(cache.Find("a") != nullptr);
+    TEST_ASSERT(cache.Find("c") != nullptr);
+    TEST_ASSERT(cache.Find("d") != nullptr);
+
+    // So does replacing a value: order is now c, d, a (oldest first)
+    cache.Put("c", 30);
+    cache.Put("e", 5);
+    TEST_ASSERT(cache.Find("a") == nullptr);
+    TEST_ASSERT(*cache.Find("c") == 30);
+    TEST_ASSERT(cache.Find("d") != nullptr);
+    TEST_ASSERT(cache.Find("e") != nullptr);
+    return true;
+}
+
+bool test_capacity_and_clear() {
+    LruCache<int, int> empty(0);
+    TEST_ASSERT(empty.Capacity() == 1);
+    empty.Put(1, 1);
+    empty.Put(2, 2);
+    TEST_ASSERT(empty.Size() == 1);
+    TEST_ASSERT(empty.Find(1) == nullptr);
+    TEST_ASSERT(*empty.Find(2) == 2);
+
+    empty.Clear();
+    TEST_ASSERT(empty.Size() == 0);
+    TEST_ASSERT(empty.Find(2) == nullptr);
+    return true;
+}
+
+int main() {
+    std::cout << "Starting LRU cache tests..." << std::endl;
+
+    RUN_TEST(test_hit_and_miss);
+    RUN_TEST(test_evicts_least_recently_used);
+    RUN_TEST(test_capacity_and_clear);
+
+    std::cout << "\nTest Summary:" << std::endl;
+    std::cout << "  Total tests: " << total_tests << std::endl;
+    std::cout << "  Passed: " << passed_tests << std::endl;
+    std::cout << "  Failed: " << failed_tests << std::endl;
+
+    return failed_tests > 0 ? 1 : 0;
+}
@@ -0,0 +1,179 @@
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+#include "../core/MotionEngine.hpp"
+
+// Test framework macros
+#define TEST_ASSERT(condition) do { \
+    if (!(condition)) { \
+        std::cerr << "ASSERTION FAILED: " << #condition << " at " << __FILE__ << ":" << __LINE__ << std::endl; \
+        return false; \
+    } \
+} while(0)
+
+#define RUN_TEST(test_func) do { \
+    std::cout << "Running test: " << #test_func << "... "; \
+    bool result = test_func(); \
+    if (result) { \
+        std::cout << "PASSED" << std::endl; \
+        passed_tests++; \
+    } else { \
+        std::cout << "FAILED" << std::endl; \
+        failed_tests++; \
+    } \
+    total_tests++; \
+} while(0)
+
+int passed_tests = 0;
+int failed_tests = 0;
+int total_tests = 0;
+
+using namespace std::chrono_literals;
+
+// Sums the steps it is given, like the pointer would
+struct Recorder {
+    std::mutex mutex;
+    int x = 0;
+    int y = 0;
+    int steps = 0;
+    int maxStep = 0;
+
+    havel::MotionEngine::Emitter Emitter() {
+        return [this](int dx, int dy) {
+            std::lock_guard<std::mutex> lock(mutex);
+            x += dx;
+            y += dy;
+            steps++;
+            maxStep = std::max({maxStep, std::abs(dx), std::abs(dy)});
+            return true;
+        };
+    }
+};
+
+// Diagonal moves that do not divide evenly still land exactly on target
+bool test_exact_target() {
+    Recorder rec;
+    havel::MotionEngine engine(rec.Emitter());
+
+    havel::MotionEngine::Motion motion;
+    motion.dx = 333;
+    motion.dy = -71;
+    motion.duration = 40ms;
+    motion.easing = havel::MotionEngine::Easing::Linear;
+    TEST_ASSERT(engine.Start(motion).get());
+
+    std::lock_guard<std::mutex> lock(rec.mutex);
+    TEST_ASSERT(rec.x == 333);
+    TEST_ASSERT(rec.y == -71);
+    TEST_ASSERT(rec.steps > 1);
+    return true;
+}
+
+// Curved and eased paths also end on target
+bool test_curved_path_exact_target() {
+    Recorder rec;
+    havel::MotionEngine engine(rec.Emitter());
+
+    havel::MotionEngine::Motion motion;
+    motion.dx = -250;
+    motion.dy = 120;
+    motion.duration = 30ms;
+    motion.easing = havel::MotionEngine::Easing::EaseInOut;
+    motion.curvature = 0.3f;
+    TEST_ASSERT(engine.Start(motion).get());
+
+    std::lock_guard<std::mutex> lock(rec.mutex);
+    TEST_ASSERT(rec.x == -250);
+    TEST_ASSERT(rec.y == 120);
+    return true;
+}
+
+// Cancelling stops a motion part way and reports it as not completed
+bool test_cancel_mid_motion() {
+    Recorder rec;
+    havel::MotionEngine engine(rec.Emitter());
+
+    havel::MotionEngine::Motion motion;
+    motion.dx = 1000;
+    motion.duration = 500ms;
+    motion.easing = havel::MotionEngine::Easing::Linear;
+    auto result = engine.Start(motion);
+
+    std::this_thread::sleep_for(50ms);
+    engine.Cancel();
+    TEST_ASSERT(!result.get());
+
+    std::lock_guard<std::mutex> lock(rec.mutex);
+    TEST_ASSERT(rec.x > 0);
+    TEST_ASSERT(rec.x < 1000);
+    return true;
+}
+
+// Overlapping motions add up, like steps written by two threads would
+bool test_overlapping_motions_add() {
+    Recorder rec;
+    havel::MotionEngine engine(rec.Emitter());
+
+    havel::MotionEngine::Motion right;
+    right.dx = 100;
+    right.duration = 60ms;
+    auto first = engine.Start(right);
+
+    std::this_thread::sleep_for(10ms);
+    havel::MotionEngine::Motion upLeft;
+    upLeft.dx = -30;
+    upLeft.dy = -50;
+    upLeft.duration = 20ms;
+    upLeft.curvature = 0.2f;
+    auto second = engine.Start(upLeft);
+
+    TEST_ASSERT(second.get());
+    TEST_ASSERT(first.get());
+    TEST_ASSERT(!engine.Busy());
+
+    std::lock_guard<std::mutex> lock(rec.mutex);
+    TEST_ASSERT(rec.x == 70);
+    TEST_ASSERT(rec.y == -50);
+    return true;
+}
+
+// Cancelling stops every motion in flight
+bool test_cancel_stops_all() {
+    Recorder rec;
+    havel::MotionEngine engine(rec.Emitter());
+
+    havel::MotionEngine::Motion motion;
+    motion.dx = 1000;
+    motion.duration = 500ms;
+    auto first = engine.Start(motion);
+    motion.dy = 1000;
+    auto second = engine.Start(motion);
+
+    std::this_thread::sleep_for(20ms);
+    engine.Cancel();
+    TEST_ASSERT(!first.get());
+    TEST_ASSERT(!second.get());
+    TEST_ASSERT(!engine.Busy());
+    return true;
+}
+
+int main() {
+    std::cout << "Starting motion engine tests..." << std::endl;
+
+    RUN_TEST(test_exact_target);
+    RUN_TEST(test_curved_path_exact_target);
+    RUN_TEST(test_cancel_mid_motion);
+    RUN_TEST(test_overlapping_motions_add);
+    RUN_TEST(test_cancel_stops_all);
+
+    std::cout << "\nTest Summary:" << std::endl;
+    std::cout << "  Total tests: " << total_tests << std::endl;
+    std::cout << "  Passed: " << passed_tests << std::endl;
+    std::cout << "  Failed: " << failed_tests << std::endl;
+
+    return failed_tests > 0 ? 1 : 0;
+}
@@ -0,0 +1,218 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cctype>
+#include "../core/IO.hpp"
+
+using namespace havel;
+
+// Test framework macros
+#define TEST_ASSERT(condition) do { \
+    if (!(condition)) { \
+        std::cerr << "ASSERTION FAILED: " << #condition << " at " << __FILE__ << ":" << __LINE__ << std::endl; \
+        return false; \
+    } \
+} while(0)
+
+#define RUN_TEST(test_func) do { \
+    std::cout << "Running test: " << #test_func << "... "; \
+    bool result = test_func(); \
+    if (result) { \
+        std::cout << "PASSED" << std::endl; \
+        passed_tests++; \
+    } else { \
+        std::cout << "FAILED" << std::endl; \
+        failed_tests++; \
+    } \
+    total_tests++; \
+} while(0)
+
+int passed_tests = 0;
+int failed_tests = 0;
+int total_tests = 0;
+
+// The Send() interpreter as it was before strings were compiled, with the
+// output recorded instead of sent. X11 keys are compared by keysym: both
+// paths turn them into keycodes the same way when the events are sent.
+static SendProgram Interpret(const std::string &keys) {
+    SendProgram sent;
+    auto SendUInput = [&](int code, bool down) {
+        // uinput only enables real key codes; KEY_RESERVED never arrives
+        if (code != 0) sent.push_back({static_cast<Key>(code), down, false});
+    };
+    auto SendX11Key = [&](const std::string &keyName, bool down) {
+        Key keysym = IO::StringToVirtualKey(keyName);
+        if (keysym != NoSymbol) sent.push_back({keysym, down, true});
+    };
+
+    bool useUinput = true;
+    std::vector<std::string> activeModifiers;
+    std::unordered_map<std::string, std::string> modifierKeys = {
+        {"ctrl", "LControl"}, {"rctrl", "RControl"},
+        {"shift", "LShift"}, {"rshift", "RShift"},
+        {"alt", "LAlt"}, {"ralt", "RAlt"},
+        {"meta", "LMeta"}, {"rmeta", "RMeta"},
+    };
+
+    std::unordered_map<char, std::string> shorthandModifiers = {
+        {'^', "ctrl"}, {'!', "alt"}, {'+', "shift"}, {'#', "meta"},
+        {'@', "toggle_uinput"},
+    };
+
+    auto SendKeyImpl = [&](const std::string &keyName, bool down) {
+        if (useUinput) {
+            int code = IO::EvdevNameToKeyCode(keyName);
+            if (code != -1) SendUInput(code, down);
+        } else {
+            SendX11Key(keyName, down);
+        }
+    };
+
+    auto SendKey = [&](const std::string &keyName, bool down) {
+        if (down && !activeModifiers.empty()) {
+            for (const auto &mod : activeModifiers) {
+                SendKeyImpl(mod, false);
+            }
+            activeModifiers.clear();
+        }
+        SendKeyImpl(keyName, down);
+    };
+
+    size_t i = 0;
+    while (i < keys.length()) {
+        if (shorthandModifiers.count(keys[i])) {
+            std::string mod = shorthandModifiers[keys[i]];
+            if (mod == "toggle_uinput") {
+                useUinput = !useUinput;
+            } else if (modifierKeys.count(mod)) {
+                SendKey(modifierKeys[mod], true);
+                activeModifiers.push_back(mod);
+            }
+            ++i;
+            continue;
+        }
+
+        if (keys[i] == '{') {
+            size_t end = keys.find('}', i);
+            if (end == std::string::npos) {
+                ++i;
+                continue;
+            }
+            std::string seq = keys.substr(i + 1, end - i - 1);
+            std::transform(seq.begin(), seq.end(), seq.begin(), ::tolower);
+
+            if (seq.ends_with(" down")) {
+                std::string mod = seq.substr(0, seq.size() - 5);
+                if (modifierKeys.count(mod)) {
+                    SendKey(modifierKeys[mod], true);
+                    activeModifiers.push_back(mod);
+                } else {
+                    SendKey(mod, true);
+                }
+            } else if (seq.ends_with(" up")) {
+                std::string mod = seq.substr(0, seq.size() - 3);
+                if (modifierKeys.count(mod)) {
+                    SendKey(modifierKeys[mod], false);
+                    activeModifiers.erase(
+                        std::remove(activeModifiers.begin(), activeModifiers.end(), mod),
+                        activeModifiers.end());
+                } else {
+                    SendKey(mod, false);
+                }
+            } else if (modifierKeys.count(seq)) {
+                SendKey(modifierKeys[seq], true);
+                SendKey(modifierKeys[seq], false);
+            } else {
+                SendKey(seq, true);
+                SendKey(seq, false);
+            }
+            i = end + 1;
+            continue;
+        }
+
+        if (!isspace(keys[i])) {
+            std::string key(1, keys[i]);
+            SendKey(key, true);
+            SendKey(key, false);
+        }
+        ++i;
+    }
+
+    for (const auto &mod : activeModifiers) {
+        if (modifierKeys.count(mod)) {
+            SendKey(modifierKeys[mod], false);
+        } else {
+            SendKey(mod, false);
+        }
+    }
+    return sent;
+}
+
+static bool Same(const SendProgram &a, const SendProgram &b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                      [](const SendOp &x, const SendOp &y) {
+                          return x.code == y.code && x.down == y.down && x.x11 == y.x11;
+                      });
+}
+
+static bool MatchesInterpreter(const std::string &keys) {
+    SendProgram compiled = IO::CompileSend(keys);
+    SendProgram interpreted = Interpret(keys);
+    if (!Same(compiled, interpreted)) {
+        std::cerr << "Send(\"" << keys << "\"): compiled " << compiled.size()
+                  << " events, interpreted " << interpreted.size() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool test_plain_keys() {
+    TEST_ASSERT(MatchesInterpreter("abc"));
+    TEST_ASSERT(MatchesInterpreter("a b\tc"));
+    TEST_ASSERT(MatchesInterpreter("{Enter}{Tab}{Esc}"));
+    TEST_ASSERT(!IO::CompileSend("ab").empty());
+    return true;
+}
+
+bool test_modifiers() {
+    TEST_ASSERT(MatchesInterpreter("^c"));
+    TEST_ASSERT(MatchesInterpreter("^+{Left}"));
+    TEST_ASSERT(MatchesInterpreter("!{Tab}#r"));
+    TEST_ASSERT(MatchesInterpreter("{Ctrl down}x{Ctrl up}"));
+    TEST_ASSERT(MatchesInterpreter("{Shift down}ab"));
+    TEST_ASSERT(MatchesInterpreter("{LAlt down}x{lalt up}{rctrl}"));
+    return true;
+}
+
+bool test_x11_toggle() {
+    TEST_ASSERT(MatchesInterpreter("@ab@c"));
+    TEST_ASSERT(MatchesInterpreter("@^{Delete}"));
+    return true;
+}
+
+bool test_malformed_input() {
+    TEST_ASSERT(MatchesInterpreter("{"));
+    TEST_ASSERT(MatchesInterpreter("a{b"));
+    TEST_ASSERT(MatchesInterpreter("{nosuchkey}"));
+    TEST_ASSERT(MatchesInterpreter("{} up"));
+    TEST_ASSERT(MatchesInterpreter(""));
+    return true;
+}
+
+int main() {
+    std::cout << "Starting Send program tests..." << std::endl;
+
+    RUN_TEST(test_plain_keys);
+    RUN_TEST(test_modifiers);
+    RUN_TEST(test_x11_toggle);
+    RUN_TEST(test_malformed_input);
+
+    std::cout << "\nTest Summary:" << std::endl;
+    std::cout << "  Total tests: " << total_tests << std::endl;
+    std::cout << "  Passed: " << passed_tests << std::endl;
+    std::cout << "  Failed: " << failed_tests << std::endl;
+
+    return failed_tests > 0 ? 1 : 0;
+}
@@ -0,0 +1,180 @@
+#include <iostream>
+#include <memory>
+#include <vector>
+#include <linux/input.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <X11/keysym.h>
+#include "../core/TextTyper.hpp"
+
+using namespace havel;
+
+// Test framework macros
+#define TEST_ASSERT(condition) do { \
+    if (!(condition)) { \
+        std::cerr << "ASSERTION FAILED: " << #condition << " at " << __FILE__ << ":" << __LINE__ << std::endl; \
+        return false; \
+    } \
+} while(0)
+
+#define RUN_TEST(test_func) do { \
+    std::cout << "Running test: " << #test_func << "... "; \
+    bool result = test_func(); \
+    if (result) { \
+        std::cout << "PASSED" << std::endl; \
+        passed_tests++; \
+    } else { \
+        std::cout << "FAILED" << std::endl; \
+        failed_tests++; \
+    } \
+    total_tests++; \
+} while(0)
+
+int passed_tests = 0;
+int failed_tests = 0;
+int total_tests = 0;
+
+// A small layout: keycode 20 + i types the i-th letter, shifted on level 1
+static std::shared_ptr<const KeymapTable> TestLayout() {
+    constexpr int minKeycode = 8;
+    std::vector<KeymapTable::Levels> levels(120 - minKeycode);
+    auto at = [&](int keycode) -> KeymapTable::Levels & { return levels[keycode - minKeycode]; };
+    for (KeySym i = 0; i < 10; ++i) {
+        at(20 + i) = {XK_a + i, XK_A + i, NoSymbol, NoSymbol};
+    }
+    // AltGr+e types the euro sign, as a Unicode keysym
+    at(24)[2] = 0x10020ac;
+    // 'a' again, but shifted on a higher keycode: the unshifted one wins
+    at(40) = {XK_Z, XK_a, NoSymbol, NoSymbol};
+    at(36) = {XK_Return, NoSymbol, NoSymbol, NoSymbol};
+    at(50) = {XK_Shift_L, NoSymbol, NoSymbol, NoSymbol};
+    at(108) = {XK_ISO_Level3_Shift, NoSymbol, NoSymbol, NoSymbol};
+    return KeymapTable::Build(minKeycode, levels);
+}
+
+// Each uinput write becomes one datagram, so frames can be told apart
+struct Sink {
+    int fds[2] = {-1, -1};
+    Sink() { socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK, 0, fds); }
+    ~Sink() {
+        close(fds[0]);
+        close(fds[1]);
+    }
+
+    std::vector<std::vector<input_event>> Frames() const {
+        std::vector<std::vector<input_event>> frames;
+        input_event buffer[256];
+        ssize_t n;
+        while ((n = recv(fds[0], buffer, sizeof(buffer), 0)) > 0) {
+            frames.emplace_back(buffer, buffer + n / sizeof(input_event));
+        }
+        return frames;
+    }
+};
+
+static TextTyper::Options Fast(size_t charsPerFrame) {
+    TextTyper::Options options;
+    options.charsPerFrame = charsPerFrame;
+    options.framePeriod = std::chrono::microseconds(1);
+    return options;
+}
+
+static size_t KeyEvents(const std::vector<input_event> &frame) {
+    size_t keys = 0;
+    for (const auto &ev : frame) {
+        if (ev.type == EV_KEY) ++keys;
+    }
+    return keys;
+}
+
+bool test_frames_hold_chars_per_frame() {
+    auto table = TestLayout();
+    Sink sink;
+    TextTyper typer(Fast(3));
+    TEST_ASSERT(typer.Type(nullptr, sink.fds[1], "abcdefg", *table));
+
+    auto frames = sink.Frames();
+    TEST_ASSERT(frames.size() == 3);
+    // A press and a release, each its own report, per character
+    TEST_ASSERT(frames[0].size() == 3 * 4);
+    TEST_ASSERT(frames[1].size() == 3 * 4);
+    TEST_ASSERT(frames[2].size() == 1 * 4);
+
+    const input_event &first = frames[0][0];
+    TEST_ASSERT(first.type == EV_KEY && first.code == 20 - EvdevKeycodeOffset && first.value == 1);
+    const input_event &last = frames[2].back();
+    TEST_ASSERT(last.type == EV_SYN && last.code == SYN_REPORT);
+    return true;
+}
+
+// A zero threshold types everything, however long
+bool test_zero_threshold_never_pastes() {
+    auto table = TestLayout();
+    Sink sink;
+    TextTyper::Options options = Fast(8);
+    TEST_ASSERT(options.clipboardThreshold > 0);
+    options.clipboardThreshold = 0;
+    TextTyper typer(options);
+    std::string text(300, 'a');
+    TEST_ASSERT(typer.Type(nullptr, sink.fds[1], text, *table));
+
+    size_t keys = 0;
+    for (const auto &frame : sink.Frames()) {
+        keys += KeyEvents(frame);
+    }
+    TEST_ASSERT(keys == 2 * text.size());
+    return true;
+}
+
+bool test_modifiers_span_characters() {
+    auto table = TestLayout();
+    Sink sink;
+    TextTyper typer(Fast(8));
+    TEST_ASSERT(typer.Type(nullptr, sink.fds[1], "aBCd", *table));
+
+    auto frames = sink.Frames();
+    TEST_ASSERT(frames.size() == 1);
+    // Shift goes down once for B and C and comes back up before d
+    std::vector<std::pair<int, int>> keys;
+    for (const auto &ev : frames[0]) {
+        if (ev.type == EV_KEY) keys.emplace_back(ev.code, ev.value);
+    }
+    const int shift = 50 - EvdevKeycodeOffset;
+    std::vector<std::pair<int, int>> expected = {
+        {12, 1}, {12, 0},
+        {shift, 1}, {13, 1}, {13, 0}, {14, 1}, {14, 0},
+        {shift, 0}, {15, 1}, {15, 0},
+    };
+    TEST_ASSERT(keys == expected);
+    return true;
+}
+
+bool test_modifier_released_at_end() {
+    auto table = TestLayout();
+    Sink sink;
+    TextTyper typer(Fast(1));
+    TEST_ASSERT(typer.Type(nullptr, sink.fds[1], "A\u20ac", *table));
+
+    auto frames = sink.Frames();
+    // One frame per character, and a last one releasing AltGr
+    TEST_ASSERT(frames.size() == 3);
+    TEST_ASSERT(KeyEvents(frames[2]) == 1);
+    TEST_ASSERT(frames[2][0].code == 108 - EvdevKeycodeOffset && frames[2][0].value == 0);
+    return true;
+}
+
+int main() {
+    std::cout << "Starting text typer tests..." << std::endl;
+
+    RUN_TEST(test_frames_hold_chars_per_frame);
+    RUN_TEST(test_zero_threshold_never_pastes);
+    RUN_TEST(test_modifiers_span_characters);
+    RUN_TEST(test_modifier_released_at_end);
+
+    std::cout << "\nTest Summary:" << std::endl;
+    std::cout << "  Total tests: " << total_tests << std::endl;
+    std::cout << "  Passed: " << passed_tests << std::endl;
+    std::cout << "  Failed: " << failed_tests << std::endl;
+
+    return failed_tests > 0 ? 1 : 0;
+}
@@ -0,0 +1,154 @@
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <vector>
+#include <mutex>
+#include <functional>
+#include "../core/TimerService.hpp"
+
+// Test framework macros
+#define TEST_ASSERT(condition) do { \
+    if (!(condition)) { \
+        std::cerr << "ASSERTION FAILED: " << #condition << " at " << __FILE__ << ":" << __LINE__ << std::endl; \
+        return false; \
+    } \
+} while(0)
+
+#define RUN_TEST(test_func) do { \
+    std::cout << "Running test: " << #test_func << "... "; \
+    bool result = test_func(); \
+    if (result) { \
+        std::cout << "PASSED" << std::endl; \
+        passed_tests++; \
+    } else { \
+        std::cout << "FAILED" << std::endl; \
+        failed_tests++; \
+    } \
+    total_tests++; \
+} while(0)
+
+int passed_tests = 0;
+int failed_tests = 0;
+int total_tests = 0;
+
+static bool wait_until(const std::function<bool()> &condition, int timeout_ms = 2000) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+using namespace std::chrono_literals;
+
+// One-shot timers fire once, in deadline order
+bool test_one_shot_order() {
+    havel::TimerService timers;
+    std::mutex mutex;
+    std::vector<int> order;
+
+    timers.After(30ms, [&] { std::lock_guard<std::mutex> l(mutex); order.push_back(3); });
+    timers.After(10ms, [&] { std::lock_guard<std::mutex> l(mutex); order.push_back(1); });
+    timers.After(20ms, [&] { std::lock_guard<std::mutex> l(mutex); order.push_back(2); });
+
+    TEST_ASSERT(wait_until([&] { std::lock_guard<std::mutex> l(mutex); return order.size() == 3; }));
+    TEST_ASSERT(order == (std::vector<int>{1, 2, 3}));
+    TEST_ASSERT(wait_until([&] { return timers.Pending() == 0; }));
+    return true;
+}
+
+// Periodic timers keep to their absolute schedule even with slow callbacks
+bool test_periodic_does_not_drift() {
+    havel::TimerService timers;
+    std::atomic<int> runs{0};
+    auto start = std::chrono::steady_clock::now();
+
+    auto id = timers.Every(10ms, [&] {
+        std::this_thread::sleep_for(4ms);
+        ++runs;
+    });
+
+    TEST_ASSERT(wait_until([&] { return runs >= 20; }));
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    timers.Cancel(id);
+
+    // Sleeping loops would need 20 * (10 + 4) ms; the schedule needs ~200
+    TEST_ASSERT(elapsed < 250ms);
+    return true;
+}
+
+// After Cancel returns the callback is neither running nor fired again
+bool test_cancel_waits_and_stops() {
+    havel::TimerService timers;
+    std::atomic<bool> inside{false};
+    std::atomic<int> runs{0};
+
+    auto id = timers.Every(1ms, [&] {
+        inside = true;
+        std::this_thread::sleep_for(5ms);
+        ++runs;
+        inside = false;
+    });
+
+    TEST_ASSERT(wait_until([&] { return inside.load(); }));
+    TEST_ASSERT(timers.Cancel(id));
+    TEST_ASSERT(!inside);
+    int seen = runs;
+    std::this_thread::sleep_for(20ms);
+    TEST_ASSERT(runs == seen);
+    TEST_ASSERT(!timers.Active(id));
+    TEST_ASSERT(!timers.Cancel(id));
+    return true;
+}
+
+// A callback may cancel its own timer without deadlocking
+bool test_cancel_from_callback() {
+    havel::TimerService timers;
+    std::atomic<int> runs{0};
+    std::atomic<havel::TimerService::TimerId> id{0};
+
+    id = timers.Every(2ms, [&] {
+        if (++runs == 3) timers.Cancel(id);
+    });
+
+    TEST_ASSERT(wait_until([&] { return runs >= 3; }));
+    std::this_thread::sleep_for(20ms);
+    TEST_ASSERT(runs == 3);
+    return true;
+}
+
+// A callback knows its own id from the first tick on
+bool test_current_id() {
+    havel::TimerService timers;
+    std::atomic<havel::TimerService::TimerId> seen{0};
+
+    TEST_ASSERT(timers.Current() == 0);
+    auto id = timers.Every(1ms, [&] {
+        seen = timers.Current();
+        timers.Cancel(seen);
+    }, 0ms);
+
+    TEST_ASSERT(wait_until([&] { return seen != 0; }));
+    TEST_ASSERT(seen == id);
+    TEST_ASSERT(!timers.Active(id));
+    return true;
+}
+
+int main() {
+    std::cout << "Starting timer service tests..." << std::endl;
+
+    RUN_TEST(test_one_shot_order);
+    RUN_TEST(test_periodic_does_not_drift);
+    RUN_TEST(test_cancel_waits_and_stops);
+    RUN_TEST(test_cancel_from_callback);
+    RUN_TEST(test_current_id);
+
+    std::cout << "\nTest Summary:" << std::endl;
+    std::cout << "  Total tests: " << total_tests << std::endl;
+    std::cout << "  Passed: " << passed_tests << std::endl;
+    std::cout << "  Failed: " << failed_tests << std::endl;
+
+    return failed_tests > 0 ? 1 : 0;
+}
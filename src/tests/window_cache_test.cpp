@@ -0,0 +1,191 @@
+#include <iostream>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../window/WindowCache.hpp"
+
+using namespace havel;
+
+// Test framework macros
+#define TEST_ASSERT(condition) do { \
+    if (!(condition)) { \
+        std::cerr << "ASSERTION FAILED: " << #condition << " at " << __FILE__ << ":" << __LINE__ << std::endl; \
+        return false; \
+    } \
+} while(0)
+
+#define RUN_TEST(test_func) do { \
+    std::cout << "Running test: " << #test_func << "... "; \
+    bool result = test_func(); \
+    if (result) { \
+        std::cout << "PASSED" << std::endl; \
+        passed_tests++; \
+    } else { \
+        std::cout << "FAILED" << std::endl; \
+        failed_tests++; \
+    } \
+    total_tests++; \
+} while(0)
+
+int passed_tests = 0;
+int failed_tests = 0;
+int total_tests = 0;
+
+static std::shared_ptr<const WindowInfo> MakeWindow(wID id, const std::string &cls,
+                                                    const std::string &title, pid_t pid) {
+    auto info = std::make_shared<WindowInfo>();
+    info->windowId = id;
+    info->windowClass = cls;
+    info->instance = "inst-" + cls;
+    info->title = title;
+    info->pid = pid;
+    info->processName = "proc-" + cls;
+    info->isValid = true;
+    return info;
+}
+
+// Published snapshots never change under a reader
+bool test_snapshots_are_immutable() {
+    WindowCache cache;
+    auto empty = cache.Load();
+    TEST_ASSERT(empty && empty->windows.empty());
+    TEST_ASSERT(empty->ActiveId() == 0);
+
+    cache.Update([](WindowCache::Snapshot &s) {
+        s.windows[1] = MakeWindow(1, "firefox", "Home", 100);
+    });
+    auto first = cache.Load();
+    cache.Update([](WindowCache::Snapshot &s) {
+        s.windows[2] = MakeWindow(2, "kitty", "zsh", 200);
+        s.active = s.windows[2];
+    });
+    auto second = cache.Load();
+
+    TEST_ASSERT(empty->windows.empty());
+    TEST_ASSERT(first->windows.size() == 1);
+    TEST_ASSERT(first->ActiveId() == 0);
+    TEST_ASSERT(second->windows.size() == 2);
+    TEST_ASSERT(second->ActiveId() == 2);
+    TEST_ASSERT(second->version > first->version);
+    // Unchanged windows are shared, not copied
+    TEST_ASSERT(first->windows.at(1) == second->windows.at(1));
+    return true;
+}
+
+bool test_lookups() {
+    WindowCache cache;
+    cache.Update([](WindowCache::Snapshot &s) {
+        s.windows[1] = MakeWindow(1, "firefox", "Home - Mozilla Firefox", 100);
+        s.windows[2] = MakeWindow(2, "kitty", "zsh", 200);
+        // The active window need not be a managed client
+        s.active = MakeWindow(3, "dialog", "Open File", 300);
+    });
+    auto snapshot = cache.Load();
+
+    TEST_ASSERT(snapshot->FindByClass("kitty")->windowId == 2);
+    TEST_ASSERT(snapshot->FindByClass("inst-firefox")->windowId == 1);
+    TEST_ASSERT(snapshot->FindByClass("Kitty") == nullptr);
+    TEST_ASSERT(snapshot->FindByTitle("zsh")->windowId == 2);
+    TEST_ASSERT(snapshot->FindByTitle("Home") == nullptr);
+    TEST_ASSERT(snapshot->FindByPid(100)->windowId == 1);
+    TEST_ASSERT(snapshot->FindByPid(999) == nullptr);
+    TEST_ASSERT(snapshot->FindByProcess("proc-kitty")->windowId == 2);
+    TEST_ASSERT(snapshot->Find(3) && snapshot->Find(3)->title == "Open File");
+    TEST_ASSERT(snapshot->Find(4) == nullptr);
+    return true;
+}
+
+bool test_going_offline_empties() {
+    WindowCache cache;
+    TEST_ASSERT(!cache.Live());
+    cache.Update([](WindowCache::Snapshot &s) {
+        s.windows[1] = MakeWindow(1, "firefox", "Home", 100);
+        s.active = s.windows[1];
+    });
+    cache.SetLive(true);
+    TEST_ASSERT(cache.Live());
+    TEST_ASSERT(cache.Load()->windows.size() == 1);
+
+    auto held = cache.Load();
+    cache.SetLive(false);
+    TEST_ASSERT(!cache.Live());
+    TEST_ASSERT(cache.Load()->windows.empty());
+    TEST_ASSERT(cache.Load()->ActiveId() == 0);
+    TEST_ASSERT(held->windows.size() == 1);
+    return true;
+}
+
+bool test_window_state_flags() {
+    WindowInfo info;
+    info.state = WindowFullscreen | WindowAbove;
+    TEST_ASSERT(info.Has(WindowFullscreen));
+    TEST_ASSERT(info.Has(WindowAbove));
+    TEST_ASSERT(!info.Has(WindowMaximized));
+    TEST_ASSERT(!info.Has(WindowHidden));
+
+    WindowInfo moved = info;
+    TEST_ASSERT(moved == info);
+    moved.geometry.x = 10;
+    TEST_ASSERT(!(moved == info));
+    return true;
+}
+
+// Readers always see a whole snapshot while a writer keeps publishing
+bool test_concurrent_readers() {
+    WindowCache cache;
+    constexpr int updates = 2000;
+    std::atomic<bool> done{false};
+    std::atomic<bool> consistent{true};
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r) {
+        readers.emplace_back([&]() {
+            while (!done.load(std::memory_order_acquire)) {
+                auto snapshot = cache.Load();
+                // The writer keeps the active window and the table in step
+                wID active = snapshot->ActiveId();
+                if (active != 0 && snapshot->windows.size() != active) {
+                    consistent = false;
+                }
+                if (active != 0 && !snapshot->FindByPid(static_cast<pid_t>(active))) {
+                    consistent = false;
+                }
+            }
+        });
+    }
+
+    for (int i = 1; i <= updates; ++i) {
+        cache.Update([i](WindowCache::Snapshot &s) {
+            s.windows[i] = MakeWindow(i, "w" + std::to_string(i), "t", i);
+            s.active = s.windows[i];
+        });
+    }
+    done = true;
+    for (auto &reader : readers) {
+        reader.join();
+    }
+
+    TEST_ASSERT(consistent.load());
+    TEST_ASSERT(cache.Load()->windows.size() == updates);
+    TEST_ASSERT(cache.Load()->version == updates);
+    return true;
+}
+
+int main() {
+    std::cout << "Starting window cache tests..." << std::endl;
+
+    RUN_TEST(test_snapshots_are_immutable);
+    RUN_TEST(test_lookups);
+    RUN_TEST(test_going_offline_empties);
+    RUN_TEST(test_window_state_flags);
+    RUN_TEST(test_concurrent_readers);
+
+    std::cout << "\nTest Summary:" << std::endl;
+    std::cout << "  Total tests: " << total_tests << std::endl;
+    std::cout << "  Passed: " << passed_tests << std::endl;
+    std::cout << "  Failed: " << failed_tests << std::endl;
+
+    return failed_tests > 0 ? 1 : 0;
+}
@@ -0,0 +1,146 @@
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cctype>
+#include "../utils/AhoCorasick.hpp"
+#include "../core/WindowClassifier.hpp"
+
+using namespace havel;
+
+// Test framework macros
+#define TEST_ASSERT(condition) do { \
+    if (!(condition)) { \
+        std::cerr << "ASSERTION FAILED: " << #condition << " at " << __FILE__ << ":" << __LINE__ << std::endl; \
+        return false; \
+    } \
+} while(0)
+
+#define RUN_TEST(test_func) do { \
+    std::cout << "Running test: " << #test_func << "... "; \
+    bool result = test_func(); \
+    if (result) { \
+        std::cout << "PASSED" << std::endl; \
+        passed_tests++; \
+    } else { \
+        std::cout << "FAILED" << std::endl; \
+        failed_tests++; \
+    } \
+    total_tests++; \
+} while(0)
+
+int passed_tests = 0;
+int failed_tests = 0;
+int total_tests = 0;
+
+static std::string Lower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), ::tolower);
+    return text;
+}
+
+bool test_overlapping_patterns() {
+    AhoCorasick matcher({"he", "she", "his", "hers"});
+    TEST_ASSERT(matcher.Contains("ushers"));
+    TEST_ASSERT(matcher.Find("ushers") == 1);  // "she" ends first
+    TEST_ASSERT(matcher.Find("this") == 2);
+    TEST_ASSERT(matcher.Contains("aHErS"));
+    TEST_ASSERT(!matcher.Contains("xyz"));
+    TEST_ASSERT(!matcher.Contains(""));
+
+    AhoCorasick empty;
+    TEST_ASSERT(!empty.Contains("anything"));
+    AhoCorasick blank({""});
+    TEST_ASSERT(!blank.Contains("anything"));
+    return true;
+}
+
+bool test_matches_naive_search() {
+    std::mt19937 rng(42);
+    auto randomText = [&](size_t maxLength) {
+        std::string text(rng() % (maxLength + 1), ' ');
+        for (char &c : text) c = "abcAB-_"[rng() % 7];
+        return text;
+    };
+
+    for (int round = 0; round < 200; ++round) {
+        std::vector<std::string> patterns;
+        for (int i = 0, n = 1 + rng() % 8; i < n; ++i) {
+            patterns.push_back(randomText(5));
+        }
+        AhoCorasick matcher(patterns);
+
+        for (int probe = 0; probe < 20; ++probe) {
+            std::string text = randomText(30);
+            bool expected = false;
+            for (const auto &pattern : patterns) {
+                if (!pattern.empty() && Lower(text).find(Lower(pattern)) != std::string::npos) {
+                    expected = true;
+                }
+            }
+            TEST_ASSERT(matcher.Contains(text) == expected);
+        }
+    }
+    return true;
+}
+
+bool test_default_gaming_rules() {
+    WindowClassifier classifier(WindowClassifier::DefaultGamingRules());
+
+    TEST_ASSERT(!classifier.Matches("steam"));
+    TEST_ASSERT(classifier.Matches("steam_app_default"));
+    TEST_ASSERT(classifier.Matches("RetroArch"));
+    TEST_ASSERT(classifier.Matches("org.yuzu_emu.yuzu"));
+    TEST_ASSERT(classifier.Matches("NieRAutomata.exe"));
+    TEST_ASSERT(classifier.Matches("factorio"));
+    TEST_ASSERT(classifier.Matches("MangoHud"));
+    // Exact rules are case-sensitive
+    TEST_ASSERT(!classifier.Matches("Factorio"));
+    TEST_ASSERT(!classifier.Matches("firefox"));
+    TEST_ASSERT(!classifier.Matches(""));
+    return true;
+}
+
+bool test_contains_and_exact() {
+    WindowClassifier::Rules rules;
+    rules.contains = {"game"};
+    rules.exact = {"mpv"};
+    WindowClassifier classifier(rules);
+
+    TEST_ASSERT(classifier.Matches("some-game"));
+    TEST_ASSERT(classifier.Matches("Game"));
+    TEST_ASSERT(classifier.Matches("mpv"));
+    TEST_ASSERT(!classifier.Matches("mpv-player"));
+    TEST_ASSERT(!classifier.Matches("firefox"));
+    // Asking again gives the same answer
+    TEST_ASSERT(classifier.Matches("some-game"));
+    return true;
+}
+
+bool test_split_list() {
+    auto items = WindowClassifier::SplitList(" wine, lutris ,,heroic ");
+    TEST_ASSERT(items.size() == 3);
+    TEST_ASSERT(items[0] == "wine");
+    TEST_ASSERT(items[1] == "lutris");
+    TEST_ASSERT(items[2] == "heroic");
+    TEST_ASSERT(WindowClassifier::JoinList(items) == "wine,lutris,heroic");
+    TEST_ASSERT(WindowClassifier::SplitList("").empty());
+    return true;
+}
+
+int main() {
+    std::cout << "Starting window classifier tests..." << std::endl;
+
+    RUN_TEST(test_overlapping_patterns);
+    RUN_TEST(test_matches_naive_search);
+    RUN_TEST(test_default_gaming_rules);
+    RUN_TEST(test_contains_and_exact);
+    RUN_TEST(test_split_list);
+
+    std::cout << "\nTest Summary:" << std::endl;
+    std::cout << "  Total tests: " << total_tests << std::endl;
+    std::cout << "  Passed: " << passed_tests << std::endl;
+    std::cout << "  Failed: " << failed_tests << std::endl;
+
+    return failed_tests > 0 ? 1 : 0;
+}
@@ -0,0 +1,212 @@
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "../window/WindowCache.hpp"
+#include "../window/WindowIndex.hpp"
+#include "../window/WindowMatcher.hpp"
+
+using namespace havel;
+
+// Test framework macros
+#define TEST_ASSERT(condition) do { \
+    if (!(condition)) { \
+        std::cerr << "ASSERTION FAILED: " << #condition << " at " << __FILE__ << ":" << __LINE__ << std::endl; \
+        return false; \
+    } \
+} while(0)
+
+#define RUN_TEST(test_func) do { \
+    std::cout << "Running test: " << #test_func << "... "; \
+    bool result = test_func(); \
+    if (result) { \
+        std::cout << "PASSED" << std::endl; \
+        passed_tests++; \
+    } else { \
+        std::cout << "FAILED" << std::endl; \
+        failed_tests++; \
+    } \
+    total_tests++; \
+} while(0)
+
+int passed_tests = 0;
+int failed_tests = 0;
+int total_tests = 0;
+
+static void AddWindow(WindowCache::Snapshot &s, wID id, const std::string &cls,
+                      const std::string &instance, const std::string &title,
+                      pid_t pid, const std::string &process) {
+    auto info = std::make_shared<WindowInfo>();
+    info->windowId = id;
+    info->windowClass = cls;
+    info->instance = instance;
+    info->title = title;
+    info->pid = pid;
+    info->processName = process;
+    info->isValid = true;
+    s.windows[id] = info;
+}
+
+static std::shared_ptr<const WindowCache::Snapshot> Desktop() {
+    WindowCache cache;
+    cache.Update([](WindowCache::Snapshot &s) {
+        AddWindow(s, 30, "firefox", "Navigator", "Inbox - Mozilla Firefox", 100, "firefox");
+        AddWindow(s, 10, "firefox", "Navigator", "YouTube - Mozilla Firefox", 100, "firefox");
+        AddWindow(s, 20, "kitty", "kitty", "vim notes.txt", 200, "kitty");
+        AddWindow(s, 40, "Steam", "steamwebhelper", "Steam", 300, "steam");
+    });
+    return cache.Load();
+}
+
+bool test_exact_lookups() {
+    auto snapshot = Desktop();
+    const WindowIndex &index = snapshot->Index();
+    TEST_ASSERT(index.Size() == 4);
+
+    // Lowest id wins among several matches
+    TEST_ASSERT(index.FindByClass("firefox")->windowId == 10);
+    TEST_ASSERT(index.FindByClass("Navigator")->windowId == 10);
+    TEST_ASSERT(index.FindByClass("steamwebhelper")->windowId == 40);
+    TEST_ASSERT(index.FindByInstance("firefox") == nullptr);
+    TEST_ASSERT(index.FindByTitle("Steam")->windowId == 40);
+    TEST_ASSERT(index.FindByTitle("Inbox") == nullptr);
+    TEST_ASSERT(index.FindByPid(200)->windowId == 20);
+    TEST_ASSERT(index.FindByPid(0) == nullptr);
+    TEST_ASSERT(index.FindByProcess("steam")->windowId == 40);
+
+    // Snapshot lookups go through the same index
+    TEST_ASSERT(&snapshot->Index() == &index);
+    TEST_ASSERT(snapshot->FindByClass("kitty")->windowId == 20);
+    return true;
+}
+
+bool test_substring_lookups() {
+    auto snapshot = Desktop();
+    const WindowIndex &index = snapshot->Index();
+    TEST_ASSERT(index.FindTitleContaining("Mozilla")->windowId == 10);
+    TEST_ASSERT(index.FindTitleContaining("Inbox")->windowId == 30);
+    TEST_ASSERT(index.FindTitleContaining("notes")->windowId == 20);
+    TEST_ASSERT(index.FindTitleContaining("vi")->windowId == 20);
+    TEST_ASSERT(index.FindTitleContaining("")->windowId == 10);
+    TEST_ASSERT(index.FindTitleContaining("Chromium") == nullptr);
+    // All trigrams present, but not next to each other
+    TEST_ASSERT(index.FindTitleContaining("Inbox - YouTube") == nullptr);
+
+    TEST_ASSERT(index.FindClassContaining("fox")->windowId == 10);
+    TEST_ASSERT(index.FindClassContaining("webhelper")->windowId == 40);
+    TEST_ASSERT(index.FindClassContaining("chrome") == nullptr);
+    return true;
+}
+
+// The trigram search finds exactly what a scan of every title finds
+bool test_matches_naive_search() {
+    std::mt19937 rng(7);
+    const std::string alphabet = "abc -";
+    auto randomText = [&](size_t maxLength) {
+        std::string text(rng() % (maxLength + 1), ' ');
+        for (auto &c : text) c = alphabet[rng() % alphabet.size()];
+        return text;
+    };
+
+    WindowCache cache;
+    cache.Update([&](WindowCache::Snapshot &s) {
+        for (wID id = 1; id <= 60; ++id) {
+            AddWindow(s, id, "c", "i", randomText(24), 1, "p");
+        }
+    });
+    auto snapshot = cache.Load();
+
+    for (int i = 0; i < 2000; ++i) {
+        std::string needle = randomText(6);
+        wID expected = 0;
+        for (wID id = 1; id <= 60; ++id) {
+            if (snapshot->windows.at(id)->title.find(needle) != std::string::npos) {
+                expected = id;
+                break;
+            }
+        }
+        const WindowInfo *found = snapshot->Index().FindTitleContaining(needle);
+        TEST_ASSERT((found ? found->windowId : 0) == expected);
+    }
+    return true;
+}
+
+// Each published snapshot gets an index of its own
+bool test_index_follows_updates() {
+    WindowCache cache;
+    cache.Update([](WindowCache::Snapshot &s) {
+        AddWindow(s, 1, "kitty", "kitty", "zsh", 1, "kitty");
+    });
+    auto before = cache.Load();
+    TEST_ASSERT(before->FindByTitle("zsh"));
+
+    cache.Update([](WindowCache::Snapshot &s) {
+        auto info = std::make_shared<WindowInfo>(*s.windows.at(1));
+        info->title = "htop";
+        s.windows[1] = info;
+    });
+    auto after = cache.Load();
+    TEST_ASSERT(after->FindByTitle("zsh") == nullptr);
+    TEST_ASSERT(after->FindByTitle("htop")->windowId == 1);
+    TEST_ASSERT(before->FindByTitle("zsh")->windowId == 1);
+    return true;
+}
+
+bool test_compile_identifiers() {
+    using Kind = WindowMatcher::Kind;
+
+    auto matcher = WindowMatcher::Compile("class firefox");
+    TEST_ASSERT(matcher.GetKind() == Kind::Class && matcher.Value() == "firefox");
+    TEST_ASSERT(WindowMatcher::Compile("class:firefox").Value() == "firefox");
+    TEST_ASSERT(WindowMatcher::Compile("class=firefox").GetKind() == Kind::Class);
+    TEST_ASSERT(WindowMatcher::Compile("title Inbox - Mail").Value() == "Inbox - Mail");
+    TEST_ASSERT(WindowMatcher::Compile("group browsers").GetKind() == Kind::Group);
+    TEST_ASSERT(WindowMatcher::Compile("exe:kitty").GetKind() == Kind::Exe);
+
+    matcher = WindowMatcher::Compile("pid 1234");
+    TEST_ASSERT(matcher.GetKind() == Kind::Pid && matcher.Number() == 1234);
+    TEST_ASSERT(WindowMatcher::Compile("id 0x3a00007").Number() == 0x3a00007);
+    TEST_ASSERT(WindowMatcher::Compile("pid abc").GetKind() == Kind::Invalid);
+    TEST_ASSERT(WindowMatcher::Compile("pid ").GetKind() == Kind::Invalid);
+
+    // No known type: the whole text is a title
+    matcher = WindowMatcher::Compile("Untitled: notes");
+    TEST_ASSERT(matcher.GetKind() == Kind::Title && matcher.Value() == "Untitled: notes");
+    TEST_ASSERT(WindowMatcher::Compile("Steam").Value() == "Steam");
+    return true;
+}
+
+bool test_matcher_find() {
+    auto snapshot = Desktop();
+    TEST_ASSERT(WindowMatcher::Compile("class firefox").Find(*snapshot)->windowId == 10);
+    TEST_ASSERT(WindowMatcher::Compile("pid:200").Find(*snapshot)->windowId == 20);
+    TEST_ASSERT(WindowMatcher::Compile("exe steam").Find(*snapshot)->windowId == 40);
+    TEST_ASSERT(WindowMatcher::Compile("Steam").Find(*snapshot)->windowId == 40);
+    TEST_ASSERT(WindowMatcher::Compile("id 30").Find(*snapshot)->windowId == 30);
+    TEST_ASSERT(WindowMatcher::Compile("id 31").Find(*snapshot) == nullptr);
+    TEST_ASSERT(WindowMatcher::Compile("group all").Find(*snapshot) == nullptr);
+
+    auto kitty = WindowMatcher::Compile("class:kitty");
+    TEST_ASSERT(kitty.Matches(*snapshot->windows.at(20)));
+    TEST_ASSERT(!kitty.Matches(*snapshot->windows.at(10)));
+    return true;
+}
+
+int main() {
+    std::cout << "Starting window index tests..." << std::endl;
+
+    RUN_TEST(test_exact_lookups);
+    RUN_TEST(test_substring_lookups);
+    RUN_TEST(test_matches_naive_search);
+    RUN_TEST(test_index_follows_updates);
+    RUN_TEST(test_compile_identifiers);
+    RUN_TEST(test_matcher_find);
+
+    std::cout << "\nTest Summary:" << std::endl;
+    std::cout << "  Total tests: " << total_tests << std::endl;
+    std::cout << "  Passed: " << passed_tests << std::endl;
+    std::cout << "  Failed: " << failed_tests << std::endl;
+
+    return failed_tests > 0 ? 1 : 0;
+}
@@ -0,0 +1,80 @@
+// Converts a flight recorder dump to Chrome trace JSON
+// (chrome://tracing, Perfetto).
+//
+//   trace2json havel.trace > havel.json
+
+#include "../core/FlightRecorder.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+using havel::TraceEvent;
+using havel::TraceFileHeader;
+using havel::TraceRecord;
+
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <trace file>\n", argv[0]);
+        return 2;
+    }
+
+    int fd = open(argv[1], O_RDONLY);
+    if (fd < 0) {
+        perror(argv[1]);
+        return 1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(TraceFileHeader)) {
+        fprintf(stderr, "%s: not a trace file\n", argv[1]);
+        close(fd);
+        return 1;
+    }
+    void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+
+    const auto *header = static_cast<const TraceFileHeader *>(map);
+    if (memcmp(header->magic, "HVTRACE", 8) != 0 ||
+        header->version != havel::FlightRecorder::FileVersion ||
+        header->recordSize != sizeof(TraceRecord) ||
+        header->recordCount > (st.st_size - sizeof(TraceFileHeader)) / sizeof(TraceRecord)) {
+        fprintf(stderr, "%s: unsupported or truncated trace file\n", argv[1]);
+        return 1;
+    }
+
+    const auto *first = reinterpret_cast<const TraceRecord *>(header + 1);
+    std::vector<TraceRecord> records(first, first + header->recordCount);
+    std::stable_sort(records.begin(), records.end(),
+                     [](const TraceRecord &a, const TraceRecord &b) { return a.timeNs < b.timeNs; });
+
+    uint64_t origin = records.empty() ? 0 : records.front().timeNs;
+    printf("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for (size_t i = 0; i < records.size(); ++i) {
+        const TraceRecord &r = records[i];
+        auto event = static_cast<TraceEvent>(r.event);
+        // Callbacks are spans, everything else is an instant
+        const char *phase = event == TraceEvent::CallbackStarted ? "B"
+                          : event == TraceEvent::CallbackFinished ? "E"
+                          : "i";
+        printf("{\"name\":\"%s\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":1,\"tid\":%u,",
+               havel::TraceEventName(event), phase,
+               (r.timeNs - origin) / 1000.0, r.thread);
+        if (phase[0] == 'i') {
+            printf("\"s\":\"t\",");
+        }
+        printf("\"args\":{\"hotkey\":%d,\"arg\":%d}}%s\n",
+               r.hotkey, r.arg, i + 1 < records.size() ? "," : "");
+    }
+    printf("]}\n");
+
+    munmap(map, st.st_size);
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include "AhoCorasick.hpp"
+#include <cctype>
+#include <queue>
+
+namespace havel {
+
+static constexpr uint32_t NoState = UINT32_MAX;
+
+static unsigned char Fold(char c) {
+    return static_cast<unsigned char>(std::tolower(static_cast<unsigned char>(c)));
+}
+
+AhoCorasick::AhoCorasick() : next(1, 0), output(1, -1) {
+}
+
+AhoCorasick::AhoCorasick(const std::vector<std::string> &patterns) {
+    for (const auto &pattern : patterns) {
+        for (char c : pattern) {
+            unsigned char folded = Fold(c);
+            if (symbol[folded] == 0 && alphabet < 256) {
+                symbol[folded] = static_cast<uint8_t>(alphabet++);
+            }
+        }
+    }
+    for (int c = 0; c < 256; ++c) {
+        symbol[c] = symbol[Fold(static_cast<char>(c))];
+    }
+
+    // Trie
+    next.assign(alphabet, NoState);
+    output.assign(1, -1);
+    for (size_t i = 0; i < patterns.size(); ++i) {
+        if (patterns[i].empty()) {
+            continue;
+        }
+        uint32_t state = 0;
+        for (char c : patterns[i]) {
+            size_t edge = state * alphabet + symbol[static_cast<unsigned char>(c)];
+            if (next[edge] == NoState) {
+                next[edge] = static_cast<uint32_t>(output.size());
+                output.push_back(-1);
+                next.resize(next.size() + alphabet, NoState);
+            }
+            state = next[edge];
+        }
+        if (output[state] < 0) {
+            output[state] = static_cast<int32_t>(i);
+        }
+    }
+
+    // Failure links, breadth first, turning the trie into a DFA
+    std::vector<uint32_t> fail(output.size(), 0);
+    std::queue<uint32_t> pending;
+    for (size_t c = 0; c < alphabet; ++c) {
+        uint32_t &edge = next[c];
+        if (edge == NoState) {
+            edge = 0;
+        } else {
+            pending.push(edge);
+        }
+    }
+    while (!pending.empty()) {
+        uint32_t state = pending.front();
+        pending.pop();
+        if (output[state] < 0) {
+            output[state] = output[fail[state]];
+        }
+        for (size_t c = 0; c < alphabet; ++c) {
+            uint32_t &edge = next[state * alphabet + c];
+            uint32_t fallback = next[fail[state] * alphabet + c];
+            if (edge == NoState) {
+                edge = fallback;
+            } else {
+                fail[edge] = fallback;
+                pending.push(edge);
+            }
+        }
+    }
+}
+
+int AhoCorasick::Find(std::string_view text) const {
+    uint32_t state = 0;
+    for (char c : text) {
+        state = next[state * alphabet + symbol[static_cast<unsigned char>(c)]];
+        if (output[state] >= 0) {
+            return output[state];
+        }
+    }
+    return -1;
+}
+
+} // namespace havel
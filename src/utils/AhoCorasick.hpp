@@ -0,0 +1,41 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace havel {
+
+// Finds any of a fixed set of substrings in one pass over the text.
+//
+// The patterns are compiled into a deterministic automaton: a trie whose
+// missing edges are filled in from the failure links, so matching is one
+// table lookup per input byte no matter how many patterns there are.
+// Bytes are first mapped to a small alphabet of the characters that occur
+// in some pattern, which keeps the table a few kilobytes. ASCII letters
+// match case-insensitively.
+class AhoCorasick {
+public:
+    AhoCorasick();
+    explicit AhoCorasick(const std::vector<std::string> &patterns);
+
+    // Index of the first pattern ending earliest in `text`, -1 if none
+    int Find(std::string_view text) const;
+    bool Contains(std::string_view text) const { return Find(text) >= 0; }
+
+    size_t States() const { return output.size(); }
+
+private:
+    // Byte -> alphabet index; 0 stands for bytes in no pattern
+    std::array<uint8_t, 256> symbol{};
+    size_t alphabet = 1;
+    // States x alphabet
+    std::vector<uint32_t> next;
+    // Pattern recognized on entering a state, -1 if none
+    std::vector<int32_t> output;
+};
+
+} // namespace havel
@@ -0,0 +1,37 @@
+#include "HotLog.hpp"
+#include "Logger.hpp"
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <string_view>
+
+namespace havel {
+
+std::atomic<bool> HotLog::enabled{false};
+
+void HotLog::SetEnabled(bool on) {
+    Logger::getInstance().setHotPath(on);
+    enabled.store(on, std::memory_order_relaxed);
+}
+
+void HotLog::Write(const char *format, ...) {
+    char text[RecordSize];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    if (n < 0) {
+        return;
+    }
+    Logger::getInstance().hot(std::string_view(text, std::min<size_t>(n, sizeof(text) - 1)));
+}
+
+void HotLog::Flush() {
+    Logger::getInstance().flush();
+}
+
+uint64_t HotLog::Dropped() {
+    return Logger::getInstance().dropped();
+}
+
+} // namespace havel
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+
+// Compile-time gate: build with HAVEL_HOT_LOG=0 and every HOT_LOG call
+// compiles to nothing (the arguments are still type checked)
+#ifndef HAVEL_HOT_LOG
+#define HAVEL_HOT_LOG 1
+#endif
+
+namespace havel {
+
+// Logging for the input hot path.
+//
+// Call sites go through HOT_LOG, which tests a relaxed atomic flag before
+// evaluating any of its arguments, so a disabled call site costs one load
+// and a branch. Enabled records are formatted on the stack and queued on
+// the Logger's per-thread buffer for its drain thread to write with every
+// other line; the logging thread never takes a lock or waits on the
+// console. When the buffer is full records are dropped and counted, not
+// queued.
+class HotLog {
+public:
+    static constexpr size_t RecordSize = 160;   // Bytes of text per record
+
+    static bool Enabled() { return enabled.load(std::memory_order_relaxed); }
+
+    // Turning logging on starts the Logger's drain thread
+    static void SetEnabled(bool on);
+
+    // printf-style; text past RecordSize is truncated
+    static void Write(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+    // Wait until everything written so far has been printed
+    static void Flush();
+
+    // Records and Logger lines dropped so far
+    static uint64_t Dropped();
+
+private:
+    static std::atomic<bool> enabled;
+};
+
+} // namespace havel
+
+#if HAVEL_HOT_LOG
+#define HOT_LOG(...) \
+    do { \
+        if (::havel::HotLog::Enabled()) ::havel::HotLog::Write(__VA_ARGS__); \
+    } while (0)
+#else
+#define HOT_LOG(...) \
+    do { \
+        if (false) ::havel::HotLog::Write(__VA_ARGS__); \
+    } while (0)
+#endif
@@ -0,0 +1,76 @@
+#include "LatencyHistogram.hpp"
+#include <bit>
+#include <cmath>
+
+namespace havel {
+
+static constexpr uint64_t SubBuckets = 1u << LatencyHistogram::SubBucketBits;
+static constexpr uint64_t LinearLimit = SubBuckets * 2;
+
+size_t LatencyHistogram::BucketIndex(uint64_t value) {
+    if (value < LinearLimit) {
+        return static_cast<size_t>(value);
+    }
+    unsigned msb = 63 - std::countl_zero(value);
+    if (msb >= MaxValueBits) {
+        return BucketCount - 1;
+    }
+    // The top SubBucketBits + 1 bits select the bucket within the power
+    // of two; the leading one is implied
+    unsigned shift = msb - SubBucketBits;
+    uint64_t top = value >> shift;
+    return LinearLimit + (shift - 1) * SubBuckets + (top - SubBuckets);
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(size_t index) {
+    if (index < LinearLimit) {
+        return index;
+    }
+    uint64_t k = index - LinearLimit;
+    unsigned shift = static_cast<unsigned>(k / SubBuckets) + 1;
+    uint64_t top = k % SubBuckets + SubBuckets;
+    return ((top + 1) << shift) - 1;
+}
+
+void LatencyHistogram::Record(std::chrono::nanoseconds latency) {
+    uint64_t value = latency.count() > 0 ? static_cast<uint64_t>(latency.count()) : 0;
+    buckets[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t seen = max.load(std::memory_order_relaxed);
+    while (value > seen &&
+           !max.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+    }
+}
+
+std::chrono::nanoseconds LatencyHistogram::Percentile(double q) const {
+    uint64_t total = Count();
+    if (total == 0) {
+        return std::chrono::nanoseconds::zero();
+    }
+    q = q < 0 ? 0 : (q > 1 ? 1 : q);
+    uint64_t rank = static_cast<uint64_t>(std::ceil(q * total));
+    if (rank == 0) rank = 1;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BucketCount; ++i) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            // Never report more than was actually recorded
+            uint64_t bound = BucketUpperBound(i);
+            uint64_t top = max.load(std::memory_order_relaxed);
+            return std::chrono::nanoseconds(bound < top ? bound : top);
+        }
+    }
+    return Max();
+}
+
+void LatencyHistogram::Reset() {
+    for (auto &bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    count.store(0, std::memory_order_relaxed);
+    max.store(0, std::memory_order_relaxed);
+}
+
+} // namespace havel
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace havel {
+
+// Log-linear latency histogram in the style of HdrHistogram.
+//
+// Values are nanoseconds. Below 64 ns every value has its own bucket;
+// above that each power of two is split into 32 buckets, so a reported
+// percentile is within about 3% of the true value. Values past ~18
+// minutes land in the last bucket. Recording is a relaxed atomic add and
+// safe from any number of threads; readers see a consistent enough view
+// for percentiles without stopping writers.
+class LatencyHistogram {
+public:
+    static constexpr unsigned SubBucketBits = 5;
+    static constexpr unsigned MaxValueBits = 40;
+    static constexpr size_t BucketCount =
+        (2u << SubBucketBits) + (MaxValueBits - SubBucketBits - 1) * (1u << SubBucketBits);
+
+    void Record(std::chrono::nanoseconds latency);
+
+    // Value at quantile `q` (0..1), the upper edge of its bucket; 0 when empty
+    std::chrono::nanoseconds Percentile(double q) const;
+
+    uint64_t Count() const { return count.load(std::memory_order_relaxed); }
+    std::chrono::nanoseconds Max() const {
+        return std::chrono::nanoseconds(max.load(std::memory_order_relaxed));
+    }
+
+    void Reset();
+
+    static size_t BucketIndex(uint64_t value);
+    static uint64_t BucketUpperBound(size_t index);
+
+private:
+    std::array<std::atomic<uint64_t>, BucketCount> buckets{};
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> max{0};
+};
+
+} // namespace havel
@@ -6,23 +6,179 @@
 #include <chrono>
 #include <sstream>
 #include <fstream>
+#include <algorithm>
+#include <condition_variable>
+#include <thread>
+#include <vector>
 
 // Define the global logger instance
 havel::Logger& lo = havel::Logger::getInstance();
 
 namespace havel {
 
+namespace {
+
+struct Record {
+    Logger::Level level = Logger::Level::LOG_INFO;
+    bool hot = false;                   // Queued by hot(), not log()
+    std::chrono::system_clock::time_point time;
+    std::string message;
+};
+
+// Single-producer single-consumer ring: the owning thread appends, the
+// drain thread takes. Neither side ever waits for the other.
+struct ThreadBuffer {
+    static constexpr size_t Capacity = 1024;
+
+    // The text is assigned into the slot's string and the drain thread
+    // copies it out, so once every slot has grown to fit its lines a push
+    // allocates nothing
+    bool Push(Logger::Level level, bool hot, std::string_view message) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        Record &record = records[h % Capacity];
+        record.level = level;
+        record.hot = hot;
+        record.time = std::chrono::system_clock::now();
+        record.message.assign(message);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    void TakeAll(std::vector<Record> &out) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t h = head.load(std::memory_order_acquire);
+        for (; t != h; ++t) {
+            out.push_back(records[t % Capacity]);
+        }
+        tail.store(t, std::memory_order_release);
+    }
+
+    bool Empty() const {
+        return head.load(std::memory_order_acquire) ==
+               tail.load(std::memory_order_relaxed);
+    }
+
+    Record records[Capacity];
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+    std::atomic<bool> retired{false};   // Owning thread has exited
+};
+
+// Marks the calling thread's buffer retired when the thread exits, so the
+// drain thread can drop it once it is empty
+struct BufferHandle {
+    std::shared_ptr<ThreadBuffer> buffer;
+    ~BufferHandle() {
+        if (buffer) buffer->retired.store(true, std::memory_order_release);
+    }
+};
+
+thread_local BufferHandle threadBuffer;
+
+// Calendar formatting is the expensive part of a timestamp and only
+// changes once a second
+class TimestampCache {
+public:
+    void Append(std::chrono::system_clock::time_point time, std::string &out) {
+        auto sinceEpoch = time.time_since_epoch();
+        auto seconds = std::chrono::duration_cast<std::chrono::seconds>(sinceEpoch);
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            sinceEpoch - seconds).count();
+        if (seconds.count() != cachedSecond) {
+            time_t t = static_cast<time_t>(seconds.count());
+            struct tm tm;
+            localtime_r(&t, &tm);
+            strftime(cachedText, sizeof(cachedText), "%Y-%m-%d %H:%M:%S", &tm);
+            cachedSecond = seconds.count();
+        }
+        char millis[8];
+        snprintf(millis, sizeof(millis), ".%03d", static_cast<int>(ms));
+        out += cachedText;
+        out += millis;
+    }
+
+private:
+    long long cachedSecond = -1;
+    char cachedText[32] = {};
+};
+
+} // namespace
+
 struct Logger::Impl {
     std::ofstream logFile;
+    TimestampCache syncTimestamps;      // Guarded by Logger::mutex
+
+    // Async mode and hot() lines
+    std::mutex controlMutex;            // Serializes starting and stopping the drain
+    bool hotPath = false;               // Guarded by controlMutex
+    std::atomic<bool> draining{false};
+    std::mutex buffersMutex;            // Only taken to register a thread
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    std::thread drainThread;
+    std::mutex wakeMutex;
+    std::condition_variable wakeCv;
+    std::condition_variable flushedCv;
+    bool stopping = false;
+    // Set while the drain thread sleeps with every buffer empty
+    std::atomic<bool> idle{false};
+    uint64_t flushRequested = 0;
+    uint64_t flushCompleted = 0;
+    std::atomic<uint64_t> dropped{0};
+    TimestampCache drainTimestamps;     // Drain thread only
+
+    ThreadBuffer &LocalBuffer() {
+        if (!threadBuffer.buffer) {
+            threadBuffer.buffer = std::make_shared<ThreadBuffer>();
+            std::lock_guard<std::mutex> lock(buffersMutex);
+            buffers.push_back(threadBuffer.buffer);
+        }
+        return *threadBuffer.buffer;
+    }
+
+    bool AllEmpty() {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        return std::all_of(buffers.begin(), buffers.end(),
+                           [](const auto &buffer) { return buffer->Empty(); });
+    }
+
+    // Called after a push. Pairs with the fence in the drain loop: either
+    // the drain thread sees the line before it sleeps, or we see it idle
+    // and wake it. A busy drain thread costs the logger no syscall.
+    void WakeIfIdle() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (idle.load(std::memory_order_relaxed)) {
+            {
+                std::lock_guard<std::mutex> lock(wakeMutex);
+                idle.store(false, std::memory_order_relaxed);
+            }
+            wakeCv.notify_one();
+        }
+    }
+
+    void Push(Logger::Level level, bool hot, std::string_view message) {
+        if (!LocalBuffer().Push(level, hot, message)) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        WakeIfIdle();
+    }
 };
 
 Logger::Logger() 
     : pImpl(std::make_unique<Impl>())
     , currentLevel(Level::LOG_INFO)
+    , async(false)
     , consoleOutput(true) {
 }
 
-Logger::~Logger() = default;
+Logger::~Logger() {
+    std::lock_guard<std::mutex> lock(pImpl->controlMutex);
+    async = false;
+    pImpl->hotPath = false;
+    stopDrain();
+}
 
 void Logger::setLogFile(const std::string& filename) {
     std::lock_guard<std::mutex> lock(mutex);
@@ -33,10 +189,145 @@ void Logger::setLogFile(const std::string& filename) {
 }
 
 void Logger::setLogLevel(Level level) {
-    std::lock_guard<std::mutex> lock(mutex);
     currentLevel = level;
 }
 
+void Logger::setAsync(bool enabled) {
+    std::lock_guard<std::mutex> lock(pImpl->controlMutex);
+    async = enabled;
+    if (enabled) {
+        startDrain();
+    } else if (!pImpl->hotPath) {
+        stopDrain();
+    }
+}
+
+void Logger::setHotPath(bool enabled) {
+    std::lock_guard<std::mutex> lock(pImpl->controlMutex);
+    pImpl->hotPath = enabled;
+    if (enabled) {
+        startDrain();
+    } else if (!async) {
+        stopDrain();
+    }
+}
+
+void Logger::hot(std::string_view message) {
+    pImpl->Push(Level::LOG_DEBUG, true, message);
+}
+
+uint64_t Logger::dropped() const {
+    return pImpl->dropped.load(std::memory_order_relaxed);
+}
+
+// Both run under Impl::controlMutex
+void Logger::startDrain() {
+    Impl &impl = *pImpl;
+    if (impl.draining.exchange(true)) return;
+    {
+        std::lock_guard<std::mutex> lock(impl.wakeMutex);
+        impl.stopping = false;
+    }
+    impl.drainThread = std::thread([this] {
+        Impl &impl = *pImpl;
+        std::vector<Record> batch;
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        uint64_t reportedDrops = 0;
+        std::unique_lock<std::mutex> wakeLock(impl.wakeMutex);
+
+        while (true) {
+            uint64_t flushTarget = impl.flushRequested;
+            bool stopping = impl.stopping;
+            wakeLock.unlock();
+
+            {
+                std::lock_guard<std::mutex> lock(impl.buffersMutex);
+                buffers = impl.buffers;
+                // A retired buffer gets no more lines; drop it once drained
+                std::erase_if(impl.buffers, [](const auto &buffer) {
+                    return buffer->retired.load(std::memory_order_acquire) &&
+                           buffer->Empty();
+                });
+            }
+            batch.clear();
+            for (auto &buffer : buffers) {
+                buffer->TakeAll(batch);
+            }
+            buffers.clear();
+
+            // Buffers are per thread; put the lines back in time order
+            std::stable_sort(batch.begin(), batch.end(),
+                             [](const Record &a, const Record &b) { return a.time < b.time; });
+            std::string text;
+            for (const auto &record : batch) {
+                impl.drainTimestamps.Append(record.time, text);
+                text += record.hot ? std::string(" [hot] ")
+                                   : " [" + getLevelString(record.level) + "] ";
+                text += record.message;
+                text += '\n';
+            }
+            uint64_t drops = impl.dropped.load(std::memory_order_relaxed);
+            if (drops != reportedDrops) {
+                text += "[WARNING] Logger dropped " +
+                        std::to_string(drops - reportedDrops) + " lines\n";
+                reportedDrops = drops;
+            }
+            if (!text.empty()) {
+                write(text);
+            }
+
+            wakeLock.lock();
+            impl.flushCompleted = flushTarget;
+            impl.flushedCv.notify_all();
+            if (stopping) break;
+
+            // Sleep without a timeout once everything is written; the
+            // next line, flush() or setAsync(false) wakes us
+            impl.idle.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (impl.AllEmpty()) {
+                impl.wakeCv.wait(wakeLock, [&] {
+                    return !impl.idle.load(std::memory_order_relaxed) ||
+                           impl.stopping || impl.flushRequested != flushTarget;
+                });
+            }
+            impl.idle.store(false, std::memory_order_relaxed);
+        }
+    });
+}
+
+void Logger::stopDrain() {
+    Impl &impl = *pImpl;
+    if (!impl.draining.exchange(false)) return;
+    {
+        std::lock_guard<std::mutex> lock(impl.wakeMutex);
+        impl.stopping = true;
+    }
+    impl.wakeCv.notify_one();
+    if (impl.drainThread.joinable()) {
+        impl.drainThread.join();
+    }
+}
+
+void Logger::flush() {
+    Impl &impl = *pImpl;
+    if (impl.draining) {
+        std::unique_lock<std::mutex> lock(impl.wakeMutex);
+        uint64_t target = ++impl.flushRequested;
+        impl.wakeCv.notify_one();
+        impl.flushedCv.wait(lock, [&] {
+            return impl.flushCompleted >= target || impl.stopping;
+        });
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (pImpl->logFile.is_open()) {
+        pImpl->logFile.flush();
+    }
+    if (consoleOutput) {
+        std::cout.flush();
+    }
+}
+
 void Logger::debug(const std::string& message) {
     log(Level::LOG_DEBUG, message);
 }
@@ -55,6 +346,7 @@ void Logger::error(const std::string& message) {
 
 void Logger::fatal(const std::string& message) {
     log(Level::LOG_FATAL, message);
+    flush();
 }
 
 void Logger::log(Level level, const std::string& message) {
@@ -62,10 +354,15 @@ void Logger::log(Level level, const std::string& message) {
         return;
     }
 
+    if (async) {
+        pImpl->Push(level, false, message);
+        return;
+    }
+
     std::lock_guard<std::mutex> lock(mutex);
-    std::string timestamp = getCurrentTimestamp();
-    std::string levelStr = getLevelString(level);
-    std::string logMessage = timestamp + " [" + levelStr + "] " + message + "\n";
+    std::string logMessage;
+    pImpl->syncTimestamps.Append(std::chrono::system_clock::now(), logMessage);
+    logMessage += " [" + getLevelString(level) + "] " + message + "\n";
 
     if (pImpl->logFile.is_open()) {
         pImpl->logFile << logMessage;
@@ -77,6 +374,19 @@ void Logger::log(Level level, const std::string& message) {
     }
 }
 
+// One batch of formatted lines from the drain thread
+void Logger::write(const std::string& text) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (pImpl->logFile.is_open()) {
+        pImpl->logFile << text;
+        pImpl->logFile.flush();
+    }
+    if (consoleOutput) {
+        std::cout << text;
+        std::cout.flush();
+    }
+}
+
 std::string Logger::getLevelString(Level level) {
     switch (level) {
         case Level::LOG_DEBUG:   return "DEBUG";
@@ -89,15 +399,10 @@ std::string Logger::getLevelString(Level level) {
 }
 
 std::string Logger::getCurrentTimestamp() {
-    auto now = std::chrono::system_clock::now();
-    auto time = std::chrono::system_clock::to_time_t(now);
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch()) % 1000;
-
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&time), "%Y-%m-%d %H:%M:%S")
-       << '.' << std::setfill('0') << std::setw(3) << ms.count();
-    return ss.str();
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string timestamp;
+    pImpl->syncTimestamps.Append(std::chrono::system_clock::now(), timestamp);
+    return timestamp;
 }
 
-} // namespace havel
\ No newline at end of file
+} // namespace havel
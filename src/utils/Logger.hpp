@@ -1,8 +1,11 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <mutex>
 #include <memory>
+#include <atomic>
 
 namespace havel {
 
@@ -24,10 +27,28 @@ public:
     void setLogFile(const std::string& filename);
     void setLogLevel(Level level);
 
+    // In async mode a call only appends the line to a buffer owned by the
+    // calling thread; a background thread writes the buffers out in
+    // batches. A thread whose buffer is full drops lines rather than wait.
+    void setAsync(bool enabled);
+
+    // Lines from the input hot path (see HotLog). They always take the
+    // async route, whatever setAsync says, and are written with the
+    // other lines; enabling this starts the drain thread.
+    void setHotPath(bool enabled);
+    // Queue one such line; skips the level check and never locks
+    void hot(std::string_view message);
+    // Lines dropped so far because their thread's buffer was full
+    uint64_t dropped() const;
+
+    // Wait until every line logged so far by this thread is written
+    void flush();
+
     void debug(const std::string& message);
     void info(const std::string& message);
     void warning(const std::string& message);
     void error(const std::string& message);
+    // Flushes everything pending before returning
     void fatal(const std::string& message);
 
 private:
@@ -39,10 +60,14 @@ private:
     void log(Level level, const std::string& message);
     std::string getLevelString(Level level);
     std::string getCurrentTimestamp();
+    void write(const std::string& text);
+    void startDrain();
+    void stopDrain();
 
     struct Impl;
     std::unique_ptr<Impl> pImpl;
-    Level currentLevel;
+    std::atomic<Level> currentLevel;
+    std::atomic<bool> async;
     std::mutex mutex;
     bool consoleOutput;
 };
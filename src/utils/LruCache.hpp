@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace havel {
+
+// Fixed-capacity map that evicts the least recently used entry.
+// Not synchronized; callers that share one guard it themselves.
+template<typename K, typename V>
+class LruCache {
+public:
+    explicit LruCache(size_t capacity) : capacity(capacity ? capacity : 1) {}
+
+    // Value for `key`, marking it most recently used; nullptr on a miss
+    V *Find(const K &key) {
+        auto it = index.find(key);
+        if (it == index.end()) {
+            return nullptr;
+        }
+        items.splice(items.begin(), items, it->second);
+        return &it->second->second;
+    }
+
+    void Put(const K &key, V value) {
+        auto it = index.find(key);
+        if (it != index.end()) {
+            it->second->second = std::move(value);
+            items.splice(items.begin(), items, it->second);
+            return;
+        }
+
+        items.emplace_front(key, std::move(value));
+        index.emplace(key, items.begin());
+        if (items.size() > capacity) {
+            index.erase(items.back().first);
+            items.pop_back();
+        }
+    }
+
+    void Clear() {
+        items.clear();
+        index.clear();
+    }
+
+    size_t Size() const { return items.size(); }
+    size_t Capacity() const { return capacity; }
+
+private:
+    using Item = std::pair<K, V>;
+
+    size_t capacity;
+    std::list<Item> items; // Most recently used first
+    std::unordered_map<K, typename std::list<Item>::iterator> index;
+};
+
+} // namespace havel
@@ -1,5 +1,9 @@
 #include "Window.hpp"
 #include "WindowManager.hpp"
+#include "WindowCache.hpp"
+#include "WindowIndex.hpp"
+#include "WindowQuery.hpp"
+#include "../core/DisplayManager.hpp"
 #include <iostream>
 #include <sstream>
 #include <memory>
@@ -19,34 +23,14 @@
 #include <X11/Xutil.h>
 
 // Initialize static members
-std::shared_ptr<Display> havel::Window::display;
 havel::DisplayServer havel::Window::displayServer = havel::DisplayServer::X11;
-
-// Custom deleter for Display
-struct DisplayDeleter {
-    void operator()(Display* d) {
-        if (d) {
-            XCloseDisplay(d);
-        }
-    }
-};
 #endif
 
 namespace havel {
 
-// Constructor
-Window::Window(cstr title, wID id) : m_title(title), m_id(id) {
-    #ifdef __linux__
-    if (!display) {
-        Display* rawDisplay = XOpenDisplay(nullptr);
-        if (!rawDisplay) {
-            std::cerr << "Failed to open X11 display" << std::endl;
-            return;
-        }
-        display = std::shared_ptr<Display>(rawDisplay, DisplayDeleter());
-    }
-    #endif
-}
+// Constructor; X calls go through the calling thread's own connection
+// (DisplayManager::GetThreadDisplay), opened on first use
+Window::Window(cstr title, wID id) : m_title(title), m_id(id) {}
 
 // Get the position of a window
 Rect Window::Pos() const {
@@ -85,10 +69,11 @@ Rect Window::GetPositionWindows(wID win) {
 
 // X11 implementation of GetPosition
 Rect Window::GetPositionX11(wID win) {
+    Display* display = DisplayManager::GetThreadDisplay();
     if (!display) return {};
     
     XWindowAttributes attrs;
-    if(XGetWindowAttributes(display.get(), win, &attrs)) {
+    if(XGetWindowAttributes(display, win, &attrs)) {
         return {attrs.x, attrs.y, attrs.width, attrs.height};
     }
     return {};
@@ -155,54 +140,19 @@ wID Window::Find(cstr identifier) {
 // Find a window by its title
 wID Window::FindByTitle(cstr title) {
     #ifdef __linux__
+    if (WindowCache::Get().Live()) {
+        auto snapshot = WindowCache::Get().Load();
+        const WindowInfo *info = snapshot->Index().FindTitleContaining(title);
+        return info ? static_cast<wID>(info->windowId) : 0;
+    }
+
+    Display* display = DisplayManager::GetThreadDisplay();
     if (!display) return 0;
-    
-    ::Window rootWindow = DefaultRootWindow(display.get());
-    ::Window parent;
-    ::Window* children;
-    unsigned int numChildren;
-    
-    if (XQueryTree(display.get(), rootWindow, &rootWindow, &parent, &children, &numChildren)) {
-        if (children) {
-            for (unsigned int i = 0; i < numChildren; i++) {
-                XTextProperty windowName;
-                if (XGetWMName(display.get(), children[i], &windowName) && windowName.value) {
-                    std::string windowTitle = reinterpret_cast<char*>(windowName.value);
-                    XFree(windowName.value);
-                    
-                    if (windowTitle.find(title) != std::string::npos) {
-                        ::Window result = children[i];
-                        XFree(children);
-                        return static_cast<wID>(result);
-                    }
-                }
-                
-                // Try NET_WM_NAME for modern window managers
-                Atom nameAtom = XInternAtom(display.get(), "_NET_WM_NAME", False);
-                Atom utf8Atom = XInternAtom(display.get(), "UTF8_STRING", False);
-                
-                if (nameAtom != None && utf8Atom != None) {
-                    Atom actualType;
-                    int actualFormat;
-                    unsigned long nitems, bytesAfter;
-                    unsigned char* prop = nullptr;
-                    
-                    if (XGetWindowProperty(display.get(), children[i], nameAtom, 0, 1024, False, utf8Atom,
-                                          &actualType, &actualFormat, &nitems, &bytesAfter, &prop) == Success) {
-                        if (prop) {
-                            std::string windowTitle(reinterpret_cast<char*>(prop));
-                            if (windowTitle.find(title) != std::string::npos) {
-                                ::Window result = children[i];
-                                XFree(prop);
-                                XFree(children);
-                                return static_cast<wID>(result);
-                            }
-                            XFree(prop);
-                        }
-                    }
-                }
-            }
-            XFree(children);
+
+    WindowQuery query(display);
+    for (const auto &info : query.Fetch(query.TopLevelWindows(), WindowQuery::Title)) {
+        if (info.title.find(title) != std::string::npos) {
+            return static_cast<wID>(info.windowId);
         }
     }
     #endif
@@ -212,46 +162,20 @@ wID Window::FindByTitle(cstr title) {
 // Find a window by its class
 wID Window::FindByClass(cstr className) {
     #ifdef __linux__
+    if (WindowCache::Get().Live()) {
+        auto snapshot = WindowCache::Get().Load();
+        const WindowInfo *info = snapshot->Index().FindClassContaining(className);
+        return info ? static_cast<wID>(info->windowId) : 0;
+    }
+
+    Display* display = DisplayManager::GetThreadDisplay();
     if (!display) return 0;
-    
-    ::Window rootWindow = DefaultRootWindow(display.get());
-    ::Window parent;
-    ::Window* children;
-    unsigned int numChildren;
-    
-    if (XQueryTree(display.get(), rootWindow, &rootWindow, &parent, &children, &numChildren)) {
-        if (children) {
-            for (unsigned int i = 0; i < numChildren; i++) {
-                XClassHint classHint;
-                if (XGetClassHint(display.get(), children[i], &classHint)) {
-                    bool match = false;
-                    
-                    if (classHint.res_name && strstr(classHint.res_name, className.c_str()) != nullptr) {
-                        match = true;
-                    }
-                    else if (classHint.res_class && strstr(classHint.res_class, className.c_str()) != nullptr) {
-                        match = true;
-                    }
-                    
-                    // Debug logging
-                    if (match) {
-                        std::cout << "Found window with class matching '" << className 
-                                  << "': res_name='" << (classHint.res_name ? classHint.res_name : "NULL") 
-                                  << "', res_class='" << (classHint.res_class ? classHint.res_class : "NULL") 
-                                  << "'" << std::endl;
-                    }
-                    
-                    if (classHint.res_name) XFree(classHint.res_name);
-                    if (classHint.res_class) XFree(classHint.res_class);
-                    
-                    if (match) {
-                        ::Window result = children[i];
-                        XFree(children);
-                        return static_cast<wID>(result);
-                    }
-                }
-            }
-            XFree(children);
+
+    WindowQuery query(display);
+    for (const auto &info : query.Fetch(query.TopLevelWindows(), WindowQuery::Class)) {
+        if (info.instance.find(className) != std::string::npos ||
+            info.windowClass.find(className) != std::string::npos) {
+            return static_cast<wID>(info.windowId);
         }
     }
     #endif
@@ -272,12 +196,13 @@ std::string Window::Title(wID win) {
     }
     return "";
 #elif defined(__linux__)
+    Display* display = DisplayManager::GetThreadDisplay();
     if (!display) {
         std::cerr << "Failed to open X11 display." << std::endl;
         return "";
     }
 
-    Atom wmName = XInternAtom(display.get(), "_NET_WM_NAME", True);
+    Atom wmName = DisplayManager::InternAtom(display, "_NET_WM_NAME", true);
     if (wmName == None) {
         return "";
     }
@@ -287,7 +212,7 @@ std::string Window::Title(wID win) {
     unsigned long nitems, bytesAfter;
     unsigned char* prop = nullptr;
 
-    if (XGetWindowProperty(display.get(), win, wmName, 0, (~0L), False, AnyPropertyType,
+    if (XGetWindowProperty(display, win, wmName, 0, (~0L), False, AnyPropertyType,
                            &actualType, &actualFormat, &nitems, &bytesAfter, &prop) == Success) {
         if (prop) {
             std::string title(reinterpret_cast<char*>(prop));
@@ -323,13 +248,16 @@ bool Window::Active(wID win) {
 #if defined(WINDOWS)
     return GetForegroundWindow() == reinterpret_cast<HWND>(win);
 #elif defined(__linux__)
-    Display* localDisplay = XOpenDisplay(nullptr);
-    if (!localDisplay) return false;
+    if (WindowCache::Get().Live()) {
+        return WindowCache::Get().Load()->ActiveId() == win;
+    }
+
+    Display* display = DisplayManager::GetThreadDisplay();
+    if (!display) return false;
 
     wID active = 0;
-    Atom activeAtom = XInternAtom(localDisplay, "_NET_ACTIVE_WINDOW", True);
+    Atom activeAtom = DisplayManager::InternAtom(display, "_NET_ACTIVE_WINDOW", true);
     if (activeAtom == None) {
-        XCloseDisplay(localDisplay);
         return false;
     }
 
@@ -338,16 +266,14 @@ bool Window::Active(wID win) {
     unsigned long nitems, bytesAfter;
     unsigned char* prop = nullptr;
 
-    if (XGetWindowProperty(localDisplay, DefaultRootWindow(localDisplay), activeAtom, 0, (~0L), False, AnyPropertyType,
+    if (XGetWindowProperty(display, DefaultRootWindow(display), activeAtom, 0, (~0L), False, AnyPropertyType,
                            &actualType, &actualFormat, &nitems, &bytesAfter, &prop) == Success) {
         if (prop) {
             active = *reinterpret_cast<wID*>(prop);
             XFree(prop);
-            XCloseDisplay(localDisplay);
             return active == win;
         }
     }
-    XCloseDisplay(localDisplay);
     return false;
 #else
     return false;
@@ -361,12 +287,11 @@ bool Window::Exists(wID win) {
 #ifdef WINDOWS
     return IsWindow(reinterpret_cast<HWND>(win)) != 0;
 #elif defined(__linux__)
-    Display* localDisplay = XOpenDisplay(nullptr);
-    if (!localDisplay) return false;
+    Display* display = DisplayManager::GetThreadDisplay();
+    if (!display) return false;
 
     XWindowAttributes attr;
-    bool exists = XGetWindowAttributes(localDisplay, win, &attr) != 0;
-    XCloseDisplay(localDisplay);
+    bool exists = XGetWindowAttributes(display, win, &attr) != 0;
     return exists;
 #elif defined(__linux__) && defined(__WAYLAND__)
     // Wayland does not provide a direct API to check window existence.
@@ -388,10 +313,10 @@ void Window::Activate(wID win) {
     }
 #elif defined(__linux__)
     // X11 implementation
-    Display* localDisplay = XOpenDisplay(nullptr);
-    if (!localDisplay) return;
+    Display* display = DisplayManager::GetThreadDisplay();
+    if (!display) return;
 
-    Atom activeAtom = XInternAtom(localDisplay, "_NET_ACTIVE_WINDOW", True);
+    Atom activeAtom = DisplayManager::InternAtom(display, "_NET_ACTIVE_WINDOW", true);
     if (activeAtom != None) {
         XEvent event = {};
         event.xclient.type = ClientMessage;
@@ -401,12 +326,11 @@ void Window::Activate(wID win) {
         event.xclient.data.l[0] = 1; // Source indication: 1 (application)
         event.xclient.data.l[1] = CurrentTime;
 
-        XSendEvent(localDisplay, DefaultRootWindow(localDisplay), False, SubstructureRedirectMask | SubstructureNotifyMask, &event);
-        XFlush(localDisplay);
+        XSendEvent(display, DefaultRootWindow(display), False, SubstructureRedirectMask | SubstructureNotifyMask, &event);
+        XFlush(display);
     } else {
         std::cerr << "Failed to find _NET_ACTIVE_WINDOW atom." << std::endl;
     }
-    XCloseDisplay(localDisplay);
 #elif defined(__linux__) && defined(__WAYLAND__)
     // Wayland implementation using `wmctrl`
     if (win) {
@@ -436,10 +360,10 @@ void Window::Close(wID win) {
         std::cout << "Closed: " << win << std::endl;
     }
 #elif defined(__linux__)
-    Display* localDisplay = XOpenDisplay(nullptr);
-    if (!localDisplay) return;
+    Display* display = DisplayManager::GetThreadDisplay();
+    if (!display) return;
 
-    Atom wmDelete = XInternAtom(localDisplay, "WM_DELETE_WINDOW", True);
+    Atom wmDelete = DisplayManager::InternAtom(display, "WM_DELETE_WINDOW", true);
     if (wmDelete != None) {
         XEvent event = {};
         event.xclient.type = ClientMessage;
@@ -447,10 +371,9 @@ void Window::Close(wID win) {
         event.xclient.format = 32;
         event.xclient.data.l[0] = CurrentTime;
 
-        XSendEvent(localDisplay, win, False, NoEventMask, &event);
-        XFlush(localDisplay);
+        XSendEvent(display, win, False, NoEventMask, &event);
+        XFlush(display);
     }
-    XCloseDisplay(localDisplay);
 #elif defined(__linux__) && defined(__WAYLAND__)
     // Wayland does not provide a universal API for closing windows.
     std::cerr << "Window closing in Wayland is not implemented." << std::endl;
@@ -467,15 +390,14 @@ void Window::Min(wID win) {
         std::cout << "Minimized: " << win << std::endl;
     }
 #elif defined(__linux__) 
-    Display* localDisplay = XOpenDisplay(nullptr);
-    if (!localDisplay) {
+    Display* display = DisplayManager::GetThreadDisplay();
+    if (!display) {
         std::cerr << "Failed to open X display" << std::endl;
         return;
     }
     // XIconifyWindow takes (Display*, Window, int screen_number)
-    XIconifyWindow(localDisplay, win, DefaultScreen(localDisplay));
-    XFlush(localDisplay);  // Ensure the command is sent to the server
-    XCloseDisplay(localDisplay);
+    XIconifyWindow(display, win, DefaultScreen(display));
+    XFlush(display);  // Ensure the command is sent to the server
 #elif defined(__linux__) && defined(__WAYLAND__)
     std::cerr << "Window minimization in Wayland is not implemented." << std::endl;
 #endif
@@ -491,12 +413,12 @@ void Window::Max(wID win) {
         std::cout << "Maximized: " << win << std::endl;
     }
 #elif defined(__linux__)
-    Display* localDisplay = XOpenDisplay(nullptr);
-    if (!localDisplay) return;
+    Display* display = DisplayManager::GetThreadDisplay();
+    if (!display) return;
 
-    Atom wmState = XInternAtom(localDisplay, "_NET_WM_STATE", True);
-    Atom wmMaxVert = XInternAtom(localDisplay, "_NET_WM_STATE_MAXIMIZED_VERT", True);
-    Atom wmMaxHorz = XInternAtom(localDisplay, "_NET_WM_STATE_MAXIMIZED_HORZ", True);
+    Atom wmState = DisplayManager::InternAtom(display, "_NET_WM_STATE", true);
+    Atom wmMaxVert = DisplayManager::InternAtom(display, "_NET_WM_STATE_MAXIMIZED_VERT", true);
+    Atom wmMaxHorz = DisplayManager::InternAtom(display, "_NET_WM_STATE_MAXIMIZED_HORZ", true);
     if (wmState != None && wmMaxVert != None && wmMaxHorz != None) {
         XEvent event = {};
         event.xclient.type = ClientMessage;
@@ -507,10 +429,9 @@ void Window::Max(wID win) {
         event.xclient.data.l[1] = wmMaxVert;
         event.xclient.data.l[2] = wmMaxHorz;
 
-        XSendEvent(localDisplay, DefaultRootWindow(localDisplay), False, SubstructureRedirectMask | SubstructureNotifyMask, &event);
-        XFlush(localDisplay);
+        XSendEvent(display, DefaultRootWindow(display), False, SubstructureRedirectMask | SubstructureNotifyMask, &event);
+        XFlush(display);
     }
-    XCloseDisplay(localDisplay);
 #elif defined(__linux__) && defined(__WAYLAND__)
     // Wayland does not provide a universal API for maximizing windows.
     std::cerr << "Window maximization in Wayland is not implemented." << std::endl;
@@ -527,16 +448,15 @@ void Window::Transparency(wID win, int alpha) {
         SetLayeredWindowAttributes(reinterpret_cast<HWND>(win), 0, alpha, LWA_ALPHA);
     }
 #elif defined(__linux__)
-    Display* localDisplay = XOpenDisplay(nullptr);
-    if (!localDisplay) return;
+    Display* display = DisplayManager::GetThreadDisplay();
+    if (!display) return;
 
-    Atom opacityAtom = XInternAtom(localDisplay, "_NET_WM_WINDOW_OPACITY", False);
+    Atom opacityAtom = DisplayManager::InternAtom(display, "_NET_WM_WINDOW_OPACITY", false);
     if (opacityAtom != None) {
         unsigned long opacity = static_cast<unsigned long>((alpha / 255.0) * 0xFFFFFFFF);
-        XChangeProperty(localDisplay, win, opacityAtom, XA_CARDINAL, 32, PropModeReplace, reinterpret_cast<unsigned char*>(&opacity), 1);
+        XChangeProperty(display, win, opacityAtom, XA_CARDINAL, 32, PropModeReplace, reinterpret_cast<unsigned char*>(&opacity), 1);
     }
-    XFlush(localDisplay);
-    XCloseDisplay(localDisplay);
+    XFlush(display);
 #elif defined(__linux__) && defined(__WAYLAND__)
     // Wayland does not provide a universal API for setting transparency.
     std::cerr << "Transparency control in Wayland is not implemented." << std::endl;
@@ -550,11 +470,11 @@ void Window::AlwaysOnTop(wID win, bool top) {
 #ifdef WINDOWS
     SetWindowPos(reinterpret_cast<HWND>(win), top ? HWND_TOPMOST : HWND_NOTOPMOST, 0, 0, 0, 0, SWP_NOMOVE | SWP_NOSIZE);
 #elif defined(__linux__)
-    Display* localDisplay = XOpenDisplay(nullptr);
-    if (!localDisplay) return;
+    Display* display = DisplayManager::GetThreadDisplay();
+    if (!display) return;
 
-    Atom wmState = XInternAtom(localDisplay, "_NET_WM_STATE", True);
-    Atom wmAbove = XInternAtom(localDisplay, "_NET_WM_STATE_ABOVE", True);
+    Atom wmState = DisplayManager::InternAtom(display, "_NET_WM_STATE", true);
+    Atom wmAbove = DisplayManager::InternAtom(display, "_NET_WM_STATE_ABOVE", true);
     if (wmState != None && wmAbove != None) {
         XEvent event = {};
         event.xclient.type = ClientMessage;
@@ -564,10 +484,9 @@ void Window::AlwaysOnTop(wID win, bool top) {
         event.xclient.data.l[0] = top ? 1 : 0; // Add or Remove
         event.xclient.data.l[1] = wmAbove;
 
-        XSendEvent(localDisplay, DefaultRootWindow(localDisplay), False, SubstructureRedirectMask | SubstructureNotifyMask, &event);
-        XFlush(localDisplay);
+        XSendEvent(display, DefaultRootWindow(display), False, SubstructureRedirectMask | SubstructureNotifyMask, &event);
+        XFlush(display);
     }
-    XCloseDisplay(localDisplay);
 #elif defined(__linux__) && defined(__WAYLAND__)
     // Wayland does not provide a universal API for setting windows on top.
     std::cerr << "AlwaysOnTop in Wayland is not implemented." << std::endl;
@@ -575,10 +494,11 @@ void Window::AlwaysOnTop(wID win, bool top) {
 }
 
 void Window::SetAlwaysOnTopX11(wID win, bool top) {
+    Display* display = DisplayManager::GetThreadDisplay();
     if (!display) return;
 
-    Atom wmState = XInternAtom(display.get(), "_NET_WM_STATE", True);
-    Atom wmAbove = XInternAtom(display.get(), "_NET_WM_STATE_ABOVE", True);
+    Atom wmState = DisplayManager::InternAtom(display, "_NET_WM_STATE", true);
+    Atom wmAbove = DisplayManager::InternAtom(display, "_NET_WM_STATE_ABOVE", true);
     
     if(wmState != None && wmAbove != None) {
         XEvent event = {};
@@ -589,24 +509,25 @@ void Window::SetAlwaysOnTopX11(wID win, bool top) {
         event.xclient.data.l[0] = top ? 1 : 0;
         event.xclient.data.l[1] = wmAbove;
         
-        XSendEvent(display.get(), DefaultRootWindow(display.get()), False,
+        XSendEvent(display, DefaultRootWindow(display), False,
                   SubstructureRedirectMask | SubstructureNotifyMask, &event);
-        XFlush(display.get());
+        XFlush(display);
     }
 }
 
 // Find a window by its process ID
 wID Window::GetwIDByPID(pID pid) {
+    Display* display = DisplayManager::GetThreadDisplay();
     if (!display) return 0;
     
-    ::Window rootWindow = DefaultRootWindow(display.get());
+    ::Window rootWindow = DefaultRootWindow(display);
     ::Window parent;
     ::Window* children;
     unsigned int numChildren;
     
-    if (XQueryTree(display.get(), rootWindow, &rootWindow, &parent, &children, &numChildren)) {
+    if (XQueryTree(display, rootWindow, &rootWindow, &parent, &children, &numChildren)) {
         if (children) {
-            Atom pidAtom = XInternAtom(display.get(), "_NET_WM_PID", False);
+            Atom pidAtom = DisplayManager::InternAtom(display, "_NET_WM_PID", false);
             
             for (unsigned int i = 0; i < numChildren; i++) {
                 Atom actualType;
@@ -614,7 +535,7 @@ wID Window::GetwIDByPID(pID pid) {
                 unsigned long nitems, bytesAfter;
                 unsigned char* prop = nullptr;
                 
-                if (XGetWindowProperty(display.get(), children[i], pidAtom, 0, 1, False, XA_CARDINAL,
+                if (XGetWindowProperty(display, children[i], pidAtom, 0, 1, False, XA_CARDINAL,
                                       &actualType, &actualFormat, &nitems, &bytesAfter, &prop) == Success) {
                     if (prop && nitems == 1) {
                         pID windowPid = *reinterpret_cast<pID*>(prop);
@@ -17,9 +17,7 @@ public:
     Window(cstr title, wID id = 0);
     ~Window() = default;
 
-    // Static display pointer
     #ifdef __linux__
-    static std::shared_ptr<Display> display;
     static DisplayServer displayServer;
     #endif
 
@@ -0,0 +1,66 @@
+#include "WindowCache.hpp"
+#include "WindowIndex.hpp"
+
+namespace havel {
+
+const WindowInfo *WindowCache::Snapshot::Find(wID window) const {
+    auto it = windows.find(window);
+    if (it != windows.end()) {
+        return it->second.get();
+    }
+    if (active && active->windowId == window) {
+        return active.get();
+    }
+    return nullptr;
+}
+
+const WindowIndex &WindowCache::Snapshot::Index() const {
+    std::call_once(index.once, [this]() {
+        index.built = std::make_shared<const WindowIndex>(windows);
+    });
+    return *index.built;
+}
+
+const WindowInfo *WindowCache::Snapshot::FindByClass(std::string_view className) const {
+    return Index().FindByClass(className);
+}
+
+const WindowInfo *WindowCache::Snapshot::FindByTitle(std::string_view title) const {
+    return Index().FindByTitle(title);
+}
+
+const WindowInfo *WindowCache::Snapshot::FindByPid(pid_t pid) const {
+    return Index().FindByPid(pid);
+}
+
+const WindowInfo *WindowCache::Snapshot::FindByProcess(std::string_view processName) const {
+    return Index().FindByProcess(processName);
+}
+
+WindowCache::WindowCache() : current(std::make_shared<const Snapshot>()) {
+}
+
+WindowCache &WindowCache::Get() {
+    static WindowCache cache;
+    return cache;
+}
+
+void WindowCache::SetLive(bool value) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    if (!value) {
+        auto empty = std::make_shared<Snapshot>();
+        empty->version = current.load(std::memory_order_relaxed)->version + 1;
+        current.store(std::move(empty), std::memory_order_release);
+    }
+    live.store(value, std::memory_order_release);
+}
+
+void WindowCache::Update(const std::function<void(Snapshot&)> &change) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    auto next = std::make_shared<Snapshot>(*current.load(std::memory_order_relaxed));
+    change(*next);
+    ++next->version;
+    current.store(std::move(next), std::memory_order_release);
+}
+
+} // namespace havel
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "types.hpp"
+#include <sys/types.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace havel {
+
+class WindowIndex;
+
+// Flags from _NET_WM_STATE
+enum WindowState : uint8_t {
+    WindowFullscreen = 1 << 0,
+    WindowMaximized = 1 << 1,   // Both vertically and horizontally
+    WindowHidden = 1 << 2,      // Minimized or on another desktop
+    WindowAbove = 1 << 3
+};
+
+struct WindowInfo {
+    std::string title;
+    std::string windowClass;    // WM_CLASS res_class
+    std::string instance;       // WM_CLASS res_name
+    std::string processName;    // /proc/<pid>/comm
+    pid_t pid{0};
+    unsigned long windowId{0};
+    Rect geometry;              // In root window coordinates
+    uint8_t state{0};           // WindowState flags
+    std::chrono::steady_clock::time_point lastUpdate;
+    bool isValid{false}; // Validity flag
+
+    bool Has(WindowState flag) const { return state & flag; }
+};
+
+// Add operator== for WindowInfo
+inline bool operator==(const WindowInfo& lhs, const WindowInfo& rhs) {
+    return lhs.windowId == rhs.windowId &&
+           lhs.pid == rhs.pid &&
+           lhs.title == rhs.title &&
+           lhs.windowClass == rhs.windowClass &&
+           lhs.instance == rhs.instance &&
+           lhs.processName == rhs.processName &&
+           lhs.geometry.x == rhs.geometry.x &&
+           lhs.geometry.y == rhs.geometry.y &&
+           lhs.geometry.width == rhs.geometry.width &&
+           lhs.geometry.height == rhs.geometry.height &&
+           lhs.state == rhs.state;
+}
+
+// The properties of every top-level window, shared by the whole process.
+//
+// A WindowMonitor keeps it current from X events. Readers load an
+// immutable snapshot and query it without X round trips; a snapshot stays
+// valid for as long as it is held, however many updates are published
+// meanwhile. The load is one std::atomic<std::shared_ptr> load, which is
+// not lock-free (libstdc++ takes a short spin lock around the refcount),
+// but readers never wait for a writer's copy. Writers copy the table
+// (windows are shared between snapshots, so only the map itself is
+// copied), change the copy and publish it, so they should batch their
+// changes into as few updates as they can.
+//
+// While no event source is running the cache is not Live() and empty, and
+// callers go to the X server themselves.
+class WindowCache {
+public:
+    using Windows = std::unordered_map<wID, std::shared_ptr<const WindowInfo>>;
+
+    struct Snapshot {
+        Windows windows;
+        // Not necessarily in `windows`: it may not be a managed client
+        std::shared_ptr<const WindowInfo> active;
+        uint64_t version = 0;
+
+        wID ActiveId() const { return active ? active->windowId : 0; }
+        const WindowInfo *Find(wID window) const;
+
+        // Lookup tables over `windows`, built on first use. Do not call
+        // it on a snapshot that is still being changed.
+        const WindowIndex &Index() const;
+
+        // Lookups with the same matching rules as the WindowManager ones
+        const WindowInfo *FindByClass(std::string_view className) const;
+        const WindowInfo *FindByTitle(std::string_view title) const;
+        const WindowInfo *FindByPid(pid_t pid) const;
+        const WindowInfo *FindByProcess(std::string_view processName) const;
+
+    private:
+        // A copy starts without an index of its own
+        struct LazyIndex {
+            std::once_flag once;
+            std::shared_ptr<const WindowIndex> built;
+
+            LazyIndex() = default;
+            LazyIndex(const LazyIndex&) {}
+            LazyIndex& operator=(const LazyIndex&) = delete;
+        };
+        mutable LazyIndex index;
+    };
+
+    WindowCache();
+
+    WindowCache(const WindowCache&) = delete;
+    WindowCache& operator=(const WindowCache&) = delete;
+
+    // The process-wide cache
+    static WindowCache &Get();
+
+    // Never null
+    std::shared_ptr<const Snapshot> Load() const {
+        return current.load(std::memory_order_acquire);
+    }
+
+    bool Live() const { return live.load(std::memory_order_acquire); }
+    // Going offline also drops everything cached
+    void SetLive(bool value);
+
+    // Apply `change` to a copy of the current snapshot and publish it.
+    // Writers are serialized; readers never wait for the copy.
+    void Update(const std::function<void(Snapshot&)> &change);
+
+private:
+    std::atomic<std::shared_ptr<const Snapshot>> current;
+    std::atomic<bool> live{false};
+    std::mutex writeMutex;
+};
+
+} // namespace havel
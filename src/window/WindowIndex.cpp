@@ -0,0 +1,114 @@
+#include "WindowIndex.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace havel {
+
+static constexpr uint32_t NoEntry = std::numeric_limits<uint32_t>::max();
+
+WindowIndex::WindowIndex(const WindowCache::Windows &windows) {
+    entries.reserve(windows.size());
+    for (const auto &[id, info] : windows) {
+        entries.push_back(info.get());
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const WindowInfo *a, const WindowInfo *b) { return a->windowId < b->windowId; });
+
+    // Positions only grow, so each list stays sorted and a repeat can
+    // only be the last element
+    auto add = [](Postings &postings, uint32_t position) {
+        if (postings.empty() || postings.back() != position) {
+            postings.push_back(position);
+        }
+    };
+    for (uint32_t i = 0; i < entries.size(); ++i) {
+        const WindowInfo &info = *entries[i];
+        if (!info.windowClass.empty()) add(byClass[info.windowClass], i);
+        if (!info.instance.empty()) add(byInstance[info.instance], i);
+        if (!info.processName.empty()) add(byProcess[info.processName], i);
+        if (info.pid > 0) add(byPid[info.pid], i);
+        add(byTitle[info.title], i);
+        for (size_t pos = 0; pos + 3 <= info.title.size(); ++pos) {
+            add(trigrams[Trigram(info.title, pos)], i);
+        }
+    }
+}
+
+const WindowInfo *WindowIndex::First(const StringIndex &index, std::string_view key) const {
+    auto it = index.find(key);
+    return it == index.end() ? nullptr : entries[it->second.front()];
+}
+
+const WindowInfo *WindowIndex::FindByClass(std::string_view name) const {
+    const WindowInfo *byName = First(byClass, name);
+    const WindowInfo *byInst = First(byInstance, name);
+    if (byName && byInst) {
+        return byName->windowId < byInst->windowId ? byName : byInst;
+    }
+    return byName ? byName : byInst;
+}
+
+const WindowInfo *WindowIndex::FindByInstance(std::string_view instance) const {
+    return First(byInstance, instance);
+}
+
+const WindowInfo *WindowIndex::FindByTitle(std::string_view title) const {
+    return First(byTitle, title);
+}
+
+const WindowInfo *WindowIndex::FindByPid(pid_t pid) const {
+    auto it = byPid.find(pid);
+    return it == byPid.end() ? nullptr : entries[it->second.front()];
+}
+
+const WindowInfo *WindowIndex::FindByProcess(std::string_view processName) const {
+    return First(byProcess, processName);
+}
+
+const WindowInfo *WindowIndex::FindTitleContaining(std::string_view text) const {
+    if (text.size() < 3) {
+        for (const WindowInfo *info : entries) {
+            if (info->title.find(text) != std::string::npos) {
+                return info;
+            }
+        }
+        return nullptr;
+    }
+
+    // Every window whose title contains `text` is in all of its trigrams'
+    // lists; the shortest one is the candidate set
+    const Postings *shortest = nullptr;
+    for (size_t pos = 0; pos + 3 <= text.size(); ++pos) {
+        auto it = trigrams.find(Trigram(text, pos));
+        if (it == trigrams.end()) {
+            return nullptr;
+        }
+        if (!shortest || it->second.size() < shortest->size()) {
+            shortest = &it->second;
+        }
+    }
+    for (uint32_t position : *shortest) {
+        if (entries[position]->title.find(text) != std::string::npos) {
+            return entries[position];
+        }
+    }
+    return nullptr;
+}
+
+uint32_t WindowIndex::FirstContaining(const StringIndex &index, std::string_view text) const {
+    // One comparison per distinct name, not per window
+    uint32_t first = NoEntry;
+    for (const auto &[name, postings] : index) {
+        if (postings.front() < first && name.find(text) != std::string::npos) {
+            first = postings.front();
+        }
+    }
+    return first;
+}
+
+const WindowInfo *WindowIndex::FindClassContaining(std::string_view text) const {
+    uint32_t first = std::min(FirstContaining(byInstance, text), FirstContaining(byClass, text));
+    return first == NoEntry ? nullptr : entries[first];
+}
+
+} // namespace havel
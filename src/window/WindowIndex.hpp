@@ -0,0 +1,73 @@
+#pragma once
+
+#include "WindowCache.hpp"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace havel {
+
+// Lookup tables over the windows of one WindowCache snapshot.
+//
+// Exact lookups by class, instance, title, pid and process name are hash
+// probes. A title substring search looks up the posting lists of the
+// text's trigrams and only compares the titles in the shortest one. When
+// several windows match, the one with the lowest id wins, so answers are
+// stable across snapshots. The index points into the snapshot it was
+// built from and must not outlive it.
+class WindowIndex {
+public:
+    explicit WindowIndex(const WindowCache::Windows &windows);
+
+    WindowIndex(const WindowIndex&) = delete;
+    WindowIndex& operator=(const WindowIndex&) = delete;
+
+    // WM_CLASS class or instance
+    const WindowInfo *FindByClass(std::string_view name) const;
+    const WindowInfo *FindByInstance(std::string_view instance) const;
+    const WindowInfo *FindByTitle(std::string_view title) const;
+    const WindowInfo *FindByPid(pid_t pid) const;
+    const WindowInfo *FindByProcess(std::string_view processName) const;
+
+    // Substring matches, as Window::FindByTitle and FindByClass do them
+    const WindowInfo *FindTitleContaining(std::string_view text) const;
+    const WindowInfo *FindClassContaining(std::string_view text) const;
+
+    size_t Size() const { return entries.size(); }
+    size_t Trigrams() const { return trigrams.size(); }
+
+private:
+    // Positions in `entries`, ascending
+    using Postings = std::vector<uint32_t>;
+
+    struct StringHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view text) const {
+            return std::hash<std::string_view>{}(text);
+        }
+    };
+    using StringIndex = std::unordered_map<std::string, Postings, StringHash, std::equal_to<>>;
+
+    static uint32_t Trigram(std::string_view text, size_t pos) {
+        return static_cast<uint32_t>(static_cast<unsigned char>(text[pos])) << 16 |
+               static_cast<uint32_t>(static_cast<unsigned char>(text[pos + 1])) << 8 |
+               static_cast<uint32_t>(static_cast<unsigned char>(text[pos + 2]));
+    }
+
+    const WindowInfo *First(const StringIndex &index, std::string_view key) const;
+    uint32_t FirstContaining(const StringIndex &index, std::string_view text) const;
+
+    // Sorted by window id
+    std::vector<const WindowInfo *> entries;
+    StringIndex byClass;
+    StringIndex byInstance;
+    StringIndex byTitle;
+    StringIndex byProcess;
+    std::unordered_map<pid_t, Postings> byPid;
+    std::unordered_map<uint32_t, Postings> trigrams;
+};
+
+} // namespace havel
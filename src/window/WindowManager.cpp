@@ -1,5 +1,9 @@
 #include "WindowManager.hpp"
+#include "WindowCache.hpp"
+#include "WindowMatcher.hpp"
+#include "WindowQuery.hpp"
 #include "types.hpp"
+#include "../utils/LruCache.hpp"
 #include "core/DisplayManager.hpp"
 #include "../utils/Logger.hpp"
 #include <iostream>
@@ -7,6 +11,7 @@
 #include <fstream>
 #include <cstring>
 #include <algorithm>
+#include <mutex>
 #include <thread>
 #include <unistd.h>
 #include <sys/wait.h>
@@ -85,16 +90,21 @@ static str defaultTerminal = "Cmd";
 #ifdef _WIN32
     return reinterpret_cast<wID>(GetForegroundWindow());
 #elif defined(__linux__)
-        Display *display = DisplayManager::GetDisplay();
-        if (!display) {
-            if (!WindowManager::InitializeX11()) {
-                return 0;
+        if (WindowCache::Get().Live()) {
+            wID active = WindowCache::Get().Load()->ActiveId();
+            if (active != 0 && active != previousActiveWindow) {
+                UpdatePreviousActiveWindow();
             }
-            display = DisplayManager::GetDisplay();
+            return active;
+        }
+
+        Display *display = DisplayManager::GetThreadDisplay();
+        if (!display) {
+            return 0;
         }
 
-        Atom activeWindowAtom = XInternAtom(display, "_NET_ACTIVE_WINDOW",
-                                            False);
+        Atom activeWindowAtom = DisplayManager::InternAtom(
+            display, "_NET_ACTIVE_WINDOW", false);
         if (activeWindowAtom == None) return 0;
 
         Atom actualType;
@@ -125,38 +135,61 @@ static str defaultTerminal = "Cmd";
 #endif
     }
 
+    std::shared_ptr<const WindowMatcher> WindowManager::CompileIdentifier(cstr identifier) {
+        static std::mutex compiledMutex;
+        static LruCache<std::string, std::shared_ptr<const WindowMatcher>> compiled(256);
+
+        std::lock_guard<std::mutex> lock(compiledMutex);
+        if (auto *matcher = compiled.Find(identifier)) {
+            return *matcher;
+        }
+        auto matcher = std::make_shared<const WindowMatcher>(WindowMatcher::Compile(identifier));
+        compiled.Put(identifier, matcher);
+        return matcher;
+    }
+
     // Method to find a window based on various identifiers
     wID WindowManager::Find(cstr identifier) {
-        std::string type = GetIdentifierType(identifier);
-        std::string value = GetIdentifierValue(identifier);
+        auto matcher = CompileIdentifier(identifier);
+        const std::string &value = matcher->Value();
+
+        switch (matcher->GetKind()) {
+            case WindowMatcher::Kind::Group:
+                return FindWindowInGroup(value);
+            case WindowMatcher::Kind::Id:
+                return matcher->Number();
+            case WindowMatcher::Kind::Invalid:
+                return 0;
+            default:
+                break;
+        }
 
-        if (type == "group") {
-            return FindWindowInGroup(value);
-        } else if (type == "class") {
+        if (WindowCache::Get().Live()) {
+            auto snapshot = WindowCache::Get().Load();
+            const WindowInfo *info = matcher->Find(*snapshot);
+            return info ? info->windowId : 0;
+        }
+
+        switch (matcher->GetKind()) {
+            case WindowMatcher::Kind::Class:
 #ifdef _WIN32
-        return reinterpret_cast<wID>(FindWindowA(value.c_str(), NULL));
-#elif defined(__linux__)
-            return FindByClass(value);
+                return reinterpret_cast<wID>(FindWindowA(value.c_str(), NULL));
+#else
+                return FindByClass(value);
 #endif
-        } else if (type == "pid") {
-            pID pid = std::stoul(value);
-            return GetwIDByPID(pid);
-        } else if (type == "exe") {
-            return GetwIDByProcessName(value);
-        } else if (type == "title") {
-            return FindByTitle(value);
-        } else if (type == "id") {
-            return std::stoul(value);
-        } else {
-            // Default to title search if no type specified
-            return FindByTitle(identifier);
+            case WindowMatcher::Kind::Pid:
+                return GetwIDByPID(matcher->Number());
+            case WindowMatcher::Kind::Exe:
+                return GetwIDByProcessName(value);
+            case WindowMatcher::Kind::Title:
+            default:
+                return FindByTitle(value);
         }
-        return 0; // Unsupported platform
     }
 
     void WindowManager::AltTab() {
 #ifdef __linux__
-        Display *display = XOpenDisplay(nullptr);
+        Display *display = DisplayManager::GetThreadDisplay();
         if (!display) {
             lo.error("Failed to open X display for Alt+Tab");
             return;
@@ -209,15 +242,13 @@ static str defaultTerminal = "Cmd";
             lo.info("Alt+Tab: Looking for an alternative window");
 
             // Get the list of windows
-            Atom clientListAtom = XInternAtom(display,
-                                              "_NET_CLIENT_LIST_STACKING",
-                                              False);
+            Atom clientListAtom = DisplayManager::InternAtom(
+                display, "_NET_CLIENT_LIST_STACKING", false);
             if (clientListAtom == None) {
-                clientListAtom =
-                        XInternAtom(display, "_NET_CLIENT_LIST", False);
+                clientListAtom = DisplayManager::InternAtom(
+                    display, "_NET_CLIENT_LIST", false);
                 if (clientListAtom == None) {
                     lo.error("Failed to get window list atom");
-                    XCloseDisplay(display);
                     return;
                 }
             }
@@ -235,7 +266,6 @@ static str defaultTerminal = "Cmd";
                 numWindows < 1) {
                 if (data) XFree(data);
                 lo.error("Failed to get window list or empty list");
-                XCloseDisplay(display);
                 return;
             }
 
@@ -252,8 +282,8 @@ static str defaultTerminal = "Cmd";
                     if (XGetWindowAttributes(display, windows[idx], &attrs) &&
                         attrs.map_state == IsViewable) {
                         // Check if this is a normal window (not a desktop, dock, etc.)
-                        Atom windowTypeAtom = XInternAtom(
-                            display, "_NET_WM_WINDOW_TYPE", False);
+                        Atom windowTypeAtom = DisplayManager::InternAtom(
+                            display, "_NET_WM_WINDOW_TYPE", false);
                         Atom actualType;
                         int actualFormat;
                         unsigned long numItems, bytesAfter;
@@ -268,10 +298,10 @@ static str defaultTerminal = "Cmd";
                                                &typeData) == Success &&
                             typeData) {
                             Atom *types = reinterpret_cast<Atom *>(typeData);
-                            Atom normalAtom = XInternAtom(
-                                display, "_NET_WM_WINDOW_TYPE_NORMAL", False);
-                            Atom dialogAtom = XInternAtom(
-                                display, "_NET_WM_WINDOW_TYPE_DIALOG", False);
+                            Atom normalAtom = DisplayManager::InternAtom(
+                                display, "_NET_WM_WINDOW_TYPE_NORMAL", false);
+                            Atom dialogAtom = DisplayManager::InternAtom(
+                                display, "_NET_WM_WINDOW_TYPE_DIALOG", false);
 
                             isNormalWindow = false;
                             for (unsigned long j = 0; j < numItems; j++) {
@@ -323,8 +353,8 @@ static str defaultTerminal = "Cmd";
 
         // Activate the selected window
         if (windowToActivate != None) {
-            Atom activeWindowAtom = XInternAtom(display, "_NET_ACTIVE_WINDOW",
-                                                False);
+            Atom activeWindowAtom = DisplayManager::InternAtom(
+                display, "_NET_ACTIVE_WINDOW", false);
             if (activeWindowAtom != None) {
                 XEvent event = {};
                 event.type = ClientMessage;
@@ -353,7 +383,61 @@ static str defaultTerminal = "Cmd";
         }
 
         XSync(display, False);
-        XCloseDisplay(display);
+#endif
+    }
+
+    // Without the window cache: the top-level windows with the given
+    // WindowQuery fields, all fetched in one batch
+    std::vector<WindowInfo> WindowManager::QueryTopLevelWindows(unsigned fields) {
+#ifdef __linux__
+        Display *display = DisplayManager::GetThreadDisplay();
+        if (!display) {
+            return {};
+        }
+        WindowQuery query(display);
+        return query.Fetch(query.TopLevelWindows(), fields);
+#else
+        return {};
+#endif
+    }
+
+    // Log every client, topmost last, with everything WindowQuery reads;
+    // one batched query however many windows there are
+    void WindowManager::WindowSpy() {
+#ifdef __linux__
+        Display *display = DisplayManager::GetThreadDisplay();
+        if (!display) {
+            return;
+        }
+
+        WindowQuery query(display);
+        wID active = query.ActiveWindow();
+        std::vector<WindowInfo> windows = query.Fetch(query.ClientList(true));
+        lo.info("Window spy: " + std::to_string(windows.size()) + " clients");
+
+        for (const auto &info : windows) {
+            std::string state;
+            for (auto [flag, name] : {std::pair{WindowFullscreen, "fullscreen"},
+                                      std::pair{WindowMaximized, "maximized"},
+                                      std::pair{WindowHidden, "hidden"},
+                                      std::pair{WindowAbove, "above"}}) {
+                if (info.Has(flag)) {
+                    state += state.empty() ? name : std::string(",") + name;
+                }
+            }
+
+            std::ostringstream line;
+            line << (info.windowId == active ? "* " : "  ")
+                 << "0x" << std::hex << info.windowId << std::dec
+                 << " class=" << info.windowClass
+                 << " instance=" << info.instance
+                 << " pid=" << info.pid << " (" << info.processName << ")"
+                 << " geometry=" << info.geometry.width << "x" << info.geometry.height
+                 << "+" << info.geometry.x << "+" << info.geometry.y
+                 << " state=" << (state.empty() ? "normal" : state)
+                 << " title=\"" << info.title << "\"";
+            lo.info(line.str());
+        }
 #endif
     }
 
@@ -363,47 +447,16 @@ static str defaultTerminal = "Cmd";
     // Windows implementation would go here
     return hwnd;
 #elif defined(__linux__)
-        Display *display = DisplayManager::GetDisplay();
-        if (!display) {
-            if (!WindowManager::InitializeX11()) {
-                return 0;
-            }
+        if (WindowCache::Get().Live()) {
+            auto snapshot = WindowCache::Get().Load();
+            const WindowInfo *info = snapshot->FindByPid(static_cast<pid_t>(pid));
+            return info ? info->windowId : 0;
         }
 
-        Atom pidAtom = XInternAtom(DisplayManager::GetDisplay(), "_NET_WM_PID",
-                                   True);
-        if (pidAtom == None) {
-            std::cerr << "X11 does not support _NET_WM_PID." << std::endl;
-            return 0;
-        }
-
-        Window root = DefaultRootWindow(display);
-        Window parent, *children;
-        unsigned int nchildren;
-
-        if (XQueryTree(display, root, &root, &parent, &children, &nchildren)) {
-            for (unsigned int i = 0; i < nchildren; i++) {
-                Atom actualType;
-                int actualFormat;
-                unsigned long nItems, bytesAfter;
-                unsigned char *propPID = nullptr;
-
-                if (XGetWindowProperty(display, children[i], pidAtom, 0, 1,
-                                       False, XA_CARDINAL,
-                                       &actualType, &actualFormat, &nItems,
-                                       &bytesAfter, &propPID) == Success) {
-                    if (nItems > 0) {
-                        pid_t windowPID = *reinterpret_cast<pid_t *>(propPID);
-                        if (windowPID == pid) {
-                            XFree(propPID);
-                            XFree(children);
-                            return reinterpret_cast<wID>(children[i]);
-                        }
-                    }
-                    if (propPID) XFree(propPID);
-                }
+        for (const auto &info : QueryTopLevelWindows(WindowQuery::Pid)) {
+            if (info.pid > 0 && static_cast<pID>(info.pid) == pid) {
+                return info.windowId;
             }
-            XFree(children);
         }
         return 0;
 #else
@@ -416,47 +469,16 @@ static str defaultTerminal = "Cmd";
     // Windows implementation would go here
     return 0;
 #elif defined(__linux__)
-        Display *display = DisplayManager::GetDisplay();
-        if (!display) {
-            if (!WindowManager::InitializeX11()) {
-                return 0;
-            }
-        }
-
-        Atom pidAtom = XInternAtom(DisplayManager::GetDisplay(), "_NET_WM_PID",
-                                   True);
-        if (pidAtom == None) {
-            std::cerr << "X11 does not support _NET_WM_PID." << std::endl;
-            return 0;
+        if (WindowCache::Get().Live()) {
+            auto snapshot = WindowCache::Get().Load();
+            const WindowInfo *info = snapshot->FindByProcess(processName);
+            return info ? info->windowId : 0;
         }
 
-        Window root = DefaultRootWindow(display);
-        Window parent, *children;
-        unsigned int nchildren;
-
-        if (XQueryTree(display, root, &root, &parent, &children, &nchildren)) {
-            for (unsigned int i = 0; i < nchildren; i++) {
-                Atom actualType;
-                int actualFormat;
-                unsigned long nItems, bytesAfter;
-                unsigned char *propPID = nullptr;
-
-                if (XGetWindowProperty(display, children[i], pidAtom, 0, 1,
-                                       False, XA_CARDINAL,
-                                       &actualType, &actualFormat, &nItems,
-                                       &bytesAfter, &propPID) == Success) {
-                    if (nItems > 0) {
-                        pid_t windowPID = *reinterpret_cast<pid_t *>(propPID);
-                        std::string procName = getProcessName(windowPID);
-                        if (procName == processName) {
-                            XFree(children);
-                            return reinterpret_cast<wID>(children[i]);
-                        }
-                    }
-                    if (propPID) XFree(propPID);
-                }
+        for (const auto &info : QueryTopLevelWindows(WindowQuery::Pid)) {
+            if (info.pid > 0 && info.processName == processName) {
+                return info.windowId;
             }
-            XFree(children);
         }
         return 0;
 #else
@@ -470,45 +492,15 @@ static str defaultTerminal = "Cmd";
     // Windows implementation would go here
     return 0;
 #elif defined(__linux__)
-        Display *display = DisplayManager::GetDisplay();
-        if (!display) {
-            if (!WindowManager::InitializeX11()) {
-                return 0;
-            }
+        if (WindowCache::Get().Live()) {
+            auto snapshot = WindowCache::Get().Load();
+            const WindowInfo *info = snapshot->FindByClass(className);
+            return info ? info->windowId : 0;
         }
 
-        Window rootWindow = DisplayManager::GetRootWindow();
-        Window parent;
-        Window *children;
-        unsigned int numChildren;
-
-        if (XQueryTree(display, rootWindow, &rootWindow, &parent, &children,
-                       &numChildren)) {
-            if (children) {
-                for (unsigned int i = 0; i < numChildren; i++) {
-                    XClassHint classHint;
-                    if (XGetClassHint(display, children[i], &classHint)) {
-                        bool match = false;
-
-                        if (classHint.res_name && strcmp(
-                                classHint.res_name, className.c_str()) == 0) {
-                            match = true;
-                        } else if (classHint.res_class && strcmp(
-                                       classHint.res_class,
-                                       className.c_str()) == 0) {
-                            match = true;
-                        }
-
-                        if (classHint.res_name) XFree(classHint.res_name);
-                        if (classHint.res_class) XFree(classHint.res_class);
-
-                        if (match) {
-                            XFree(children);
-                            return children[i];
-                        }
-                    }
-                }
-                XFree(children);
+        for (const auto &info : QueryTopLevelWindows(WindowQuery::Class)) {
+            if (info.instance == className || info.windowClass == className) {
+                return info.windowId;
             }
         }
         return 0;
@@ -522,32 +514,16 @@ static str defaultTerminal = "Cmd";
     // Windows implementation would go here
     return 0;
 #elif defined(__linux__)
-        Display *display = DisplayManager::GetDisplay();
-        if (!display) {
-            if (!WindowManager::InitializeX11()) {
-                return 0;
-            }
+        if (WindowCache::Get().Live()) {
+            auto snapshot = WindowCache::Get().Load();
+            const WindowInfo *info = snapshot->FindByTitle(title);
+            return info ? info->windowId : 0;
         }
 
-        Window root = DefaultRootWindow(display);
-        Window parent, *children;
-        unsigned int nchildren;
-
-        if (XQueryTree(display, root, &root, &parent, &children, &nchildren)) {
-            for (unsigned int i = 0; i < nchildren; i++) {
-                char *windowName = nullptr;
-                if (XFetchName(display, children[i], &windowName) &&
-                    windowName) {
-                    bool match = (title == windowName);
-                    XFree(windowName);
-
-                    if (match) {
-                        XFree(children);
-                        return reinterpret_cast<wID>(children[i]);
-                    }
-                }
+        for (const auto &info : QueryTopLevelWindows(WindowQuery::Title)) {
+            if (info.title == title) {
+                return info.windowId;
             }
-            XFree(children);
         }
         return 0;
 #endif
@@ -604,12 +580,12 @@ static str defaultTerminal = "Cmd";
     // Windows implementation would go here
     return 0;
 #elif defined(__linux__)
-        Display *display = DisplayManager::GetDisplay();
-        if (!display) {
-            if (!WindowManager::InitializeX11()) {
-                return 0;
-            }
+        // The window lives as long as the connection that created it, so it
+        // goes on the shared one rather than this thread's
+        if (!InitializeX11()) {
+            return 0;
         }
+        Display *display = DisplayManager::GetDisplay();
 
         int screen = DefaultScreen(display);
         Window root = RootWindow(display, screen);
@@ -676,15 +652,13 @@ bool WindowManager::CreateProcessWrapper(cstr path, cstr command, pID creationFl
     std::string WindowManager::DetectWindowManager() const {
 #ifdef __linux__
         // Try to get window manager name from _NET_SUPPORTING_WM_CHECK
-        Display *display = DisplayManager::GetDisplay();
-        if (!display) {
-            const_cast<WindowManager *>(this)->InitializeX11();
-            if (!display) return "Unknown";
-        }
+        Display *display = DisplayManager::GetThreadDisplay();
+        if (!display) return "Unknown";
 
-        Atom netSupportingWmCheck = XInternAtom(
-            display, "_NET_SUPPORTING_WM_CHECK", False);
-        Atom netWmName = XInternAtom(display, "_NET_WM_NAME", False);
+        Atom netSupportingWmCheck = DisplayManager::InternAtom(
+            display, "_NET_SUPPORTING_WM_CHECK", false);
+        Atom netWmName = DisplayManager::InternAtom(
+            display, "_NET_WM_NAME", false);
 
         if (netSupportingWmCheck != None && netWmName != None) {
             Atom actualType;
@@ -703,8 +677,8 @@ bool WindowManager::CreateProcessWrapper(cstr path, cstr command, pID creationFl
 
                 if (XGetWindowProperty(display, wmWindow, netWmName, 0, 1024,
                                        False,
-                                       XInternAtom(
-                                           display, "UTF8_STRING", False),
+                                       DisplayManager::InternAtom(
+                                           display, "UTF8_STRING", false),
                                        &actualType, &actualFormat,
                                        &nItems, &bytesAfter,
                                        &data) == Success && data) {
@@ -723,12 +697,15 @@ bool WindowManager::CreateProcessWrapper(cstr path, cstr command, pID creationFl
 
     bool WindowManager::CheckWMProtocols() const {
 #ifdef __linux__
-        Display *display = DisplayManager::GetDisplay();
+        Display *display = DisplayManager::GetThreadDisplay();
         if (!display) return false;
 
-        Atom wmProtocols = XInternAtom(display, "WM_PROTOCOLS", False);
-        Atom wmDeleteWindow = XInternAtom(display, "WM_DELETE_WINDOW", False);
-        Atom wmTakeFocus = XInternAtom(display, "WM_TAKE_FOCUS", False);
+        Atom wmProtocols = DisplayManager::InternAtom(
+            display, "WM_PROTOCOLS", false);
+        Atom wmDeleteWindow = DisplayManager::InternAtom(
+            display, "WM_DELETE_WINDOW", false);
+        Atom wmTakeFocus = DisplayManager::InternAtom(
+            display, "WM_TAKE_FOCUS", false);
 
         if (wmProtocols != None && wmDeleteWindow != None && wmTakeFocus !=
             None) {
@@ -760,7 +737,7 @@ bool WindowManager::CreateProcessWrapper(cstr path, cstr command, pID creationFl
     // Implementation of AHK-like features
     void WindowManager::MoveWindow(int direction, int distance) {
 #ifdef __linux__
-        Display *display = DisplayManager::GetDisplay();
+        Display *display = DisplayManager::GetThreadDisplay();
         if (!display) {
             lo.error("No X11 display available");
             return;
@@ -811,7 +788,7 @@ bool WindowManager::CreateProcessWrapper(cstr path, cstr command, pID creationFl
 
     void WindowManager::ResizeWindow(int direction, int distance) {
 #ifdef __linux__
-        Display *display = DisplayManager::GetDisplay();
+        Display *display = DisplayManager::GetThreadDisplay();
         Window win = GetActiveWindow();
 
         XWindowAttributes attrs;
@@ -853,7 +830,7 @@ bool WindowManager::CreateProcessWrapper(cstr path, cstr command, pID creationFl
     void WindowManager::SnapWindow(int position) {
         // 1=Left, 2=Right, 3=Top, 4=Bottom, 5=TopLeft, 6=TopRight, 7=BottomLeft, 8=BottomRight
 #ifdef __linux__
-        auto *display = DisplayManager::GetDisplay();
+        auto *display = DisplayManager::GetThreadDisplay();
         if (!display) return;
 
         Window root = DisplayManager::GetRootWindow();
@@ -902,16 +879,17 @@ bool WindowManager::CreateProcessWrapper(cstr path, cstr command, pID creationFl
 
     void WindowManager::ManageVirtualDesktops(int action) {
 #ifdef __linux__
-        auto *display = DisplayManager::GetDisplay();
+        auto *display = DisplayManager::GetThreadDisplay();
         if (!display) {
             std::cerr << "Cannot manage desktops - no X11 display\n";
             return;
         }
 
         Window root = DisplayManager::GetRootWindow();
-        Atom desktopAtom = XInternAtom(display, "_NET_CURRENT_DESKTOP", False);
-        Atom desktopCountAtom = XInternAtom(display, "_NET_NUMBER_OF_DESKTOPS",
-                                            False);
+        Atom desktopAtom = DisplayManager::InternAtom(
+            display, "_NET_CURRENT_DESKTOP", false);
+        Atom desktopCountAtom = DisplayManager::InternAtom(
+            display, "_NET_NUMBER_OF_DESKTOPS", false);
 
         unsigned long nitems, bytes;
         unsigned char *data = NULL;
@@ -960,7 +938,7 @@ bool WindowManager::CreateProcessWrapper(cstr path, cstr command, pID creationFl
 
     void WindowManager::SnapWindowWithPadding(int position, int padding) {
 #ifdef __linux__
-        auto *display = DisplayManager::GetDisplay();
+        auto *display = DisplayManager::GetThreadDisplay();
         if (!display) return;
 
         Window win = GetActiveWindow();
@@ -1006,15 +984,17 @@ bool WindowManager::CreateProcessWrapper(cstr path, cstr command, pID creationFl
 
 #ifdef __linux__
         // Check if the window is already on top using X11
-        Display *display = DisplayManager::GetDisplay();
+        Display *display = DisplayManager::GetThreadDisplay();
         if (!display) {
             std::cerr << "X11 display not available" << std::endl;
             return;
         }
 
         // Get the current state
-        Atom wmState = XInternAtom(display, "_NET_WM_STATE", False);
-        Atom wmStateAbove = XInternAtom(display, "_NET_WM_STATE_ABOVE", False);
+        Atom wmState = DisplayManager::InternAtom(
+            display, "_NET_WM_STATE", false);
+        Atom wmStateAbove = DisplayManager::InternAtom(
+            display, "_NET_WM_STATE_ABOVE", false);
 
         if (wmState == None || wmStateAbove == None) {
             std::cerr << "Required X11 atoms not available" << std::endl;
@@ -1067,7 +1047,12 @@ bool WindowManager::CreateProcessWrapper(cstr path, cstr command, pID creationFl
     }
 
     std::string WindowManager::GetActiveWindowClass() {
-        Display *display = DisplayManager::GetDisplay();
+        if (WindowCache::Get().Live()) {
+            auto snapshot = WindowCache::Get().Load();
+            return snapshot->active ? snapshot->active->windowClass : "";
+        }
+
+        Display *display = DisplayManager::GetThreadDisplay();
         if (!display) {
             lo.error("Failed to get display in GetActiveWindowClass");
             return "";
@@ -1100,14 +1085,71 @@ bool WindowManager::CreateProcessWrapper(cstr path, cstr command, pID creationFl
         return className;
     }
 
+    // Owner process of a window, from _NET_WM_PID; 0 if it does not say
+    pID WindowManager::GetWindowPID(wID window) {
+#ifdef __linux__
+        if (WindowCache::Get().Live()) {
+            auto snapshot = WindowCache::Get().Load();
+            const WindowInfo *info = snapshot->Find(window);
+            if (info) {
+                return info->pid;
+            }
+        }
+
+        Display *display = DisplayManager::GetThreadDisplay();
+        if (!display || !window) return 0;
+
+        Atom pidAtom = DisplayManager::InternAtom(display, "_NET_WM_PID", true);
+        if (pidAtom == None) return 0;
+
+        Atom actualType;
+        int actualFormat;
+        unsigned long nitems, bytesAfter;
+        unsigned char *prop = nullptr;
+        pID pid = 0;
+        if (XGetWindowProperty(display, static_cast<Window>(window), pidAtom, 0, 1,
+                               False, XA_CARDINAL, &actualType, &actualFormat,
+                               &nitems, &bytesAfter, &prop) == Success) {
+            if (prop) {
+                if (nitems > 0) {
+                    // Format 32 properties come back as longs
+                    pid = static_cast<pID>(*reinterpret_cast<unsigned long *>(prop));
+                }
+                XFree(prop);
+            }
+        }
+        return pid;
+#else
+        return 0;
+#endif
+    }
+
     // Update previous active window
     void WindowManager::UpdatePreviousActiveWindow() {
 #ifdef __linux__
-        Display *display = DisplayManager::GetDisplay();
+        if (WindowCache::Get().Live()) {
+            auto snapshot = WindowCache::Get().Load();
+            const auto &active = snapshot->active;
+            if (active && active->windowId != 0 &&
+                previousActiveWindow != active->windowId) {
+                previousActiveWindow = active->windowId;
+                activeWindow.id = active->windowId;
+                activeWindow.className = active->windowClass;
+                activeWindow.title = active->title;
+                activeWindow.isFullscreen = active->Has(WindowFullscreen);
+                activeWindow.x = active->geometry.x;
+                activeWindow.y = active->geometry.y;
+                activeWindow.width = active->geometry.width;
+                activeWindow.height = active->geometry.height;
+            }
+            return;
+        }
+
+        Display *display = DisplayManager::GetThreadDisplay();
         if (!display) return;
 
-        Atom activeWindowAtom = XInternAtom(display, "_NET_ACTIVE_WINDOW",
-                                            False);
+        Atom activeWindowAtom = DisplayManager::InternAtom(
+            display, "_NET_ACTIVE_WINDOW", false);
         if (activeWindowAtom == None) return;
 
         Atom actualType;
@@ -1128,6 +1170,7 @@ bool WindowManager::CreateProcessWrapper(cstr path, cstr command, pID creationFl
                 if (currentActive != None && previousActiveWindow !=
                     currentActive) {
                     previousActiveWindow = currentActive;
+                    activeWindow.id = currentActive;
                     std::cout << "Updated previous active window to: " <<
                             previousActiveWindow << std::endl;
                 }
@@ -1137,7 +1180,7 @@ bool WindowManager::CreateProcessWrapper(cstr path, cstr command, pID creationFl
     }
 
     void WindowManager::MoveWindowToNextMonitor() {
-        Display *display = DisplayManager::GetDisplay();
+        Display *display = DisplayManager::GetThreadDisplay();
         if (!display) {
             std::cerr << "No display found.\n";
             return;
@@ -1146,7 +1189,8 @@ bool WindowManager::CreateProcessWrapper(cstr path, cstr command, pID creationFl
         Window root = DefaultRootWindow(display);
 
         // Get active window
-        Atom activeAtom = XInternAtom(display, "_NET_ACTIVE_WINDOW", True);
+        Atom activeAtom = DisplayManager::InternAtom(
+            display, "_NET_ACTIVE_WINDOW", true);
         if (activeAtom == None) {
             std::cerr << "No _NET_ACTIVE_WINDOW atom.\n";
             return;
@@ -1197,8 +1241,10 @@ bool WindowManager::CreateProcessWrapper(cstr path, cstr command, pID creationFl
 
         // Check if window is fullscreen
         bool isFullscreen = false;
-        Atom stateAtom = XInternAtom(display, "_NET_WM_STATE", False);
-        Atom fsAtom = XInternAtom(display, "_NET_WM_STATE_FULLSCREEN", False);
+        Atom stateAtom = DisplayManager::InternAtom(
+            display, "_NET_WM_STATE", false);
+        Atom fsAtom = DisplayManager::InternAtom(
+            display, "_NET_WM_STATE_FULLSCREEN", false);
         Atom typeRet;
         int formatRet;
         unsigned long nItemsRet, bytesAfterRet;
@@ -1336,6 +1382,7 @@ bool WindowManager::CreateProcessWrapper(cstr path, cstr command, pID creationFl
         ev.xclient.data.l[4] = 0;
         XSendEvent(display, DefaultRootWindow(display), False,
                    SubstructureRedirectMask | SubstructureNotifyMask, &ev);
+        XFlush(display);
     }
 
     ProcessMethod WindowManager::toMethod(cstr method) {
@@ -28,6 +28,8 @@ struct EnumWindowsData {
 #endif
 
 namespace havel {
+    class WindowMatcher;
+    struct WindowInfo;
     struct WindowStats {
         wID id;
         std::string className;
@@ -62,6 +64,8 @@ public:
     static XWindow FindByClass(cstr className);
     static XWindow FindByTitle(cstr title);
     static XWindow Find(cstr identifier);
+    // Parsed form of a Find() identifier; the same text compiles once
+    static std::shared_ptr<const WindowMatcher> CompileIdentifier(cstr identifier);
     static XWindow FindWindowInGroup(cstr groupName);
     static XWindow NewWindow(cstr name, std::vector<int>* dimensions = nullptr, bool hide = false);
 
@@ -115,11 +119,13 @@ public:
 
     // New method
     static std::string GetActiveWindowClass();
+    static pID GetWindowPID(wID window);
     static void MoveWindowToNextMonitor();
     static void ToggleFullscreen(Display* display, Window win, Atom stateAtom, Atom fsAtom, bool enable);
 
 private:
     static bool InitializeX11();
+    static std::vector<WindowInfo> QueryTopLevelWindows(unsigned fields);
     std::string DetectWindowManager() const;
     bool CheckWMProtocols() const;
     static ProcessMethod toMethod(cstr method);
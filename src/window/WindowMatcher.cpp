@@ -0,0 +1,74 @@
+#include "WindowMatcher.hpp"
+#include "WindowIndex.hpp"
+#include <charconv>
+
+namespace havel {
+
+static bool ParseNumber(std::string_view text, unsigned long &out) {
+    int base = 10;
+    if (text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+        text.remove_prefix(2);
+        base = 16;
+    }
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), out, base);
+    return error == std::errc() && end == text.data() + text.size() && !text.empty();
+}
+
+WindowMatcher WindowMatcher::Compile(std::string_view identifier) {
+    static constexpr std::pair<std::string_view, Kind> types[] = {
+        {"title", Kind::Title}, {"class", Kind::Class}, {"pid", Kind::Pid},
+        {"exe", Kind::Exe},     {"id", Kind::Id},       {"group", Kind::Group},
+    };
+
+    WindowMatcher matcher;
+    matcher.value = std::string(identifier);
+    size_t split = identifier.find_first_of(" :=");
+    if (split == std::string_view::npos) {
+        return matcher;
+    }
+    std::string_view type = identifier.substr(0, split);
+    for (const auto &[name, kind] : types) {
+        if (type == name) {
+            matcher.kind = kind;
+            matcher.value = std::string(identifier.substr(split + 1));
+            break;
+        }
+    }
+
+    if (matcher.kind == Kind::Pid || matcher.kind == Kind::Id) {
+        if (!ParseNumber(matcher.value, matcher.number)) {
+            matcher.kind = Kind::Invalid;
+        }
+    }
+    return matcher;
+}
+
+bool WindowMatcher::Matches(const WindowInfo &info) const {
+    switch (kind) {
+        case Kind::Title: return info.title == value;
+        case Kind::Class: return info.windowClass == value || info.instance == value;
+        case Kind::Pid: return info.pid > 0 && static_cast<unsigned long>(info.pid) == number;
+        case Kind::Exe: return info.processName == value;
+        case Kind::Id: return info.windowId == number;
+        case Kind::Group:
+        case Kind::Invalid:
+        default:
+            return false;
+    }
+}
+
+const WindowInfo *WindowMatcher::Find(const WindowCache::Snapshot &snapshot) const {
+    switch (kind) {
+        case Kind::Title: return snapshot.Index().FindByTitle(value);
+        case Kind::Class: return snapshot.Index().FindByClass(value);
+        case Kind::Pid: return snapshot.Index().FindByPid(static_cast<pid_t>(number));
+        case Kind::Exe: return snapshot.Index().FindByProcess(value);
+        case Kind::Id: return snapshot.Find(number);
+        case Kind::Group:
+        case Kind::Invalid:
+        default:
+            return nullptr;
+    }
+}
+
+} // namespace havel
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "WindowCache.hpp"
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace havel {
+
+// A window identifier, parsed once and reusable for any number of lookups.
+//
+//   class firefox     WM_CLASS class or instance
+//   title Inbox       exact title
+//   pid 1234          _NET_WM_PID
+//   exe firefox       process name
+//   id 0x3a00007      window id, decimal or hex
+//   group browsers    first match among a group's identifiers
+//   anything else     exact title
+//
+// The type may be followed by a space, ':' or '='. Text that starts with
+// an unknown type is taken whole as a title.
+class WindowMatcher {
+public:
+    enum class Kind : uint8_t {
+        Title,
+        Class,
+        Pid,
+        Exe,
+        Id,
+        Group,
+        Invalid     // A pid or id that is not a number
+    };
+
+    WindowMatcher() = default;
+
+    static WindowMatcher Compile(std::string_view identifier);
+
+    Kind GetKind() const { return kind; }
+    const std::string &Value() const { return value; }
+    // The pid or window id
+    unsigned long Number() const { return number; }
+
+    bool Matches(const WindowInfo &info) const;
+    // Lowest-id match in `snapshot`; groups and invalid identifiers never
+    // match here, WindowManager resolves groups
+    const WindowInfo *Find(const WindowCache::Snapshot &snapshot) const;
+
+private:
+    Kind kind = Kind::Title;
+    std::string value;
+    unsigned long number = 0;
+};
+
+} // namespace havel
@@ -1,18 +1,16 @@
 #include "WindowMonitor.hpp"
+#include <X11/Xatom.h>
+#include <sys/eventfd.h>
 #include <sys/types.h>
+#include <poll.h>
 #include <unistd.h>
-#include <fstream>
-#include <filesystem>
-#include <system_error>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 
 namespace havel {
 
-WindowMonitor::WindowMonitor(std::chrono::milliseconds pollInterval)
-    : interval(pollInterval) {
-    if (pollInterval.count() < 10) {
-        throw WindowMonitorError("Poll interval too small (minimum 10ms)");
-    }
-}
+WindowMonitor::WindowMonitor() = default;
 
 WindowMonitor::~WindowMonitor() {
     Stop();
@@ -22,7 +20,26 @@ void WindowMonitor::Start() {
     if (running) {
         return;
     }
-    
+
+    display = XOpenDisplay(nullptr);
+    if (!display) {
+        throw WindowMonitorError("Cannot open X display");
+    }
+    wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wakeFd < 0) {
+        XCloseDisplay(display);
+        display = nullptr;
+        throw WindowMonitorError(std::string("eventfd failed: ") + strerror(errno));
+    }
+
+    root = DefaultRootWindow(display);
+    query = std::make_unique<WindowQuery>(display);
+    atoms.activeWindow = XInternAtom(display, "_NET_ACTIVE_WINDOW", False);
+    atoms.clientList = XInternAtom(display, "_NET_CLIENT_LIST", False);
+    atoms.wmName = XInternAtom(display, "_NET_WM_NAME", False);
+    atoms.wmState = XInternAtom(display, "_NET_WM_STATE", False);
+    XSelectInput(display, root, PropertyChangeMask);
+
     running = true;
     stopRequested = false;
     monitorThread = std::make_unique<std::thread>(&WindowMonitor::MonitorLoop, this);
@@ -34,11 +51,21 @@ void WindowMonitor::Stop() {
         if (!running) {
             return;
         }
-        
+
         stopRequested = true;
+        uint64_t one = 1;
+        if (write(wakeFd, &one, sizeof(one)) < 0) {
+            LogWarning("Failed to wake window monitor: " + std::string(strerror(errno)));
+        }
         if (monitorThread && monitorThread->joinable()) {
             monitorThread->join();
         }
+        cache.SetLive(false);
+        close(wakeFd);
+        wakeFd = -1;
+        query.reset();
+        XCloseDisplay(display);
+        display = nullptr;
         running = false;
         LogInfo("Window monitor stopped");
     } catch (const std::exception& e) {
@@ -48,121 +75,271 @@ void WindowMonitor::Stop() {
 }
 
 void WindowMonitor::MonitorLoop() {
+    SyncClientList();
+    SyncActiveWindow();
+    cache.SetLive(true);
+
+    pollfd fds[2] = {
+        {ConnectionNumber(display), POLLIN, 0},
+        {wakeFd, POLLIN, 0},
+    };
     while (!stopRequested) {
         try {
-            auto start = std::chrono::steady_clock::now();
-            
-            UpdateWindowMap();
-            CheckForWindowChanges();
-            
-            auto end = std::chrono::steady_clock::now();
-            auto duration = end - start;
-            
-            if (duration > interval) {
-                LogWarning("Monitor loop took longer than interval: " + 
-                    std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(duration).count()) + "ms");
+            // Everything already read off the socket first; poll() only
+            // sees what has not been
+            while (XPending(display)) {
+                XEvent event;
+                XNextEvent(display, &event);
+                HandleEvent(event);
             }
-            
-            std::this_thread::sleep_for(interval);
-            
+            FlushEvents();
         } catch (const std::exception& e) {
             LogError("Error in monitor loop: " + std::string(e.what()));
-            std::this_thread::sleep_for(std::chrono::seconds(1));
+        }
+
+        // FlushEvents makes round trips, and whatever arrived during them
+        // now waits in Xlib's queue with the socket already drained
+        if (XEventsQueued(display, QueuedAlready) > 0) {
+            continue;
+        }
+        if (poll(fds, 2, -1) < 0 && errno != EINTR) {
+            LogError("poll failed: " + std::string(strerror(errno)));
+            break;
         }
     }
 }
 
-WindowInfo WindowMonitor::GetWindowInfo(wID windowId) const {
-    WindowInfo info;
-    info.windowId = windowId;
-    info.lastUpdate = std::chrono::steady_clock::now();
-    
-    WindowManager wm;
-    if (wm.IsX11()) {
-        // Use cached info if available
-        if (auto entry = cache.Get(windowId)) {
-            info.pid = entry->pid;
-            info.processName = entry->processName;
+void WindowMonitor::HandleEvent(const XEvent &event) {
+    if (event.type == ConfigureNotify) {
+        stats.eventsHandled.fetch_add(1, std::memory_order_relaxed);
+        const XConfigureEvent &configure = event.xconfigure;
+        // Window managers send clients a synthetic ConfigureNotify in root
+        // coordinates when they move the frame; a real one is relative to
+        // the frame, so ask the server instead
+        PendingRefresh &pending = dirty[configure.window];
+        if (configure.send_event) {
+            pending.geometry = Rect(configure.x, configure.y, configure.width, configure.height);
+            pending.fields &= ~WindowQuery::Geometry;
         } else {
-            // Get PID from window property
-            // ... X11 specific code to get PID ...
-            
-            // Read process name from /proc
-            std::ifstream cmdline("/proc/" + std::to_string(info.pid) + "/cmdline");
-            if (cmdline) {
-                std::getline(cmdline, info.processName, '\0');
-                cache.Set(windowId, info.pid, info.processName);
-            }
+            pending.geometry.reset();
+            pending.fields |= WindowQuery::Geometry;
+        }
+        return;
+    }
+    if (event.type != PropertyNotify) {
+        return;
+    }
+    stats.eventsHandled.fetch_add(1, std::memory_order_relaxed);
+
+    const XPropertyEvent &property = event.xproperty;
+    if (property.window == root) {
+        if (property.atom == atoms.activeWindow) {
+            activeDirty = true;
+        } else if (property.atom == atoms.clientList) {
+            clientListDirty = true;
         }
+        return;
+    }
+
+    unsigned fields = 0;
+    if (property.atom == atoms.wmName || property.atom == XA_WM_NAME) {
+        fields = WindowQuery::Title;
+    } else if (property.atom == XA_WM_CLASS) {
+        fields = WindowQuery::Class;
+    } else if (property.atom == atoms.wmState) {
+        fields = WindowQuery::State;
+    }
+    if (fields) {
+        dirty[property.window].fields |= fields;
+    }
+}
+
+void WindowMonitor::FlushEvents() {
+    if (clientListDirty) {
+        clientListDirty = false;
+        SyncClientList();
+    }
+    if (!dirty.empty()) {
+        auto pending = std::move(dirty);
+        dirty.clear();
+        RefreshWindows(pending);
     }
-    
-    return info;
+    if (activeDirty) {
+        activeDirty = false;
+        SyncActiveWindow();
+    }
+}
+
+void WindowMonitor::Watch(wID window) {
+    XSelectInput(display, static_cast<::Window>(window), PropertyChangeMask | StructureNotifyMask);
 }
 
-void WindowMonitor::UpdateWindowMap() {
-    WindowManager wm;
-    // Temporary fix until ListWindows is implemented
-    std::vector<wID> windows;
-    #ifdef __linux__
-    // Get window list from X11 or Wayland
-    // TODO: Implement window listing
-    #endif
-    
-    std::unordered_map<wID, WindowInfo> newWindows;
-    
-    for (const auto& windowId : windows) {
-        auto info = GetWindowInfo(windowId);
-        newWindows[windowId] = std::move(info);
-    }
-    
-    // Update main window map with proper locks
+void WindowMonitor::SyncClientList() {
+    std::vector<wID> current = query->ClientList();
+    std::sort(current.begin(), current.end());
+
+    std::vector<wID> added;
+    std::vector<WindowInfo> removed;
     {
-        std::unique_lock<std::shared_mutex> lock(windowsMutex);
-        
-        // Check for removed windows
-        for (const auto& [id, info] : this->windows) {
-            if (newWindows.find(id) == newWindows.end()) {
-                std::lock_guard<std::mutex> cbLock(callbackMutex);
-                if (auto cb = windowRemovedCallback) {
-                    (*cb)(info);
-                }
+        auto snapshot = cache.Load();
+        for (wID window : current) {
+            if (!snapshot->windows.count(window)) {
+                added.push_back(window);
             }
         }
-        
-        // Check for new windows
-        for (const auto& [id, info] : newWindows) {
-            if (this->windows.find(id) == this->windows.end()) {
-                std::lock_guard<std::mutex> cbLock(callbackMutex);
-                if (auto cb = windowAddedCallback) {
-                    (*cb)(info);
-                }
+        for (const auto& [id, info] : snapshot->windows) {
+            if (!std::binary_search(current.begin(), current.end(), id)) {
+                removed.push_back(*info);
             }
         }
-        
-        this->windows = std::move(newWindows);
+    }
+    if (added.empty() && removed.empty()) {
+        return;
+    }
+
+    // Only the difference is queried, all of it in one batch; windows
+    // already known keep their entries and are kept current by their
+    // own events
+    for (wID window : added) {
+        Watch(window);
+    }
+    std::vector<WindowInfo> fetched = query->Fetch(added);
+
+    size_t tracked = 0;
+    cache.Update([&](WindowCache::Snapshot &snapshot) {
+        for (const auto& info : removed) {
+            snapshot.windows.erase(info.windowId);
+        }
+        for (const auto& info : fetched) {
+            snapshot.windows[info.windowId] = std::make_shared<const WindowInfo>(info);
+        }
+        tracked = snapshot.windows.size();
+    });
+    stats.windowsTracked.store(tracked, std::memory_order_relaxed);
+    stats.windowsAdded.fetch_add(fetched.size(), std::memory_order_relaxed);
+    stats.windowsRemoved.fetch_add(removed.size(), std::memory_order_relaxed);
+
+    for (const auto& info : removed) {
+        Notify(windowRemovedCallback, info);
+    }
+    for (const auto& info : fetched) {
+        Notify(windowAddedCallback, info);
     }
 }
 
-void WindowMonitor::CheckForWindowChanges() {
-    try {
-        WindowManager wm;
-        auto activeWin = wm.GetActiveWindow();
-        auto newInfo = GetWindowInfo(activeWin);
-        
-        if (!(newInfo == activeWindow)) {
-            std::lock_guard<std::mutex> lock(callbackMutex);
-            activeWindow = newInfo;
-            if (auto cb = activeWindowCallback) {
-                (*cb)(newInfo);
+void WindowMonitor::SyncActiveWindow() {
+    wID window = query->ActiveWindow();
+
+    std::shared_ptr<const WindowInfo> info;
+    {
+        auto snapshot = cache.Load();
+        if (snapshot->active && snapshot->active->windowId == window) {
+            return;
+        }
+        auto it = snapshot->windows.find(window);
+        if (it != snapshot->windows.end()) {
+            info = it->second;
+        }
+    }
+    if (!info) {
+        WindowInfo fetched;
+        if (window != 0) {
+            // Not a managed client (yet); watch it all the same
+            Watch(window);
+            fetched = query->Fetch({window})[0];
+        }
+        fetched.windowId = window;
+        fetched.isValid = true;
+        info = std::make_shared<const WindowInfo>(std::move(fetched));
+    }
+
+    cache.Update([&](WindowCache::Snapshot &snapshot) { snapshot.active = info; });
+    stats.activeWindowChanges.fetch_add(1, std::memory_order_relaxed);
+    Notify(activeWindowCallback, *info);
+}
+
+void WindowMonitor::RefreshWindows(const std::unordered_map<wID, PendingRefresh> &pending) {
+    // Windows wanting the same properties are fetched in one batch
+    std::unordered_map<unsigned, std::vector<wID>> byFields;
+    {
+        auto snapshot = cache.Load();
+        for (const auto& [window, refresh] : pending) {
+            if (refresh.fields && snapshot->Find(window)) {
+                byFields[refresh.fields].push_back(window);
             }
         }
-    } catch (const std::exception& e) {
-        LogWarning("Failed to check active window: " + std::string(e.what()));
+    }
+    std::unordered_map<wID, WindowInfo> fresh;
+    for (const auto& [fields, windows] : byFields) {
+        std::vector<WindowInfo> fetched = query->Fetch(windows, fields);
+        for (size_t i = 0; i < windows.size(); ++i) {
+            fresh[windows[i]] = std::move(fetched[i]);
+        }
+    }
+
+    // Everything that changed goes out in one update
+    std::shared_ptr<const WindowInfo> activeChanged;
+    cache.Update([&](WindowCache::Snapshot &snapshot) {
+        for (const auto& [window, refresh] : pending) {
+            const WindowInfo *old = snapshot.Find(window);
+            if (!old) {
+                continue;
+            }
+            unsigned fields = refresh.fields;
+            WindowInfo info = *old;
+            auto it = fresh.find(window);
+            if (it != fresh.end()) {
+                const WindowInfo &read = it->second;
+                if (fields & WindowQuery::Title) info.title = read.title;
+                if (fields & WindowQuery::Class) {
+                    info.windowClass = read.windowClass;
+                    info.instance = read.instance;
+                }
+                if (fields & WindowQuery::State) info.state = read.state;
+                if (fields & WindowQuery::Geometry) info.geometry = read.geometry;
+            }
+            if (refresh.geometry) {
+                info.geometry = *refresh.geometry;
+            }
+            if (info == *old) {
+                continue;
+            }
+            info.lastUpdate = std::chrono::steady_clock::now();
+
+            auto updated = std::make_shared<const WindowInfo>(std::move(info));
+            bool namesChanged = updated->title != old->title ||
+                                updated->windowClass != old->windowClass;
+            if (snapshot.active && snapshot.active->windowId == window) {
+                snapshot.active = updated;
+                if (namesChanged) {
+                    activeChanged = updated;
+                }
+            }
+            auto entry = snapshot.windows.find(window);
+            if (entry != snapshot.windows.end()) {
+                entry->second = updated;
+            }
+        }
+    });
+    if (activeChanged) {
+        Notify(activeWindowCallback, *activeChanged);
     }
 }
 
-void WindowMonitor::SetPollInterval(std::chrono::milliseconds newInterval) {
-    interval = newInterval;
+void WindowMonitor::Notify(const std::shared_ptr<WindowCallback> &slot, const WindowInfo &info) const {
+    std::shared_ptr<WindowCallback> callback;
+    {
+        std::lock_guard<std::mutex> lock(callbackMutex);
+        callback = slot;
+    }
+    if (!callback) {
+        return;
+    }
+    try {
+        (*callback)(info);
+    } catch (const std::exception& e) {
+        LogError("Window monitor callback failed: " + std::string(e.what()));
+    }
 }
 
-} // namespace havel 
\ No newline at end of file
+} // namespace havel
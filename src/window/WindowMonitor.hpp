@@ -5,13 +5,16 @@
 #include <unordered_map>
 #include <memory>
 #include <chrono>
-#include <shared_mutex> // For read-write lock
 #include <exception>
 #include <optional>
 #include <functional>
 #include <iostream> // For basic logging
+#include <string>
+#include <vector>
 #include "Window.hpp"
 #include "WindowManager.hpp"
+#include "WindowCache.hpp"
+#include "WindowQuery.hpp"
 
 namespace havel {
 
@@ -20,106 +23,75 @@ class WindowMonitorError : public std::runtime_error {
     using std::runtime_error::runtime_error;
 };
 
-struct WindowInfo {
-    std::string title;
-    std::string windowClass;
-    std::string processName;
-    pid_t pid{0};
-    unsigned long windowId{0};
-    std::chrono::steady_clock::time_point lastUpdate;
-    bool isValid{false}; // Validity flag
-    
-    // Thread-safe copy constructor
-    WindowInfo(const WindowInfo& other) {
-        std::atomic_thread_fence(std::memory_order_acquire);
-        title = other.title;
-        windowClass = other.windowClass;
-        processName = other.processName;
-        pid = other.pid;
-        windowId = other.windowId;
-        lastUpdate = other.lastUpdate;
-        isValid = other.isValid;
-        std::atomic_thread_fence(std::memory_order_release);
-    }
-    
-    WindowInfo& operator=(const WindowInfo& other) {
-        if (this != &other) {
-            WindowInfo temp(other);
-            std::swap(*this, temp);
-        }
-        return *this;
-    }
-    
-    WindowInfo() = default;
-    WindowInfo(WindowInfo&&) noexcept = default;
-    WindowInfo& operator=(WindowInfo&&) noexcept = default;
-};
-
-// Add operator== for WindowInfo
-inline bool operator==(const WindowInfo& lhs, const WindowInfo& rhs) {
-    return lhs.windowId == rhs.windowId &&
-           lhs.pid == rhs.pid &&
-           lhs.title == rhs.title &&
-           lhs.windowClass == rhs.windowClass &&
-           lhs.processName == rhs.processName;
-}
-
+// Tracks the active window and the client list from X events.
+//
+// The monitor thread has its own X connection. It selects PropertyNotify
+// on the root window (_NET_ACTIVE_WINDOW, _NET_CLIENT_LIST) and on every
+// client (_NET_WM_NAME, WM_NAME, WM_CLASS, _NET_WM_STATE), plus
+// ConfigureNotify on clients, and keeps the process-wide WindowCache up
+// to date. Events are coalesced: each batch read off the socket marks the
+// windows and properties it touched, which are then fetched together and
+// published in one cache update. The cache is Live() from the first full
+// sync until Stop(). Callbacks run on the monitor thread within the event
+// loop iteration that saw the change. While nothing changes the thread
+// sleeps in poll() and does no work.
 class WindowMonitor {
 public:
-    // Define callback type before using it
     using WindowCallback = std::function<void(const WindowInfo&)>;
 
-    explicit WindowMonitor(std::chrono::milliseconds pollInterval = std::chrono::milliseconds(100));
+    WindowMonitor();
     ~WindowMonitor();
-    
-    // Non-copyable, movable
+
+    // Non-copyable, non-movable: the monitor thread points back at it
     WindowMonitor(const WindowMonitor&) = delete;
     WindowMonitor& operator=(const WindowMonitor&) = delete;
-    WindowMonitor(WindowMonitor&&) noexcept = default;
-    WindowMonitor& operator=(WindowMonitor&&) noexcept = default;
-    
+
     // Start/Stop monitoring with error handling
     void Start();
     void Stop();
-    
-    // Getters with shared mutex for better performance
+
     std::optional<WindowInfo> GetActiveWindowInfo() const {
-        std::shared_lock<std::shared_mutex> lock(windowsMutex);
-        return activeWindow;
+        auto snapshot = cache.Load();
+        if (!snapshot->active) {
+            return std::nullopt;
+        }
+        return *snapshot->active;
     }
-    
+
     std::unordered_map<wID, WindowInfo> GetAllWindows() const {
-        std::shared_lock<std::shared_mutex> lock(windowsMutex);
+        std::unordered_map<wID, WindowInfo> windows;
+        for (const auto& [id, info] : cache.Load()->windows) {
+            windows.emplace(id, *info);
+        }
         return windows;
     }
-    
-    // Callbacks defined in header to avoid redefinition
+
+    // Called when the active window changes, or its title or class does
     void SetActiveWindowCallback(WindowCallback callback) {
         std::lock_guard<std::mutex> lock(callbackMutex);
         activeWindowCallback = std::make_shared<WindowCallback>(std::move(callback));
     }
-    
+
     void SetWindowAddedCallback(WindowCallback callback) {
         std::lock_guard<std::mutex> lock(callbackMutex);
         windowAddedCallback = std::make_shared<WindowCallback>(std::move(callback));
     }
-    
+
     void SetWindowRemovedCallback(WindowCallback callback) {
         std::lock_guard<std::mutex> lock(callbackMutex);
         windowRemovedCallback = std::make_shared<WindowCallback>(std::move(callback));
     }
-    
-    // Settings
-    void SetPollInterval(std::chrono::milliseconds interval);
+
     bool IsRunning() const noexcept { return running.load(std::memory_order_acquire); }
-    
+
     // Performance monitoring
     struct Stats {
         std::atomic<uint64_t> windowsTracked{0};
         std::atomic<uint64_t> windowsAdded{0};
         std::atomic<int64_t> windowsRemoved{0};
         std::atomic<int64_t> activeWindowChanges{0};
-        
+        std::atomic<uint64_t> eventsHandled{0};
+
         // Delete copy operations
         Stats() = default;
         Stats(const Stats&) = delete;
@@ -134,65 +106,61 @@ public:
 
 private:
     void MonitorLoop();
-    WindowInfo GetWindowInfo(wID windowId) const;
-    void UpdateWindowMap();
-    void CheckForWindowChanges();
-    
+    void HandleEvent(const XEvent &event);
+    void SyncClientList();
+    void SyncActiveWindow();
+
+    // What one batch of events changed on a window
+    struct PendingRefresh {
+        unsigned fields = 0;            // WindowQuery::Field to re-read
+        std::optional<Rect> geometry;   // From a synthetic ConfigureNotify
+    };
+    // Apply what the last batch of events marked, in one cache update
+    void FlushEvents();
+    void RefreshWindows(const std::unordered_map<wID, PendingRefresh> &pending);
+    void Watch(wID window);
+
+    void Notify(const std::shared_ptr<WindowCallback> &callback, const WindowInfo &info) const;
+
+    WindowCache &cache = WindowCache::Get();
+
     // Thread synchronization
-    mutable std::shared_mutex windowsMutex;
     mutable std::mutex callbackMutex;
     std::atomic<bool> running{false};
     std::atomic<bool> stopRequested{false};
-    std::chrono::milliseconds interval;
-    
-    // Resource management
+    // Wakes the monitor thread out of poll() on Stop()
+    int wakeFd = -1;
+
+    // Used by the monitor thread only
+    Display *display = nullptr;
+    wID root = 0;
+    struct {
+        Atom activeWindow = None;
+        Atom clientList = None;
+        Atom wmName = None;
+        Atom wmState = None;
+    } atoms;
+    std::unique_ptr<WindowQuery> query;
+    std::unordered_map<wID, PendingRefresh> dirty;
+    bool clientListDirty = false;
+    bool activeDirty = false;
+
     std::unique_ptr<std::thread> monitorThread;
-    std::unordered_map<wID, WindowInfo> windows;
-    WindowInfo activeWindow;
     Stats stats;
-    
-    // Callbacks stored as shared_ptr instead of weak_ptr
+
     std::shared_ptr<WindowCallback> activeWindowCallback;
     std::shared_ptr<WindowCallback> windowAddedCallback;
     std::shared_ptr<WindowCallback> windowRemovedCallback;
-    
-    // Thread-safe cache
-    class Cache {
-    public:
-        struct CacheEntry {
-            pid_t pid;
-            std::string processName;
-        };
-
-        void Set(wID windowId, pid_t pid, const std::string& procName = "") {
-            std::unique_lock<std::shared_mutex> lock(mutex);
-            pidCache[windowId] = CacheEntry{pid, procName};
-        }
-
-        std::optional<CacheEntry> Get(wID windowId) const {
-            std::shared_lock<std::shared_mutex> lock(mutex);
-            auto it = pidCache.find(windowId);
-            if (it != pidCache.end()) {
-                return it->second;
-            }
-            return std::nullopt;
-        }
-
-    private:
-        mutable std::shared_mutex mutex;
-        std::unordered_map<wID, CacheEntry> pidCache;
-    };
-    mutable Cache cache;
 
     // Logging helpers defined inline to avoid redefinition
     static void LogInfo(const std::string& msg) {
         std::cout << "[INFO] " << msg << std::endl;
     }
-    
+
     static void LogWarning(const std::string& msg) {
         std::cerr << "[WARNING] " << msg << std::endl;
     }
-    
+
     static void LogError(const std::string& msg) {
         std::cerr << "[ERROR] " << msg << std::endl;
     }
@@ -0,0 +1,302 @@
+#include "WindowQuery.hpp"
+#include "../core/DisplayManager.hpp"
+#include <X11/Xatom.h>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+
+#ifdef HAVEL_HAVE_XCB
+#include <X11/Xlib-xcb.h>
+#include <xcb/xcb.h>
+#endif
+
+namespace havel {
+
+WindowQuery::WindowQuery(Display *display)
+    : display(display), root(DefaultRootWindow(display)) {
+    // One round trip for all of them, none on a thread connection that
+    // has interned them before
+    static const char *const names[] = {
+        "_NET_ACTIVE_WINDOW",
+        "_NET_CLIENT_LIST",
+        "_NET_CLIENT_LIST_STACKING",
+        "_NET_WM_NAME",
+        "_NET_WM_PID",
+        "UTF8_STRING",
+        "_NET_WM_STATE",
+        "_NET_WM_STATE_FULLSCREEN",
+        "_NET_WM_STATE_MAXIMIZED_VERT",
+        "_NET_WM_STATE_MAXIMIZED_HORZ",
+        "_NET_WM_STATE_HIDDEN",
+        "_NET_WM_STATE_ABOVE",
+    };
+    constexpr int count = sizeof(names) / sizeof(names[0]);
+    Atom interned[count] = {};
+    DisplayManager::InternAtoms(display, names, count, false, interned);
+
+    atoms.activeWindow = interned[0];
+    atoms.clientList = interned[1];
+    atoms.clientListStacking = interned[2];
+    atoms.wmName = interned[3];
+    atoms.wmPid = interned[4];
+    atoms.utf8String = interned[5];
+    atoms.wmState = interned[6];
+    atoms.stateFullscreen = interned[7];
+    atoms.stateMaximizedVert = interned[8];
+    atoms.stateMaximizedHorz = interned[9];
+    atoms.stateHidden = interned[10];
+    atoms.stateAbove = interned[11];
+}
+
+bool WindowQuery::Batched() {
+#ifdef HAVEL_HAVE_XCB
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::vector<unsigned long> WindowQuery::ReadRoot(Atom property, Atom type) const {
+    Atom actualType;
+    int actualFormat;
+    unsigned long nitems, bytesAfter;
+    unsigned char *prop = nullptr;
+    std::vector<unsigned long> values;
+    if (XGetWindowProperty(display, root, property, 0, 4096, False, type,
+                           &actualType, &actualFormat, &nitems, &bytesAfter,
+                           &prop) == Success && prop) {
+        if (actualFormat == 32) {
+            // Format 32 properties come back as longs
+            auto *longs = reinterpret_cast<unsigned long *>(prop);
+            values.assign(longs, longs + nitems);
+        }
+        XFree(prop);
+    }
+    return values;
+}
+
+std::vector<wID> WindowQuery::ClientList(bool stacking) const {
+    auto values = ReadRoot(stacking ? atoms.clientListStacking : atoms.clientList, XA_WINDOW);
+    return {values.begin(), values.end()};
+}
+
+wID WindowQuery::ActiveWindow() const {
+    auto values = ReadRoot(atoms.activeWindow, XA_WINDOW);
+    return values.empty() ? 0 : values[0];
+}
+
+std::vector<wID> WindowQuery::TopLevelWindows() const {
+    ::Window rootReturn, parent;
+    ::Window *children = nullptr;
+    unsigned int count = 0;
+    std::vector<wID> windows;
+    if (XQueryTree(display, root, &rootReturn, &parent, &children, &count) && children) {
+        windows.assign(children, children + count);
+        XFree(children);
+    }
+    return windows;
+}
+
+std::vector<WindowInfo> WindowQuery::Fetch(const std::vector<wID> &windows, unsigned fields) const {
+#ifdef HAVEL_HAVE_XCB
+    std::vector<WindowInfo> infos = FetchBatched(windows, fields);
+#else
+    std::vector<WindowInfo> infos = FetchSequential(windows, fields);
+#endif
+    auto now = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < infos.size(); ++i) {
+        infos[i].windowId = windows[i];
+        infos[i].lastUpdate = now;
+        infos[i].isValid = true;
+    }
+    return infos;
+}
+
+void WindowQuery::Decode(WindowInfo &info, unsigned fields, const Raw &netName, const Raw &name,
+                         const Raw &windowClass, const Raw &pid, const Raw &state) const {
+    if (fields & Title) {
+        // EWMH title first, it is UTF-8; fall back to the ICCCM one
+        info.title = !netName.bytes.empty() ? netName.bytes : name.bytes;
+        // Some clients count the terminating NUL
+        while (!info.title.empty() && info.title.back() == '\0') {
+            info.title.pop_back();
+        }
+    }
+
+    if (fields & Class) {
+        // "instance\0class\0"
+        const std::string &bytes = windowClass.bytes;
+        size_t split = bytes.find('\0');
+        info.instance = bytes.substr(0, split);
+        if (split != std::string::npos) {
+            size_t end = bytes.find('\0', split + 1);
+            info.windowClass = bytes.substr(split + 1, end == std::string::npos ? end : end - split - 1);
+        }
+    }
+
+    if ((fields & Pid) && !pid.values.empty()) {
+        info.pid = static_cast<pid_t>(pid.values[0]);
+        if (info.pid > 0) {
+            std::ifstream comm("/proc/" + std::to_string(info.pid) + "/comm");
+            std::getline(comm, info.processName);
+        }
+    }
+
+    if (fields & State) {
+        bool vertical = false, horizontal = false;
+        for (unsigned long value : state.values) {
+            if (value == atoms.stateFullscreen) info.state |= WindowFullscreen;
+            else if (value == atoms.stateHidden) info.state |= WindowHidden;
+            else if (value == atoms.stateAbove) info.state |= WindowAbove;
+            else if (value == atoms.stateMaximizedVert) vertical = true;
+            else if (value == atoms.stateMaximizedHorz) horizontal = true;
+        }
+        if (vertical && horizontal) {
+            info.state |= WindowMaximized;
+        }
+    }
+}
+
+#ifdef HAVEL_HAVE_XCB
+
+std::vector<WindowInfo> WindowQuery::FetchBatched(const std::vector<wID> &windows, unsigned fields) const {
+    xcb_connection_t *connection = XGetXCBConnection(display);
+
+    struct Cookies {
+        xcb_get_property_cookie_t netName{}, name{}, windowClass{}, pid{}, state{};
+        xcb_get_geometry_cookie_t geometry{};
+        xcb_translate_coordinates_cookie_t position{};
+    };
+    auto get = [&](wID window, Atom property, Atom type, uint32_t length) {
+        return xcb_get_property(connection, 0, static_cast<xcb_window_t>(window),
+                                static_cast<xcb_atom_t>(property), static_cast<xcb_atom_t>(type),
+                                0, length);
+    };
+
+    // Every request goes out before the first reply is waited for
+    std::vector<Cookies> cookies(windows.size());
+    for (size_t i = 0; i < windows.size(); ++i) {
+        wID window = windows[i];
+        Cookies &c = cookies[i];
+        if (fields & Title) {
+            c.netName = get(window, atoms.wmName, atoms.utf8String, 1024);
+            c.name = get(window, XA_WM_NAME, XCB_GET_PROPERTY_TYPE_ANY, 1024);
+        }
+        if (fields & Class) c.windowClass = get(window, XA_WM_CLASS, XA_STRING, 1024);
+        if (fields & Pid) c.pid = get(window, atoms.wmPid, XA_CARDINAL, 1);
+        if (fields & State) c.state = get(window, atoms.wmState, XA_ATOM, 64);
+        if (fields & Geometry) {
+            c.geometry = xcb_get_geometry(connection, static_cast<xcb_drawable_t>(window));
+            c.position = xcb_translate_coordinates(connection, static_cast<xcb_window_t>(window),
+                                                   static_cast<xcb_window_t>(root), 0, 0);
+        }
+    }
+
+    // Errors (the window went away) come back here rather than through
+    // the Xlib error handler, and leave the property empty
+    auto collect = [&](xcb_get_property_cookie_t cookie) {
+        Raw raw;
+        xcb_generic_error_t *error = nullptr;
+        xcb_get_property_reply_t *reply = xcb_get_property_reply(connection, cookie, &error);
+        if (reply) {
+            int length = xcb_get_property_value_length(reply);
+            const void *value = xcb_get_property_value(reply);
+            if (reply->format == 8) {
+                raw.bytes.assign(static_cast<const char *>(value), length);
+            } else if (reply->format == 32) {
+                auto *values = static_cast<const uint32_t *>(value);
+                raw.values.assign(values, values + length / 4);
+            }
+            free(reply);
+        }
+        free(error);
+        return raw;
+    };
+
+    std::vector<WindowInfo> infos(windows.size());
+    for (size_t i = 0; i < windows.size(); ++i) {
+        Cookies &c = cookies[i];
+        Raw netName, name, windowClass, pid, state;
+        if (fields & Title) {
+            netName = collect(c.netName);
+            name = collect(c.name);
+        }
+        if (fields & Class) windowClass = collect(c.windowClass);
+        if (fields & Pid) pid = collect(c.pid);
+        if (fields & State) state = collect(c.state);
+        Decode(infos[i], fields, netName, name, windowClass, pid, state);
+
+        if (fields & Geometry) {
+            xcb_generic_error_t *error = nullptr;
+            if (auto *geometry = xcb_get_geometry_reply(connection, c.geometry, &error)) {
+                infos[i].geometry.width = geometry->width;
+                infos[i].geometry.height = geometry->height;
+                free(geometry);
+            }
+            free(error);
+            error = nullptr;
+            if (auto *position = xcb_translate_coordinates_reply(connection, c.position, &error)) {
+                infos[i].geometry.x = position->dst_x;
+                infos[i].geometry.y = position->dst_y;
+                free(position);
+            }
+            free(error);
+        }
+    }
+    return infos;
+}
+
+#endif
+
+std::vector<WindowInfo> WindowQuery::FetchSequential(const std::vector<wID> &windows, unsigned fields) const {
+    auto read = [&](wID window, Atom property, Atom type, long length) {
+        Raw raw;
+        Atom actualType;
+        int actualFormat;
+        unsigned long nitems, bytesAfter;
+        unsigned char *prop = nullptr;
+        if (XGetWindowProperty(display, static_cast<::Window>(window), property, 0, length,
+                               False, type, &actualType, &actualFormat,
+                               &nitems, &bytesAfter, &prop) == Success && prop) {
+            if (actualFormat == 8) {
+                raw.bytes.assign(reinterpret_cast<char *>(prop), nitems);
+            } else if (actualFormat == 32) {
+                // Format 32 properties come back as longs
+                auto *values = reinterpret_cast<unsigned long *>(prop);
+                raw.values.assign(values, values + nitems);
+            }
+            XFree(prop);
+        }
+        return raw;
+    };
+
+    std::vector<WindowInfo> infos(windows.size());
+    for (size_t i = 0; i < windows.size(); ++i) {
+        wID window = windows[i];
+        Raw netName, name, windowClass, pid, state;
+        if (fields & Title) {
+            netName = read(window, atoms.wmName, atoms.utf8String, 1024);
+            if (netName.bytes.empty()) {
+                name = read(window, XA_WM_NAME, AnyPropertyType, 1024);
+            }
+        }
+        if (fields & Class) windowClass = read(window, XA_WM_CLASS, XA_STRING, 1024);
+        if (fields & Pid) pid = read(window, atoms.wmPid, XA_CARDINAL, 1);
+        if (fields & State) state = read(window, atoms.wmState, XA_ATOM, 64);
+        Decode(infos[i], fields, netName, name, windowClass, pid, state);
+
+        if (fields & Geometry) {
+            XWindowAttributes attrs;
+            if (XGetWindowAttributes(display, static_cast<::Window>(window), &attrs)) {
+                int x = 0, y = 0;
+                ::Window child;
+                XTranslateCoordinates(display, static_cast<::Window>(window), root,
+                                      0, 0, &x, &y, &child);
+                infos[i].geometry = Rect(x, y, attrs.width, attrs.height);
+            }
+        }
+    }
+    return infos;
+}
+
+} // namespace havel
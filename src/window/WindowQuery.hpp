@@ -0,0 +1,80 @@
+#pragma once
+
+#include "WindowCache.hpp"
+#include "types.hpp"
+#include <X11/Xlib.h>
+#include <string>
+#include <vector>
+
+namespace havel {
+
+// Reads window properties for many windows at once over one X connection.
+//
+// Built with XCB (HAVEL_HAVE_XCB), Fetch() sends the requests for every
+// window and property first and only then collects the replies, so a
+// whole client list costs one round trip instead of one per property.
+// Without XCB the same calls go through Xlib one request at a time.
+// Like the Display it wraps, a query must stay on one thread.
+class WindowQuery {
+public:
+    enum Field : unsigned {
+        Title = 1 << 0,     // _NET_WM_NAME, else WM_NAME
+        Class = 1 << 1,     // WM_CLASS class and instance
+        Pid = 1 << 2,       // _NET_WM_PID, and the process name
+        State = 1 << 3,     // _NET_WM_STATE
+        Geometry = 1 << 4,  // Size, and position in root coordinates
+        All = Title | Class | Pid | State | Geometry
+    };
+
+    explicit WindowQuery(Display *display);
+
+    // Whether Fetch() pipelines its requests
+    static bool Batched();
+
+    Display *GetDisplay() const { return display; }
+
+    // _NET_CLIENT_LIST, or _NET_CLIENT_LIST_STACKING bottom to top
+    std::vector<wID> ClientList(bool stacking = false) const;
+    wID ActiveWindow() const;
+    // Direct children of the root window
+    std::vector<wID> TopLevelWindows() const;
+
+    // The requested fields of each window, in the order given. Windows
+    // that went away come back with those fields empty.
+    std::vector<WindowInfo> Fetch(const std::vector<wID> &windows, unsigned fields = All) const;
+
+private:
+    // A property as it came off the wire
+    struct Raw {
+        std::string bytes;                  // Format 8
+        std::vector<unsigned long> values;  // Format 32
+    };
+
+    std::vector<unsigned long> ReadRoot(Atom property, Atom type) const;
+    void Decode(WindowInfo &info, unsigned fields, const Raw &netName, const Raw &name,
+                const Raw &windowClass, const Raw &pid, const Raw &state) const;
+
+#ifdef HAVEL_HAVE_XCB
+    std::vector<WindowInfo> FetchBatched(const std::vector<wID> &windows, unsigned fields) const;
+#endif
+    std::vector<WindowInfo> FetchSequential(const std::vector<wID> &windows, unsigned fields) const;
+
+    Display *display;
+    ::Window root;
+    struct {
+        Atom activeWindow = None;
+        Atom clientList = None;
+        Atom clientListStacking = None;
+        Atom wmName = None;
+        Atom wmPid = None;
+        Atom utf8String = None;
+        Atom wmState = None;
+        Atom stateFullscreen = None;
+        Atom stateMaximizedVert = None;
+        Atom stateMaximizedHorz = None;
+        Atom stateHidden = None;
+        Atom stateAbove = None;
+    } atoms;
+};
+
+} // namespace havel